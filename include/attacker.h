@@ -2,17 +2,49 @@
 #define ATTACKER_H
 
 // Internal headers
+#include "dimension.h"
+#include "direction.h"
 #include "position.h"
 #include "spy.h"
+#include "strategy.h"
+
+// Structs
+
+/**
+ * Parameters of the attacker strategy, which can be tuned:
+ *   SPY_HEIGHT       fraction of the height at which it spies and sprints
+ *   STUCK_THRESHOLD  turns stuck before taking a detour
+ */
+enum attacker_parameter {
+  ATTACKER_SPY_HEIGHT,
+  ATTACKER_STUCK_THRESHOLD,
+  NUMBER_ATTACKER_PARAMETERS
+};
+
+// Variables
+extern const parameter_space_t attacker_parameter_space;
 
 // Functions
 
 /**
  * Main algorithm to move Attacker player in a Game.
  * Given the player position, it should decide the next direction
- * they will take in the field.
+ * they will take in the field. Everything it keeps between turns
+ * lives in its context, which is reset for every new game.
  */
 direction_t execute_attacker_strategy(position_t attacker_position,
-                                      Spy defender_spy);
+                                      Spy defender_spy,
+                                      StrategyContext context);
+
+/**
+ * Main algorithm to move a team of Attackers in a TeamGame.
+ * Attackers spread over three diagonals while running to the end
+ * of the field, so defenders cannot block all of them at once.
+ */
+void execute_attackers_team_strategy(dimension_t field_dimension,
+                                     size_t number_attackers,
+                                     const coordinate_t* lines,
+                                     const coordinate_t* columns,
+                                     direction_t* directions);
 
 #endif // ATTACKER_H
@@ -0,0 +1,52 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "bot.h"
+#include "dimension.h"
+#include "game.h"
+#include "map.h"
+
+// Structs
+
+/**
+ * A batch plays up to BATCH_LANES games of the same layout in lockstep,
+ * one game per lane. Positions, directions and counters are kept in
+ * struct-of-arrays lanes, so the rules of a turn (movement, blocking,
+ * goal, capture and cheating checks) are applied to all lanes at once,
+ * with AVX2 when the build enables it. Strategies still decide lane by
+ * lane, through their usual contexts and spies, or in batches of lanes
+ * through out-of-process bots.
+ * A batch gives exactly the same results as run_game for the same seeds.
+ */
+typedef struct batch* Batch;
+
+// Macros
+#define BATCH_LANES 64 // Multiple of the 8 lanes of an AVX2 register
+
+// Functions
+Batch new_batch(Map map, // Games are made from the map, if any...
+                dimension_t field_dimension, // ...or are standard games
+                size_t max_number_spies,
+                bool simultaneous_moves,
+                PlayerStrategy attacker_strategy,
+                PlayerStrategy defender_strategy);
+void delete_batch(Batch batch);
+
+bool set_batch_bots(Batch batch, Bot attacker_bot, Bot defender_bot);
+void set_batch_strategy_parameters(Batch batch,
+                                   const double* attacker_parameters,
+                                   const double* defender_parameters);
+
+bool run_batch(Batch batch,
+               const uint64_t* seeds,
+               size_t number_games,
+               size_t max_turns,
+               game_result_t* results);
+
+#endif // BATCH_H
@@ -0,0 +1,49 @@
+#ifndef BELIEF_H
+#define BELIEF_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+
+// Internal headers
+#include "dimension.h"
+#include "position.h"
+
+// Structs
+
+/**
+ * A belief is a probability grid of the cells where an unseen opponent
+ * may be. Every turn the opponent is assumed to take any of the 8
+ * directions or stay, with equal probability, and to stay when it runs
+ * into an obstacle or the border of the grid. A spy call collapses the
+ * belief to a single cell. Only the frontier, the bounding box of the
+ * cells that may hold the opponent, is ever updated, so a belief costs
+ * little on large maps while its opponent is still close to a sighting.
+ */
+typedef struct belief* Belief;
+
+// Functions
+Belief new_belief(dimension_t dimension,
+                  const bool* obstacles); // Row-major, or NULL for none
+void delete_belief(Belief belief);
+
+dimension_t get_belief_dimension(Belief belief);
+
+void collapse_belief(Belief belief, position_t position);
+void spread_belief(Belief belief);
+
+double get_belief_probability(Belief belief, position_t position);
+position_t get_belief_expected_position(Belief belief);
+void get_belief_frontier(Belief belief, position_t* first, position_t* last);
+
+/**
+ * The entropy of a belief, in bits, is how much a spy call would tell:
+ * collapsing a belief spread evenly over 2^n cells reveals n bits. It
+ * grows while the opponent is unseen, so a spy is advised once it
+ * reaches min_bits, and the caller is expected to also spy before the
+ * frontier gets too close for the answer to be of any use.
+ */
+double get_belief_entropy(Belief belief);
+bool is_spy_advised(Belief belief, double min_bits);
+
+#endif // BELIEF_H
@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Standard headers
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "game.h"
+
+// Structs
+
+/**
+ * The primitives timed by the benchmarks, each on its own, so that a
+ * change in the cost of one of them shows even when it is lost in the
+ * noise of whole games.
+ */
+enum benchmark_primitive {
+  BENCHMARK_MOVE_POSITION,
+  BENCHMARK_NEIGHBOR_POSITIONS,
+  BENCHMARK_EQUAL_POSITIONS,
+  BENCHMARK_GET_MAP_SYMBOL,
+  BENCHMARK_ADD_ITEM_TO_FIELD,
+  BENCHMARK_MOVE_ITEM_IN_FIELD,
+  BENCHMARK_GET_SPY_POSITION,
+  BENCHMARK_ATTACKER_STRATEGY,
+  BENCHMARK_DEFENDER_STRATEGY,
+  NUMBER_BENCHMARKS
+};
+
+/**
+ * A benchmark configuration takes the layout of its game for the map,
+ * field, items and spies the primitives work on, and their inputs are
+ * drawn from the seed, so runs with the same configuration time the
+ * same calls, on any commit. A sample times that many calls in a row,
+ * and primitives take turns sampling, so that they share any drift of
+ * the machine.
+ */
+struct benchmark_config {
+  Game game;
+  size_t number_samples;
+  size_t calls_per_sample;
+  uint64_t seed;
+};
+typedef struct benchmark_config benchmark_config_t;
+
+/**
+ * Costs are per call, in ticks of the cycle counter (the time stamp
+ * counter on x86, which ticks at a constant rate, or nanoseconds where
+ * there is none) and in nanoseconds. Samples further than
+ * BENCHMARK_OUTLIER_DISTANCE scaled MADs from the median (and over 5%
+ * from it) are rejected as outliers, such as samples interrupted by
+ * the system, and the median and MAD (median absolute deviation) are
+ * of the samples kept.
+ */
+struct benchmark_result {
+  size_t number_samples; // Kept
+  size_t number_outliers;
+  double median_cycles;
+  double mad_cycles;
+  double median_nanoseconds;
+};
+typedef struct benchmark_result benchmark_result_t;
+
+// Macros
+#define BENCHMARK_OUTLIER_DISTANCE 3.0
+
+// Functions
+void run_benchmarks(benchmark_config_t config,
+                    benchmark_result_t results[NUMBER_BENCHMARKS]);
+void print_benchmark_results(
+    const benchmark_result_t results[NUMBER_BENCHMARKS]);
+
+#endif // BENCHMARK_H
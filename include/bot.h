@@ -0,0 +1,75 @@
+#ifndef BOT_H
+#define BOT_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "direction.h"
+#include "game.h"
+#include "position.h"
+
+// Structs
+
+/**
+ * A bot is a strategy running in another process, connected through
+ * a Unix socket to its standard input and output. Decisions of many
+ * games are requested in a single message, and several messages may
+ * be in flight, so the bot works on a batch while the engine prepares
+ * the next one.
+ *
+ * Every message is a header (u32 type, u32 count) followed by count
+ * fixed-size records, all integers little-endian:
+ *   HELLO    engine to bot, count is the role, no records
+ *   START    engine to bot, u32 game, u64 seed: a new game in this slot
+ *   REQUEST  engine to bot, u32 game, u16 line, u16 column,
+ *            u16 opponent line, u16 opponent column
+ *   DECISION bot to engine, one per request and in the same order:
+ *            i8 line step, i8 column step, u8 spy uses, u8 reserved
+ *
+ * The position of the opponent is sent with every request, so spying
+ * never takes a round trip. Bots are trusted to report their spy uses,
+ * as strategies in process are trusted to only look through their spy.
+ */
+typedef struct bot* Bot;
+
+enum bot_role { ATTACKER_BOT, DEFENDER_BOT };
+
+struct bot_request {
+  uint32_t game;
+  position_t position;
+  position_t opponent_position;
+};
+typedef struct bot_request bot_request_t;
+
+struct bot_decision {
+  direction_t direction;
+  size_t spy_uses;
+};
+typedef struct bot_decision bot_decision_t;
+
+// Macros
+#define BOT_MAX_COORDINATE UINT16_MAX
+
+// Functions
+Bot new_bot(const char* command, enum bot_role role);
+void delete_bot(Bot bot);
+
+bool is_bot_alive(Bot bot);
+
+bool start_bot_games(Bot bot,
+                     const uint32_t* games,
+                     const uint64_t* seeds,
+                     size_t number_games);
+bool send_bot_requests(Bot bot,
+                       const bot_request_t* requests,
+                       size_t number_requests);
+bool receive_bot_decisions(Bot bot,
+                           bot_decision_t* decisions,
+                           size_t number_decisions);
+
+int serve_bot(PlayerStrategy strategy, int input, int output);
+
+#endif // BOT_H
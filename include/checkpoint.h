@@ -0,0 +1,52 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "runner.h"
+
+// Structs
+
+/**
+ * A checkpoint holds the progress of a sweep: which of its games are
+ * completed, the summary of those games, and the size of the result
+ * file once their records were written. The random streams of a game
+ * only depend on the seed of the sweep and on the index of the game,
+ * so the indices of the completed games are all the position there is
+ * to save: games in flight are replayed exactly from their seeds.
+ * A fingerprint of the configuration of the sweep tells whether a
+ * checkpoint belongs to it.
+ *
+ * File layout (all integers little-endian):
+ *   header: "RUGBYCKP", u32 version, u32 padding, u64 fingerprint,
+ *           u64 number of games, u64 result file size
+ *   summary: u64 number of games, of failed games and of turns,
+ *            u64 count of every winner, then of every end reason
+ *   games: one bit per game, set when completed, in u64 words
+ * Checkpoints are written to a temporary file, then renamed over the
+ * previous one, so a crash leaves either of them whole.
+ */
+typedef struct checkpoint* Checkpoint;
+
+// Functions
+Checkpoint new_checkpoint(uint64_t fingerprint, size_t number_games);
+Checkpoint load_checkpoint(const char* path,
+                           uint64_t fingerprint,
+                           size_t number_games);
+void delete_checkpoint(Checkpoint checkpoint);
+
+bool save_checkpoint(Checkpoint checkpoint, const char* path);
+
+void complete_checkpoint_game(Checkpoint checkpoint, size_t index);
+bool is_checkpoint_game_completed(Checkpoint checkpoint, size_t index);
+size_t get_checkpoint_number_completed(Checkpoint checkpoint);
+
+runner_summary_t* get_checkpoint_summary(Checkpoint checkpoint);
+uint64_t get_checkpoint_results_size(Checkpoint checkpoint);
+void set_checkpoint_results_size(Checkpoint checkpoint, uint64_t size);
+
+#endif // CHECKPOINT_H
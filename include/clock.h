@@ -0,0 +1,17 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+// Standard headers
+#include <stdint.h>
+
+// Functions
+
+/**
+ * The monotonic clock is the one clock of all timings, deadlines and
+ * profiles, so their readings can be compared with each other. It never
+ * goes back, and only differences of its readings are meaningful.
+ */
+uint64_t read_monotonic_nanoseconds();
+double read_monotonic_seconds();
+
+#endif // CLOCK_H
@@ -0,0 +1,43 @@
+#ifndef COORDINATE_H
+#define COORDINATE_H
+
+// Standard headers
+#include <stddef.h>
+#include <stdint.h>
+
+// Macros
+
+/**
+ * Coordinates are the lines and columns of positions, and steps are
+ * those of directions. Their width is chosen at build time with
+ * RUGBY_COORDINATE_BITS (see the COORDINATES option of the Makefile):
+ * 16 or 32 bits make positions, items and anything storing them
+ * smaller, while 64 bits (the default) are plain size_t and int.
+ * COORDINATE_MAX never is a valid coordinate, so that moving back from
+ * the first line or column wraps to an invalid one, as does any
+ * coordinate of INVALID_POSITION, and fields are at most that large.
+ */
+#ifndef RUGBY_COORDINATE_BITS
+#define RUGBY_COORDINATE_BITS 64
+#endif
+
+#if RUGBY_COORDINATE_BITS == 16
+typedef uint16_t coordinate_t;
+typedef int16_t step_t;
+#define COORDINATE_MAX UINT16_MAX
+
+#elif RUGBY_COORDINATE_BITS == 32
+typedef uint32_t coordinate_t;
+typedef int32_t step_t;
+#define COORDINATE_MAX UINT32_MAX
+
+#elif RUGBY_COORDINATE_BITS == 64
+typedef size_t coordinate_t;
+typedef int step_t;
+#define COORDINATE_MAX SIZE_MAX
+
+#else
+#error "RUGBY_COORDINATE_BITS must be 16, 32 or 64"
+#endif
+
+#endif // COORDINATE_H
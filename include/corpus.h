@@ -0,0 +1,52 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+// Standard headers
+#include <stddef.h>
+
+// Internal headers
+#include "runner.h"
+
+// Structs
+
+/**
+ * A corpus configuration describes a sweep over every map file of a
+ * directory, played by a pipeline of stages: one thread scans the
+ * directory, one opens the files and asks the kernel to read them ahead,
+ * number_parsers threads parse them into maps, and number_workers
+ * threads (those of the runner) play the games of one map each. Bounded
+ * queues between stages keep as many files and maps in flight as
+ * queue_capacity, so the stages overlap while memory stays flat.
+ * Every map is played as its own sweep, with the same seeds.
+ */
+struct corpus_config {
+  const char* directory;
+  runner_config_t runner; // Its map and map_id are set for every map
+
+  size_t number_parsers;
+  size_t queue_capacity;
+};
+typedef struct corpus_config corpus_config_t;
+
+/**
+ * A corpus summary aggregates the games of all maps, and the time each
+ * stage was busy, added over its threads. Without overlap, the wall
+ * time would be their sum.
+ */
+struct corpus_summary {
+  size_t number_maps;
+  size_t number_failed_maps;
+  runner_summary_t games;
+
+  double scan_seconds;
+  double read_seconds;
+  double parse_seconds;
+  double play_seconds;
+};
+typedef struct corpus_summary corpus_summary_t;
+
+// Functions
+corpus_summary_t run_corpus(corpus_config_t config);
+void print_corpus_summary(corpus_summary_t summary);
+
+#endif // CORPUS_H
@@ -0,0 +1,54 @@
+#ifndef CYCLE_H
+#define CYCLE_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "position.h"
+#include "strategy.h"
+
+// Structs
+
+/**
+ * A cycle detector keeps the hashes of the states a game went through,
+ * in a small open addressing set. Games are deterministic given their
+ * state, so a game that reaches a state twice repeats itself forever,
+ * and can only end at max turns, as a draw.
+ *
+ * The state of a game is what decides all of its next turns: its board,
+ * with the positions of the players and the uses of their spies, and
+ * the contexts of their strategies. Hashing the contexts costs about as
+ * much as a turn, so they are only hashed once the board may repeat,
+ * as told by a bit filter of the boards seen, and a cycle is detected
+ * at most one period after it starts.
+ */
+typedef struct cycle_detector* CycleDetector;
+
+// Macros
+#define NO_STATE_HASH 0 // Never returned by the hash functions
+
+// Functions
+CycleDetector new_cycle_detector();
+void delete_cycle_detector(CycleDetector detector);
+
+void reset_cycle_detector(CycleDetector detector);
+bool may_repeat_cycle_board(CycleDetector detector, uint64_t board_hash);
+bool repeats_cycle_state(CycleDetector detector, uint64_t state_hash);
+
+uint64_t hash_game_board(position_t attacker_position,
+                         position_t defender_position,
+                         size_t attacker_spy_uses,
+                         size_t defender_spy_uses);
+
+/**
+ * Returns NO_STATE_HASH if a context holds a scratch (see strategy.h),
+ * whose content is not part of the hash.
+ */
+uint64_t hash_game_state(uint64_t board_hash,
+                         StrategyContext attacker_context,
+                         StrategyContext defender_context);
+
+#endif // CYCLE_H
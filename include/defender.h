@@ -2,17 +2,53 @@
 #define DEFENDER_H
 
 // Internal headers
+#include "dimension.h"
+#include "direction.h"
 #include "position.h"
 #include "spy.h"
+#include "strategy.h"
+
+// Structs
+
+/**
+ * Parameters of the defender strategy, which can be tuned:
+ *   SPY_WIDTH        fraction of the width at which it spies and retreats
+ *   RETREAT_OFFSET   columns from the right border where the retreat ends
+ *   PATROL_MARGIN    lines from the borders where the patrol turns back
+ *   STUCK_THRESHOLD  turns stuck before taking a detour
+ */
+enum defender_parameter {
+  DEFENDER_SPY_WIDTH,
+  DEFENDER_RETREAT_OFFSET,
+  DEFENDER_PATROL_MARGIN,
+  DEFENDER_STUCK_THRESHOLD,
+  NUMBER_DEFENDER_PARAMETERS
+};
+
+// Variables
+extern const parameter_space_t defender_parameter_space;
 
 // Functions
 
 /**
  * Main algorithm to move Defender player in a Game.
  * Given the player position, it should decide the next direction
- * they will take in the field.
+ * they will take in the field. The defender remembers its plan
+ * from one turn to the next in the given context.
  */
 direction_t execute_defender_strategy(position_t defender_position,
-                                      Spy attacker_spy);
+                                      Spy attacker_spy,
+                                      StrategyContext context);
+
+/**
+ * Main algorithm to move a team of Defenders in a TeamGame.
+ * Defenders spread evenly over the lines of the field and form
+ * a wall in its center column.
+ */
+void execute_defenders_team_strategy(dimension_t field_dimension,
+                                     size_t number_defenders,
+                                     const coordinate_t* lines,
+                                     const coordinate_t* columns,
+                                     direction_t* directions);
 
 #endif // DEFENDER_H
@@ -1,14 +1,17 @@
 #ifndef DIRECTION_H
 #define DIRECTION_H
 
+// Internal headers
+#include "coordinate.h"
+
 // Structs
 
 /**
  * A direction represents a vector of movement in a 2D grid.
  */
 struct direction {
-  int i;
-  int j;
+  step_t i;
+  step_t j;
 };
 typedef struct direction direction_t;
 
@@ -0,0 +1,62 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+// Standard headers
+#include <stddef.h>
+
+// Internal headers
+#include "game.h"
+#include "runner.h"
+
+// Structs
+
+enum evaluated_side { ATTACKER_SIDE, DEFENDER_SIDE };
+
+/**
+ * An evaluation configuration describes an A/B comparison between two
+ * strategies of the same side, against the same opponent. Both are played
+ * in batches of games with the same seeds, on the same runner, and a
+ * sequential probability ratio test on the differences of their scores
+ * (1 for a win, 1/2 for a draw) in the games of each seed stops as soon
+ * as they differ by at least min_difference, or surely by less than it.
+ * alpha and beta are the probabilities of each kind of wrong verdict.
+ */
+struct evaluation_config {
+  runner_config_t runner; // Strategies of the evaluated side are replaced
+  enum evaluated_side side;
+
+  PlayerStrategy baseline_strategy;
+  PlayerStrategy candidate_strategy;
+  size_t baseline_player; // Identify the strategies in the runner results
+  size_t candidate_player;
+
+  double min_difference;
+  double alpha;
+  double beta;
+
+  size_t batch_size;
+  size_t max_games; // Per strategy
+};
+typedef struct evaluation_config evaluation_config_t;
+
+enum evaluation_verdict {
+  CANDIDATE_IS_BETTER,
+  CANDIDATE_IS_WORSE,
+  NO_SIGNIFICANT_DIFFERENCE,
+  INCONCLUSIVE // Not decided within max_games
+};
+
+struct evaluation_result {
+  enum evaluation_verdict verdict;
+  size_t number_games; // Per strategy
+  double baseline_score;
+  double candidate_score;
+  double log_likelihood_ratio;
+};
+typedef struct evaluation_result evaluation_result_t;
+
+// Functions
+evaluation_result_t evaluate_strategies(evaluation_config_t config);
+void print_evaluation_result(evaluation_result_t result);
+
+#endif // EVALUATION_H
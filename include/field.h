@@ -5,6 +5,7 @@
 #include <stdbool.h>
 
 // Internal headers
+#include "coordinate.h"
 #include "dimension.h"
 #include "position.h"
 #include "item.h"
@@ -13,11 +14,25 @@
 
 /**
  * A field is a 2D grid where a list of items are positioned.
+ *
+ * The dimension of all fields may be fixed at build time, with
+ * RUGBY_FIXED_FIELD_HEIGHT and RUGBY_FIXED_FIELD_WIDTH (see the
+ * FIXED_FIELD option of the Makefile). Bounds checks then compare with
+ * constants, and cells are bytes held in the field, instead of a grid
+ * of pointers allocated line by line. Fields of any other dimension are
+ * not made, and fields hold at most 4 distinct items, which is more
+ * than games use.
  */
 typedef struct field* Field;
 
 // Macros
+#ifdef RUGBY_FIXED_FIELD_HEIGHT
+#define FIELD_FIXED_DIMENSION \
+  (dimension_t) { RUGBY_FIXED_FIELD_HEIGHT, RUGBY_FIXED_FIELD_WIDTH }
+#endif
+
 #define FIELD_MIN_DIMENSION (dimension_t) { 3, 3 }
+#define FIELD_MAX_DIMENSION (dimension_t) { COORDINATE_MAX, COORDINATE_MAX }
 
 // Functions
 Field new_field(dimension_t dimension);
@@ -28,6 +43,8 @@ dimension_t get_field_dimension(Field field);
 void print_field_info(Field field);
 void print_field_grid(Field field);
 
+Item get_field_item(Field field, position_t position);
+
 void add_item_to_field(Field field, Item item, position_t position);
 void move_item_in_field(Field field, Item item, direction_t direction);
 
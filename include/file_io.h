@@ -0,0 +1,36 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Functions
+
+/**
+ * Reads or writes exactly size bytes, retrying interrupted and partial
+ * transfers. Returns false if the descriptor fails or ends before.
+ */
+bool read_all(int input, unsigned char* bytes, size_t size);
+bool write_all(int output, const unsigned char* bytes, size_t size);
+
+/**
+ * Publishes a file atomically: its data is written to a temporary file
+ * next to the path, flushed to disk, and renamed over the path, so that
+ * readers only ever see whole files, either the old or the new one.
+ */
+bool publish_file(const char* path, const unsigned char* data, size_t size);
+
+/**
+ * Files and bot messages store their integers little-endian, whatever
+ * the byte order of the host.
+ */
+void write_u16(unsigned char* out, uint16_t value);
+uint16_t read_u16(const unsigned char* in);
+void write_u32(unsigned char* out, uint32_t value);
+uint32_t read_u32(const unsigned char* in);
+void write_u64(unsigned char* out, uint64_t value);
+uint64_t read_u64(const unsigned char* in);
+
+#endif // FILE_IO_H
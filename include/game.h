@@ -1,6 +1,10 @@
 #ifndef GAME_H
 #define GAME_H
 
+// Standard headers
+#include <stdbool.h>
+#include <stdint.h>
+
 // Internal headers
 #include "position.h"
 #include "direction.h"
@@ -8,7 +12,9 @@
 #include "field.h"
 #include "item.h"
 #include "map.h"
+#include "rng.h"
 #include "spy.h"
+#include "strategy.h"
 
 // Structs
 
@@ -22,8 +28,68 @@ typedef struct game* Game;
  * A player strategy is a function to determine the direction of a player
  * given its current position in a Field. Aditionally, players can spy
  * on its opponent positions **at most** MAX_NUMBER_SPIES times.
+ * Strategies keep their state and random generator in their context.
+ */
+typedef direction_t (*PlayerStrategy)(position_t, Spy, StrategyContext);
+
+/**
+ * A game end reason tells why a game is over (or that it is not).
+ */
+enum game_end_reason {
+  GAME_CONTINUES,
+  ATTACKER_CHEATED,
+  DEFENDER_CHEATED,
+  ATTACKER_ARRIVED_END_FIELD,
+  DEFENDER_CAPTURED_ATTACKER,
+  MAX_TURNS_REACHED,
+  CYCLE_DETECTED, // A draw, as the game was repeating itself
+  MAP_DRAWN, // A draw, as nobody can win on the map, so it was not played
+  NUMBER_GAME_END_REASONS
+};
+
+enum game_winner {
+  NO_WINNER,
+  ATTACKER_WINNER,
+  DEFENDER_WINNER,
+  NUMBER_GAME_WINNERS
+};
+
+/**
+ * A game result summarizes a game played without printing it.
+ */
+struct game_result {
+  enum game_end_reason end_reason;
+  enum game_winner winner;
+  size_t number_turns;
+  size_t attacker_spy_uses; // Times the attacker spied the defender
+  size_t defender_spy_uses; // Times the defender spied the attacker
+};
+typedef struct game_result game_result_t;
+
+/**
+ * A turn fallback is the move of a player whose strategy missed its
+ * deadline without offering a move in time (see strategy.h).
+ */
+enum turn_fallback {
+  STAY_FALLBACK,
+  LAST_DIRECTION_FALLBACK, // The last move the player played
+};
+
+/**
+ * Turn timings are of the decisions of a player in the last game played,
+ * recorded only in games with a turn budget.
  */
-typedef direction_t (*PlayerStrategy)(position_t, Spy);
+struct turn_timings {
+  size_t number_decisions;
+  size_t number_missed_deadlines;
+  size_t number_fallbacks; // Missed deadlines without an offer in time
+  uint64_t total_nanoseconds;
+  uint64_t max_nanoseconds;
+};
+typedef struct turn_timings turn_timings_t;
+
+// Macros
+#define NO_TURN_BUDGET 0
 
 // Functions
 Game new_game(
@@ -40,6 +106,71 @@ Game new_game_from_map(
 
 void delete_game(Game game);
 void print_game(Game game);
+
+/**
+ * In simultaneous moves, both strategies decide on the same state of
+ * the field, before any of the players moves. Conflicts are solved
+ * deterministically: if both players target the same cell, or try to
+ * swap their cells, neither of them moves.
+ *
+ * With concurrent decisions, the attacker of simultaneous moves decides
+ * in a helper thread of the game, started once, while the defender
+ * decides in the caller. It only pays off for strategies much slower
+ * than waking a thread; results are the same either way.
+ */
+void set_game_simultaneous_moves(Game game, bool simultaneous_moves);
+void set_game_concurrent_decisions(Game game, bool concurrent_decisions);
+
+/**
+ * All randomness of a game comes from its seed, so two games with
+ * the same seed are played exactly the same way.
+ */
+void set_game_seed(Game game, uint64_t seed);
+
+rng_t seed_attacker_rng(uint64_t game_seed);
+rng_t seed_defender_rng(uint64_t game_seed);
+
+/**
+ * A turn budget gives strategies that many nanoseconds to decide every
+ * move, as a deadline in their context (see strategy.h), or none, with
+ * NO_TURN_BUDGET, the default. Strategies run until they return, but a
+ * move returned after the deadline is replaced by the last move offered
+ * in time, or else by the fallback, so a game only depends on what
+ * strategies decide within their budget. Games with a budget depend on
+ * timings, so they are never taken for cycles (see cycle.h).
+ */
+void set_game_turn_budget(Game game,
+                          uint64_t turn_budget,
+                          enum turn_fallback fallback);
+turn_timings_t get_game_attacker_timings(Game game);
+turn_timings_t get_game_defender_timings(Game game);
+
+/**
+ * Parameter vectors replace the default constants of the strategies
+ * (see strategy.h). They are not copied, so they must outlive the game.
+ */
+void set_game_strategy_parameters(Game game,
+                                  const double* attacker_parameters,
+                                  const double* defender_parameters);
+
 void play_game(Game game, size_t max_turns);
+game_result_t run_game(Game game, size_t max_turns);
+
+enum game_winner winner_of_end_reason(enum game_end_reason end_reason);
+
+/**
+ * The initial layout of a game, for engines that replay its rules
+ * on their own representation of the field.
+ */
+dimension_t get_game_dimension(Game game);
+position_t get_game_attacker_position(Game game);
+position_t get_game_defender_position(Game game);
+bool is_game_obstacle(Game game, position_t position);
+
+/**
+ * A copy of the layout of a game as a map, to be deleted by the caller,
+ * for the analyses of maps (see map_analysis.h).
+ */
+Map copy_game_map(Game game);
 
 #endif // GAME_H
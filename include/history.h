@@ -0,0 +1,22 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+// Standard headers
+#include <stdint.h>
+
+// Internal headers
+#include "runner.h"
+
+// Functions
+
+/**
+ * Loads, from a result file, the number of turns every game of the sweep
+ * of a runner configuration lasted, found by its seed. Games of the sweep
+ * missing from the history are expected to last the average of the
+ * recorded games of the matchup. Returns NULL if there is no recorded
+ * game, so the sweep keeps its order.
+ */
+uint32_t* load_expected_turns(const char* history_path,
+                              const runner_config_t* config);
+
+#endif // HISTORY_H
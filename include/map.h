@@ -1,6 +1,11 @@
 #ifndef MAP_H
 #define MAP_H
 
+// Standard headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
 // Internal headers
 #include "dimension.h"
 #include "position.h"
@@ -14,6 +19,13 @@ typedef struct map* Map;
 
 // Functions
 Map new_map(const char* map_path);
+Map read_map(FILE* map_file);
+
+/**
+ * A map of a layout, as strategies know it (see strategy.h): a row-major
+ * mask of the cells holding an obstacle, without players.
+ */
+Map new_map_from_layout(dimension_t dimension, const bool* obstacles);
 void delete_map(Map map);
 
 void print_map(Map map);
@@ -21,4 +33,6 @@ void print_map(Map map);
 dimension_t get_map_dimension(Map map);
 char get_map_symbol(Map map, position_t position);
 
+uint64_t hash_map(Map map);
+
 #endif // MAP_H
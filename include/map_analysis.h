@@ -0,0 +1,53 @@
+#ifndef MAP_ANALYSIS_H
+#define MAP_ANALYSIS_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stdint.h>
+
+// Internal headers
+#include "dimension.h"
+#include "map.h"
+#include "map_cache.h"
+#include "position.h"
+
+// Macros
+#define GOAL_UNREACHABLE UINT32_MAX
+#define NO_COMPONENT 0
+
+// Variables
+
+/**
+ * The goal distances of a map are, for every cell, the least number of
+ * moves to reach the goal column (width - 2), going around obstacles in
+ * any of the 8 directions. Distances are u32 in row-major order, and
+ * GOAL_UNREACHABLE where no path exists.
+ */
+extern const map_analysis_t goal_distances_analysis;
+
+/**
+ * The components of a map label every free cell with the component of
+ * free cells it belongs to, connected in any of the 8 directions. Labels
+ * are u32 in row-major order, numbered from 1 in the order of the first
+ * cell of every component, and NO_COMPONENT on obstacles.
+ */
+extern const map_analysis_t components_analysis;
+
+// Functions
+uint32_t get_goal_distance(const uint32_t* distances,
+                           dimension_t dimension,
+                           position_t position);
+
+uint32_t get_component_label(const uint32_t* components,
+                             dimension_t dimension,
+                             position_t position);
+
+/**
+ * A map is drawn when its attacker can neither reach the goal column nor
+ * ever be captured by its defender, from anywhere in their components.
+ * Games on it can only end at max turns, or by a player spying more than
+ * allowed. Maps without exactly one attacker and one defender are not.
+ */
+bool is_map_drawn(Map map, const uint32_t* components);
+
+#endif // MAP_ANALYSIS_H
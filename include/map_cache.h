@@ -0,0 +1,62 @@
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+
+// Standard headers
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "map.h"
+
+// Structs
+
+/**
+ * A map cache keeps the results of per-map analyses in a directory, so
+ * they are computed once and then mapped in memory by every process.
+ * Files are addressed by the hash of the map (see hash_map), the name
+ * of the analysis and its version, and are published with an atomic
+ * rename, so readers only ever see whole files. Files keep the grid of
+ * their map, so a file of another map with the same hash, or of an older
+ * layout, is recomputed.
+ *
+ * File layout (header integers little-endian):
+ *   header: "RUGBYMAC", u32 format version, u32 analysis version,
+ *           u64 map hash, u64 height, u64 width, u64 payload size
+ *   grid: the symbols of the map, row by row, padded to a multiple of
+ *         8 bytes
+ *   payload: the result of the analysis, as computed in memory,
+ *            padded to a multiple of 8 bytes
+ */
+typedef struct map_cache* MapCache;
+
+/**
+ * A map analysis computes some data from a map, of a size known
+ * beforehand. Its version must change whenever its result changes.
+ */
+struct map_analysis {
+  const char* name; // Part of the file names, so a plain identifier
+  uint32_t version;
+  size_t (*get_size)(Map map);
+  void (*compute)(Map map, void* data);
+};
+typedef struct map_analysis map_analysis_t;
+
+/**
+ * A cached analysis is the result of an analysis for a map, either
+ * mapped from the cache or computed in memory.
+ */
+typedef struct cached_analysis* CachedAnalysis;
+
+// Functions
+MapCache new_map_cache(const char* directory);
+void delete_map_cache(MapCache cache);
+
+CachedAnalysis load_map_analysis(MapCache cache, // If NULL, nothing is cached
+                                 Map map,
+                                 const map_analysis_t* analysis);
+void delete_cached_analysis(CachedAnalysis analysis);
+
+const void* get_cached_analysis_data(CachedAnalysis analysis);
+size_t get_cached_analysis_size(CachedAnalysis analysis);
+
+#endif // MAP_CACHE_H
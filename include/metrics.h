@@ -0,0 +1,55 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// Standard headers
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "game.h"
+
+// Structs
+
+/**
+ * Metrics count the games of sweeps while they run, and serve a snapshot
+ * of the counts to every client that connects to a Unix domain socket,
+ * in the Prometheus text exposition format. The response is plain text,
+ * or an HTTP response when the client sends an HTTP request, so both
+ * `socat - UNIX-CONNECT:path` and `curl --unix-socket path` read it.
+ *
+ * Every thread counts in its own slot, padded to whole cache lines, and
+ * slots are only summed when a client connects, so that counting adds
+ * no contention to the games. A slot must be written by a single thread
+ * at a time. Released slots are reused, with their counts, so counters
+ * never go back.
+ */
+typedef struct metrics* Metrics;
+typedef struct metrics_slot* MetricsSlot;
+
+/**
+ * A metrics phase is a part of the life of a game whose latencies are
+ * recorded in a histogram: making the game, playing it, and recording
+ * its result.
+ */
+enum metrics_phase {
+  METRICS_SETUP,
+  METRICS_PLAY,
+  METRICS_RECORD,
+  NUMBER_METRICS_PHASES
+};
+
+// Functions
+Metrics new_metrics(const char* socket_path);
+void delete_metrics(Metrics metrics);
+
+MetricsSlot acquire_metrics_slot(Metrics metrics);
+void release_metrics_slot(MetricsSlot slot);
+
+void count_metrics_game(MetricsSlot slot, game_result_t result);
+void count_metrics_failures(MetricsSlot slot, size_t number_games);
+void observe_metrics_phase(MetricsSlot slot,
+                           enum metrics_phase phase,
+                           uint64_t nanoseconds,
+                           size_t number_games);
+
+#endif // METRICS_H
@@ -0,0 +1,57 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "dimension.h"
+#include "position.h"
+
+// Structs
+
+/**
+ * An occupancy is a spatial index that maps each cell of a 2D grid to
+ * the agent occupying it. Cells are bucketed in square tiles that fill
+ * exactly one cache line, so the 8 neighbors of a cell are found in at
+ * most 4 cache lines. Insertions, removals and moves are O(1).
+ */
+typedef struct occupancy* Occupancy;
+
+/**
+ * An occupant packs the team of an agent in its highest bits and the
+ * index of the agent inside its team in the lowest ones.
+ * NO_OCCUPANT marks an empty cell.
+ */
+typedef uint32_t occupant_t;
+
+// Macros
+#define NO_OCCUPANT ((occupant_t) 0)
+#define OCCUPANT_TEAM_BITS 4
+#define OCCUPANT_MAX_INDEX ((1UL << (32 - OCCUPANT_TEAM_BITS)) - 2)
+
+// Functions
+Occupancy new_occupancy(dimension_t dimension);
+void delete_occupancy(Occupancy occupancy);
+
+dimension_t get_occupancy_dimension(Occupancy occupancy);
+
+occupant_t make_occupant(unsigned team, size_t index);
+unsigned get_occupant_team(occupant_t occupant);
+size_t get_occupant_index(occupant_t occupant);
+
+occupant_t get_occupant(Occupancy occupancy, position_t position);
+bool is_position_free(Occupancy occupancy, position_t position);
+
+void set_occupant(Occupancy occupancy,
+                  position_t position,
+                  occupant_t occupant);
+void move_occupant(Occupancy occupancy, position_t from, position_t to);
+
+bool has_neighbor_from_team(Occupancy occupancy,
+                            position_t center,
+                            unsigned team);
+
+#endif // OCCUPANCY_H
@@ -4,9 +4,9 @@
 // Standard headers
 #include <stdbool.h>
 #include <stddef.h>
-#include <limits.h>
 
 // Internal headers
+#include "coordinate.h"
 #include "direction.h"
 
 // Structs
@@ -15,13 +15,13 @@
  * A position represents where an object is in a 2D grid.
  */
 struct position {
-  size_t i;
-  size_t j;
+  coordinate_t i;
+  coordinate_t j;
 };
 typedef struct position position_t;
 
 // Macros
-#define INVALID_POSITION { ULONG_MAX, ULONG_MAX }
+#define INVALID_POSITION { COORDINATE_MAX, COORDINATE_MAX }
 
 // Functions
 bool equal_positions(position_t p1, position_t p2);
@@ -0,0 +1,48 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Standard headers
+#include <stdint.h>
+
+// Internal headers
+#include "clock.h"
+
+// Structs
+
+/**
+ * A profile phase is a section of the code whose calls are counted,
+ * and whose latencies are recorded in a histogram.
+ */
+enum profile_phase {
+  PROFILE_NEW_MAP,
+  PROFILE_NEW_GAME_FROM_MAP,
+  PROFILE_TURN,
+  PROFILE_STRATEGY_DECISION,
+  PROFILE_MOVE_ITEM_IN_FIELD,
+  PROFILE_WIN_CHECKS,
+  PROFILE_RENDERING,
+  NUMBER_PROFILE_PHASES
+};
+
+// Macros
+
+/**
+ * Profiling is only compiled in with RUGBY_PROFILE defined (see the
+ * PROFILE option of the Makefile). Otherwise, these macros expand to
+ * nothing and add no cost at all to the profiled code.
+ * Every PROFILE_BEGIN must be matched by a PROFILE_END in the same scope.
+ */
+#ifdef RUGBY_PROFILE
+#define PROFILE_BEGIN(phase) \
+  uint64_t phase##_begin = read_monotonic_nanoseconds()
+#define PROFILE_END(phase) \
+  record_profile_sample(phase, read_monotonic_nanoseconds() - phase##_begin)
+#else
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#endif
+
+// Functions
+void record_profile_sample(enum profile_phase phase, uint64_t nanoseconds);
+
+#endif // PROFILER_H
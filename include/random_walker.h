@@ -0,0 +1,21 @@
+#ifndef RANDOM_WALKER_H
+#define RANDOM_WALKER_H
+
+// Internal headers
+#include "direction.h"
+#include "position.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Functions
+
+/**
+ * Baseline algorithm to move any player in a Game: it never spies,
+ * and takes one of the 8 directions at random every turn. Other
+ * strategies can be rated against it.
+ */
+direction_t execute_random_walker_strategy(position_t position,
+                                           Spy opponent_spy,
+                                           StrategyContext context);
+
+#endif // RANDOM_WALKER_H
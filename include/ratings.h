@@ -0,0 +1,50 @@
+#ifndef RATINGS_H
+#define RATINGS_H
+
+// Standard headers
+#include <stddef.h>
+
+// Internal headers
+#include "game.h"
+
+// Structs
+
+/**
+ * Ratings estimate the strength of players (strategies) from a stream
+ * of game outcomes, in the Elo scale. Only the number of wins, draws and
+ * losses of each matchup is kept, so any number of games fits in memory.
+ * Outcomes are counted in per-thread slots, so that many workers can feed
+ * the same ratings without contention. Slots are only summed when the
+ * standings are computed.
+ */
+typedef struct ratings* Ratings;
+
+/**
+ * A rating is the estimated strength of a player, and the half-width of
+ * its 95% confidence interval, both in Elo points.
+ */
+struct rating {
+  size_t player;
+  double elo;
+  double confidence;
+  size_t number_games;
+};
+typedef struct rating rating_t;
+
+// Functions
+Ratings new_ratings(size_t number_players, size_t number_slots);
+void delete_ratings(Ratings ratings);
+
+size_t get_ratings_number_players(Ratings ratings);
+void set_rating_player_name(Ratings ratings, size_t player, const char* name);
+
+void record_rating_outcome(Ratings ratings,
+                           size_t slot,
+                           size_t attacker_player,
+                           size_t defender_player,
+                           enum game_winner winner);
+
+void compute_rating_standings(Ratings ratings, rating_t* standings);
+void print_rating_standings(Ratings ratings);
+
+#endif // RATINGS_H
@@ -0,0 +1,80 @@
+#ifndef RESULT_SINK_H
+#define RESULT_SINK_H
+
+// Standard headers
+#include <stddef.h>
+#include <stdint.h>
+
+// Structs
+
+/**
+ * A result sink appends one record per game to a columnar binary file.
+ * Records are gathered in blocks of up to RESULT_BLOCK_ROWS rows, and
+ * every column of a block is compressed on its own, with whichever of
+ * plain, delta or run-length encoding is the smallest.
+ *
+ * File layout (all integers little-endian):
+ *   header: "RUGBYRES", u32 version, u32 number of columns
+ *   blocks: u32 "BLCK", u32 number of rows,
+ *           per column: u8 encoding, 3 padding bytes, u32 payload size,
+ *           then the payloads of all columns, in column order
+ */
+typedef struct result_sink* ResultSink;
+
+/**
+ * A result buffer gathers the records of a single thread, so threads
+ * only share the sink to write whole compressed blocks.
+ */
+typedef struct result_buffer* ResultBuffer;
+
+enum result_column {
+  RESULT_MAP_ID,
+  RESULT_SEED,
+  RESULT_ATTACKER_STRATEGY,
+  RESULT_DEFENDER_STRATEGY,
+  RESULT_WINNER,
+  RESULT_END_REASON,
+  RESULT_NUMBER_TURNS,
+  RESULT_ATTACKER_SPY_USES,
+  RESULT_DEFENDER_SPY_USES,
+  RESULT_WALL_NANOSECONDS,
+  NUMBER_RESULT_COLUMNS
+};
+
+/**
+ * A game record holds the value of every column for a single game.
+ */
+struct game_record {
+  uint64_t values[NUMBER_RESULT_COLUMNS];
+};
+typedef struct game_record game_record_t;
+
+/**
+ * A result block visitor receives every block of a result file, decoded
+ * as one array of values per column.
+ */
+typedef void (*ResultBlockVisitor)(size_t number_rows,
+                                   uint64_t* const* columns,
+                                   void* data);
+
+// Macros
+#define RESULT_BLOCK_ROWS 4096
+
+// Functions
+ResultSink new_result_sink(const char* path);
+void delete_result_sink(ResultSink sink);
+
+uint64_t sync_result_sink(ResultSink sink);
+void truncate_result_sink(ResultSink sink, uint64_t size);
+
+ResultBuffer new_result_buffer(ResultSink sink);
+void delete_result_buffer(ResultBuffer buffer);
+
+void append_game_record(ResultBuffer buffer, const game_record_t* record);
+void flush_result_buffer(ResultBuffer buffer);
+
+size_t scan_result_file(const char* path,
+                        ResultBlockVisitor visit_block,
+                        void* data);
+
+#endif // RESULT_SINK_H
@@ -0,0 +1,31 @@
+#ifndef RNG_H
+#define RNG_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stdint.h>
+
+// Structs
+
+/**
+ * A rng is the state of a xoshiro256** pseudo-random number generator.
+ * Each game owns its generators, so games never share hidden state
+ * and a whole run can be reproduced from a single seed.
+ */
+struct rng {
+  uint64_t state[4];
+};
+typedef struct rng rng_t;
+
+// Functions
+rng_t seed_rng(uint64_t seed);
+rng_t split_rng(rng_t* rng);
+
+uint64_t next_random(rng_t* rng);
+uint64_t random_below(rng_t* rng, uint64_t bound);
+bool random_bool(rng_t* rng);
+double random_unit(rng_t* rng);
+
+uint64_t mix_seed(uint64_t seed, uint64_t stream);
+
+#endif // RNG_H
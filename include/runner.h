@@ -0,0 +1,146 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "dimension.h"
+#include "game.h"
+#include "map.h"
+#include "map_cache.h"
+#include "metrics.h"
+#include "ratings.h"
+#include "result_sink.h"
+
+// Structs
+
+/**
+ * A runner configuration describes a sweep of headless games, played
+ * in parallel by a pool of workers. Every game gets its own seed,
+ * derived from the sweep seed and the index of the game, so a sweep
+ * gives the same results whatever the number of workers and the order
+ * in which they play the games (see scheduler.h). Games on a drawn
+ * map (see map_analysis.h) are resolved as draws without playing them,
+ * unless a player is a bot.
+ */
+struct runner_config {
+  Map map; // Games are made from the map, if any...
+  dimension_t field_dimension; // ...or are standard games of this size
+
+  size_t max_number_spies;
+  size_t max_turns;
+  bool simultaneous_moves;
+  bool concurrent_decisions; // Of simultaneous moves (see game.h)
+
+  PlayerStrategy attacker_strategy;
+  PlayerStrategy defender_strategy;
+  // If given, vectors of STRATEGY_MAX_PARAMETERS values, zero past those
+  // of the strategy, which replace its defaults (see strategy.h)
+  const double* attacker_parameters;
+  const double* defender_parameters;
+
+  // Unless NO_TURN_BUDGET, the nanoseconds strategies have to decide
+  // every move, and the fallback when they miss it (see game.h). Games
+  // played in batches have no budget.
+  uint64_t turn_budget;
+  enum turn_fallback turn_fallback;
+
+  size_t number_games;
+  size_t number_workers;
+  uint64_t seed;
+  bool batched; // Play games in lockstep batches (see batch.h)
+
+  // If given, the expected number of turns of each game, so the longest
+  // games are played first and batches gather games of similar length
+  const uint32_t* expected_turns;
+
+  // If given, the players are bots run by these shell commands, one
+  // per worker (see bot.h), and games are always played in batches
+  const char* attacker_bot;
+  const char* defender_bot;
+
+  // If given, every outcome is also recorded in the ratings,
+  // and the standings are printed every report_period seconds
+  Ratings ratings;
+  size_t attacker_player;
+  size_t defender_player;
+  double report_period;
+
+  // If given, every game is also recorded in the results, where the
+  // players identify the strategies and map_id identifies the map
+  ResultSink results;
+  uint64_t map_id;
+
+  // If given, the progress of the sweep is saved to this file every
+  // checkpoint_period seconds, and a sweep that finds a checkpoint of
+  // the same configuration there skips its completed games, and drops
+  // the results recorded after it (see checkpoint.h). Sweeps with a
+  // turn budget depend on timings, so they cannot have one
+  const char* checkpoint_path;
+  double checkpoint_period;
+
+  // If given, every game is also counted in the metrics, in a slot of
+  // the worker that played it (see metrics.h)
+  Metrics metrics;
+
+  // If given, the analyses of the map, which tell drawn maps, are kept
+  // in it across runs (see map_cache.h)
+  MapCache cache;
+};
+typedef struct runner_config runner_config_t;
+
+/**
+ * A runner keeps the workers of its sweeps, and what it found out about
+ * its map, from one sweep to the next, so that a series of short sweeps,
+ * such as the batches of an evaluation, only starts them once. Sweeps
+ * of a runner share its configuration, but for the fields of the runner
+ * sweep, which replace those of the configuration.
+ */
+typedef struct runner* Runner;
+
+/**
+ * If given, winners receives the winner of every game of the sweep, by
+ * index, or NUMBER_GAME_WINNERS for failed games and for games completed
+ * before a checkpoint.
+ */
+struct runner_sweep {
+  size_t number_games;
+  uint64_t seed;
+  PlayerStrategy attacker_strategy;
+  PlayerStrategy defender_strategy;
+  size_t attacker_player;
+  size_t defender_player;
+  enum game_winner* winners;
+};
+typedef struct runner_sweep runner_sweep_t;
+
+/**
+ * A runner summary aggregates the results of all games of a sweep.
+ * Games resolved on a drawn map are draws ended by MAP_DRAWN, without
+ * any turn, as they are never played.
+ */
+struct runner_summary {
+  size_t number_games;
+  size_t number_failed_games;
+  size_t number_turns;
+  size_t winners[NUMBER_GAME_WINNERS];
+  size_t end_reasons[NUMBER_GAME_END_REASONS];
+  double wall_seconds;
+};
+typedef struct runner_summary runner_summary_t;
+
+// Functions
+Runner new_runner(runner_config_t config);
+void delete_runner(Runner runner);
+runner_summary_t run_runner_sweep(Runner runner, runner_sweep_t sweep);
+
+// Plays the sweep of the configuration on a runner of its own
+runner_summary_t run_games(runner_config_t config);
+void print_runner_summary(runner_summary_t summary);
+void merge_runner_summaries(runner_summary_t* into,
+                            const runner_summary_t* from);
+
+#endif // RUNNER_H
@@ -0,0 +1,40 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Structs
+
+/**
+ * A scheduler hands out the tasks of a sweep to a pool of workers.
+ * Every worker owns a deque, dealt an equal share of the tasks, and
+ * takes its tasks from the front. A worker with an empty deque steals
+ * the back half of the fullest deque, so a worker stuck with long games
+ * gives away its remaining work in a single step. Tasks are taken in
+ * chunks, such as a batch of games at a time.
+ * A deque is a range of tasks packed in one atomic word, so taking and
+ * stealing are single compare-and-swaps, and no lock is ever held.
+ *
+ * Tasks are plain indices, in the order given by their costs: if costs
+ * are given, the most expensive tasks are dealt and taken first.
+ */
+typedef struct scheduler* Scheduler;
+
+// Macros
+#define SCHEDULER_MAX_TASKS UINT32_MAX
+
+// Functions
+Scheduler new_scheduler(size_t number_tasks,
+                        size_t number_workers,
+                        const uint32_t* costs); // Optional, one per task
+void delete_scheduler(Scheduler scheduler);
+
+size_t take_scheduled_tasks(Scheduler scheduler,
+                            size_t worker,
+                            size_t* tasks,
+                            size_t max_number_tasks);
+
+#endif // SCHEDULER_H
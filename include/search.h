@@ -0,0 +1,94 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "dimension.h"
+#include "direction.h"
+#include "game.h"
+#include "map_cache.h"
+#include "position.h"
+
+// Structs
+
+/**
+ * A search looks for the best move of a player in the game tree of the
+ * layout of a game. In the tree, both players know where the other is,
+ * and every turn is played as play_turn plays it: the attacker moves,
+ * then the defender, then the turn is checked for an arrival, and then
+ * for a capture. Spies are not part of the tree.
+ *
+ * Threads search the same root together (lazy SMP): each of them deepens
+ * on its own, from staggered depths, and they only share what they find
+ * through a transposition table. The table is lock-free: an entry is
+ * two words, its key xor its data, and its data, so an entry torn by two
+ * writers fails the check of its key, and is ignored.
+ */
+typedef struct search* Search;
+
+enum search_player { SEARCH_ATTACKER, SEARCH_DEFENDER };
+
+/**
+ * Scores are for the searching player. A won game scores SEARCH_WIN_SCORE
+ * plus the plies left when it is won, so faster wins score more, and a
+ * lost game scores the opposite.
+ */
+struct search_result {
+  direction_t direction;
+  int32_t score;
+  size_t depth; // In plies, completed by the thread that found the move
+  size_t number_threads;
+  uint64_t number_nodes;
+  uint64_t nanoseconds;
+};
+typedef struct search_result search_result_t;
+
+/**
+ * A progress callback is called by the calling thread of a search after
+ * every depth it completes, with the best move found at that depth, and
+ * the search stops there when it returns false. Anytime callers offer
+ * every such move, and may bound the depth of their searches.
+ */
+typedef bool (*SearchProgress)(direction_t direction,
+                               size_t depth,
+                               void* data);
+
+// Macros
+#define SEARCH_WIN_SCORE 1000000
+
+// Functions
+Search new_search(Game game,
+                  MapCache cache, // If given, goal distances are cached in it
+                  size_t table_bytes);
+Search new_layout_search(dimension_t dimension,
+                         const bool* obstacles, // As in strategy.h
+                         MapCache cache,
+                         size_t table_bytes);
+void delete_search(Search search);
+
+/**
+ * Clearing a search forgets the entries of its previous searches, so
+ * that the next one does not depend on them.
+ */
+void clear_search(Search search);
+void set_search_progress(Search search, SearchProgress progress, void* data);
+
+/**
+ * The root is the turn of the player, with that many turns left, counting
+ * that turn. When the defender searches, the attacker has already moved.
+ * The search stops at the budget, or as soon as the result is exact, and
+ * always completes at least one ply.
+ */
+search_result_t search_best_move(Search search,
+                                 position_t attacker_position,
+                                 position_t defender_position,
+                                 enum search_player player,
+                                 size_t remaining_turns,
+                                 size_t number_threads,
+                                 uint64_t budget_nanoseconds);
+
+#endif // SEARCH_H
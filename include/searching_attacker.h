@@ -0,0 +1,27 @@
+#ifndef SEARCHING_ATTACKER_H
+#define SEARCHING_ATTACKER_H
+
+// Internal headers
+#include "direction.h"
+#include "position.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Functions
+
+/**
+ * Anytime algorithm to move Attacker player in a Game, which searches
+ * the game tree (see search.h) up to the last turn of its game, as if
+ * the defender came closer from where it was last seen, or else from
+ * where it started. It spies, as long as its game allows, when the
+ * defender may be a few cells away. It offers the move of every depth
+ * it completes: with a turn budget, it searches until its deadline, and
+ * otherwise up to a fixed depth, so that its games only depend on their
+ * seed. Contexts without a layout or limits, as those of bots, only run
+ * right.
+ */
+direction_t execute_searching_attacker_strategy(position_t attacker_position,
+                                                Spy defender_spy,
+                                                StrategyContext context);
+
+#endif // SEARCHING_ATTACKER_H
@@ -20,6 +20,8 @@ typedef struct spy* Spy;
 Spy new_spy(Item item);
 void delete_spy(Spy spy);
 
+void reset_spy(Spy spy);
+
 position_t get_spy_position(Spy spy);
 size_t get_spy_number_uses(Spy spy);
 
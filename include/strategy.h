@@ -0,0 +1,108 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "dimension.h"
+#include "direction.h"
+#include "rng.h"
+
+// Structs
+
+/**
+ * A strategy context holds everything a player strategy keeps between
+ * turns of a single game: its random generator and its private state.
+ * The state is a fixed-size block of plain data, zeroed when the context
+ * is reset, so strategies must treat an all-zero state as a new game.
+ * A context may also hold a parameter vector, kept across resets, which
+ * replaces the default constants of the strategy, and a scratch object
+ * of any size, also kept across resets and deleted with the context,
+ * for state that does not fit (the strategy resets its content).
+ */
+typedef struct strategy_context* StrategyContext;
+
+// Macros
+#define STRATEGY_STATE_SIZE 128
+#define STRATEGY_MAX_PARAMETERS 8
+#define NO_STRATEGY_DEADLINE UINT64_MAX
+
+/**
+ * A parameter space describes the parameter vector of a strategy: the
+ * name, default value and bounds of every parameter. Integer parameters
+ * are rounded by the strategy.
+ */
+struct parameter_space {
+  size_t number_parameters;
+  const char* const* names;
+  const double* defaults;
+  const double* lower_bounds;
+  const double* upper_bounds;
+};
+typedef struct parameter_space parameter_space_t;
+
+// Functions
+StrategyContext new_strategy_context(rng_t rng);
+void delete_strategy_context(StrategyContext context);
+
+void reset_strategy_context(StrategyContext context, rng_t rng);
+
+rng_t* get_strategy_rng(StrategyContext context);
+void* get_strategy_state(StrategyContext context);
+
+const double* get_strategy_parameters(StrategyContext context);
+void set_strategy_parameters(StrategyContext context,
+                             const double* parameters); // NULL for defaults
+
+uint64_t hash_strategy_context(StrategyContext context, uint64_t hash);
+
+/**
+ * The layout of a context is the field of its games: its dimension,
+ * borders included, and a row-major mask of the cells holding an
+ * obstacle. It is given once, before the first turn, and kept across
+ * resets, and the mask belongs to the caller. Contexts of bots, which
+ * are not told the field, have no layout: a NULL mask and a null
+ * dimension.
+ */
+void set_strategy_layout(StrategyContext context,
+                         dimension_t dimension,
+                         const bool* obstacles);
+dimension_t get_strategy_dimension(StrategyContext context);
+const bool* get_strategy_obstacles(StrategyContext context);
+
+/**
+ * The limits of a context are those of the game it plays: its most
+ * turns, and the most times every player may spy. They are given when
+ * the game starts to play, and kept across resets. Contexts of bots have
+ * no limits: 0 for both.
+ */
+void set_strategy_limits(StrategyContext context,
+                         size_t max_turns,
+                         size_t max_number_spies);
+size_t get_strategy_max_turns(StrategyContext context);
+size_t get_strategy_max_number_spies(StrategyContext context);
+
+/**
+ * A turn deadline tells an anytime strategy when it must have decided,
+ * in nanoseconds of the monotonic clock (see clock.h). Such a strategy
+ * checks it with is_strategy_out_of_time, and offers its best move so
+ * far with offer_strategy_move: if it returns after the deadline, its
+ * last offer made in time is played instead. A turn starts without
+ * offer, and contexts have NO_STRATEGY_DEADLINE unless their game has a
+ * turn budget (see game.h).
+ */
+void start_strategy_turn(StrategyContext context, uint64_t deadline);
+uint64_t get_strategy_deadline(StrategyContext context);
+bool is_strategy_out_of_time(StrategyContext context);
+void offer_strategy_move(StrategyContext context, direction_t direction);
+bool get_strategy_offer(StrategyContext context, direction_t* direction);
+
+void* get_strategy_scratch(StrategyContext context);
+void set_strategy_scratch(StrategyContext context,
+                          void* scratch,
+                          void (*delete_scratch)(void* scratch));
+
+#endif // STRATEGY_H
@@ -0,0 +1,45 @@
+#ifndef TEAM_H
+#define TEAM_H
+
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+
+// Internal headers
+#include "coordinate.h"
+#include "direction.h"
+#include "position.h"
+
+// Structs
+
+/**
+ * A team is a group of agents stored as a struct-of-arrays: the lines
+ * and columns of all agents live in parallel arrays, so that a pass over
+ * the whole team touches contiguous memory. The symbol and movability
+ * are shared by all agents of the team.
+ */
+typedef struct team* Team;
+
+// Macros
+#define TEAM_INVALID_INDEX ((size_t) -1)
+
+// Functions
+Team new_team(char symbol, bool is_movable);
+void delete_team(Team team);
+
+size_t add_agent_to_team(Team team, position_t position);
+void remove_agent_from_team(Team team, size_t index);
+
+size_t get_team_size(Team team);
+char get_team_symbol(Team team);
+bool is_team_movable(Team team);
+
+const coordinate_t* get_team_lines(Team team);
+const coordinate_t* get_team_columns(Team team);
+
+position_t get_agent_position(Team team, size_t index);
+void set_agent_position(Team team, size_t index, position_t new_position);
+
+size_t count_agents_in_column(Team team, coordinate_t column);
+
+#endif // TEAM_H
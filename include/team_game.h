@@ -0,0 +1,41 @@
+#ifndef TEAM_GAME_H
+#define TEAM_GAME_H
+
+// Internal headers
+#include "dimension.h"
+#include "direction.h"
+#include "map.h"
+#include "team.h"
+
+// Structs
+
+/**
+ * A team game is a N-vs-M variant of a Game: a team of attackers
+ * competes against a team of defenders in the same field.
+ * Attackers win if any of them arrives at the end of the field,
+ * and defenders win if they capture every attacker.
+ */
+typedef struct team_game* TeamGame;
+
+/**
+ * A team strategy decides the directions of a whole team at once.
+ * Given the positions of the agents as parallel arrays of lines and
+ * columns, it should fill one direction per agent.
+ */
+typedef void (*TeamStrategy)(dimension_t field_dimension,
+                             size_t number_agents,
+                             const coordinate_t* lines,
+                             const coordinate_t* columns,
+                             direction_t* directions);
+
+// Functions
+TeamGame new_team_game_from_map(
+    Map map,
+    TeamStrategy attackers_strategy,
+    TeamStrategy defenders_strategy);
+
+void delete_team_game(TeamGame game);
+void print_team_game(TeamGame game);
+void play_team_game(TeamGame game, size_t max_turns);
+
+#endif // TEAM_GAME_H
@@ -0,0 +1,33 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+// Standard headers
+#include <stdint.h>
+
+// Internal headers
+#include "clock.h"
+
+// Macros
+
+/**
+ * Tracing is only compiled in with RUGBY_TRACE defined (see the TRACE
+ * option of the Makefile). It records spans of execution per thread and
+ * writes them as a Chrome Trace Event file, to be opened in a timeline
+ * viewer such as chrome://tracing or Perfetto. Otherwise, these macros
+ * expand to nothing.
+ * Every TRACE_BEGIN must be matched by a TRACE_END in the same scope.
+ */
+#ifdef RUGBY_TRACE
+#define TRACE_BEGIN(span) \
+  uint64_t span##_trace_begin = read_monotonic_nanoseconds()
+#define TRACE_END(span, name) \
+  record_trace_span(name, span##_trace_begin, read_monotonic_nanoseconds())
+#else
+#define TRACE_BEGIN(span)
+#define TRACE_END(span, name)
+#endif
+
+// Functions
+void record_trace_span(const char* name, uint64_t begin, uint64_t end);
+
+#endif // TRACER_H
@@ -0,0 +1,23 @@
+#ifndef TRACKING_DEFENDER_H
+#define TRACKING_DEFENDER_H
+
+// Internal headers
+#include "direction.h"
+#include "position.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Functions
+
+/**
+ * Algorithm to move Defender player in a Game, which keeps a belief of
+ * the cells where the attacker may be. It meets the expected attacker
+ * without leaving the column in front of the goal, and spies when the
+ * belief is spread enough for the spy to tell the most, or as a last
+ * chance before the attacker may reach that column.
+ */
+direction_t execute_tracking_defender_strategy(position_t defender_position,
+                                               Spy attacker_spy,
+                                               StrategyContext context);
+
+#endif // TRACKING_DEFENDER_H
@@ -0,0 +1,48 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+// Standard headers
+#include <stddef.h>
+
+// Internal headers
+#include "evaluation.h"
+#include "runner.h"
+#include "strategy.h"
+
+// Structs
+
+/**
+ * A tuner configuration describes a search for the best parameters of
+ * the strategy of one side, against the strategy of the other side.
+ * The search is a separable CMA-ES: every generation samples candidate
+ * vectors around a mean, with one step size per parameter, scores each
+ * candidate with a sweep of number_games parallel games (1 for a win,
+ * 1/2 for a draw), and moves the mean and the step sizes toward the
+ * best candidates. All candidates of a generation play the same seeds,
+ * so none of them is favored by luckier games.
+ */
+struct tuner_config {
+  runner_config_t runner; // Parameters of the tuned side are replaced
+  enum evaluated_side side;
+  const parameter_space_t* space;
+
+  size_t population_size; // If zero, 4 + 3 ln(number of parameters)
+  size_t number_generations;
+  double initial_step; // Fraction of the range of every parameter
+};
+typedef struct tuner_config tuner_config_t;
+
+struct tuner_result {
+  size_t number_parameters;
+  double parameters[STRATEGY_MAX_PARAMETERS]; // Final mean
+  double score; // Of the final mean...
+  double default_score; // ...and of the defaults, on the same fresh seeds
+  size_t number_games; // Played during the whole search
+};
+typedef struct tuner_result tuner_result_t;
+
+// Functions
+tuner_result_t tune_strategy(tuner_config_t config);
+void print_tuner_result(tuner_result_t result, const parameter_space_t* space);
+
+#endif // TUNER_H
@@ -1,12 +1,15 @@
 // Standard headers
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 // Internal headers
+#include "dimension.h"
 #include "direction.h"
 #include "position.h"
+#include "rng.h"
 #include "spy.h"
+#include "strategy.h"
 
 // Main header
 #include "attacker.h"
@@ -15,20 +18,63 @@
 #define UNUSED(x) (void)(x) // Auxiliary to avoid error of unused parameter
 
 /*----------------------------------------------------------------------------*/
-/*                         PRIVATE VARIABLES                                  */
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
 /*----------------------------------------------------------------------------*/
 
 enum Attack_state{START, DISTRACT, GO_TO_CENTER, SPRINT};
-static enum Attack_state state = START;
 
-static position_t previous_position;
-static direction_t current_direction;
+// Kept in the strategy context, which starts zeroed (in the START state)
+struct attacker_state {
+  enum Attack_state state;
+
+  position_t previous_position;
+  direction_t current_direction;
+
+  size_t height_estimate; // Either height or (height - 1)
+
+  size_t rounds_stuck;
+  size_t rotations_clockwise;
+  size_t rotations_counterclockwise;
+};
+
+_Static_assert(sizeof(struct attacker_state) <= STRATEGY_STATE_SIZE,
+               "Attacker state must fit in a strategy context");
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
 
-static size_t height_estimate; // Either height or (height - 1)
+static const char* const parameter_names[NUMBER_ATTACKER_PARAMETERS] = {
+  [ATTACKER_SPY_HEIGHT]      = "spy height",
+  [ATTACKER_STUCK_THRESHOLD] = "stuck threshold",
+};
 
-static size_t rounds_stuck = 0;
-static size_t rotations_clockwise = 0;
-static size_t rotations_counterclockwise = 0;
+static const double default_parameters[NUMBER_ATTACKER_PARAMETERS] = {
+  [ATTACKER_SPY_HEIGHT]      = 0.5,
+  [ATTACKER_STUCK_THRESHOLD] = 3,
+};
+
+static const double lower_bounds[NUMBER_ATTACKER_PARAMETERS] = {
+  [ATTACKER_SPY_HEIGHT]      = 0.0,
+  [ATTACKER_STUCK_THRESHOLD] = 2, // Detours step back two turns
+};
+
+static const double upper_bounds[NUMBER_ATTACKER_PARAMETERS] = {
+  [ATTACKER_SPY_HEIGHT]      = 1.0,
+  [ATTACKER_STUCK_THRESHOLD] = 8,
+};
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC VARIABLES                              */
+/*----------------------------------------------------------------------------*/
+
+const parameter_space_t attacker_parameter_space = {
+  .number_parameters = NUMBER_ATTACKER_PARAMETERS,
+  .names = parameter_names,
+  .defaults = default_parameters,
+  .lower_bounds = lower_bounds,
+  .upper_bounds = upper_bounds,
+};
 
 /*----------------------------------------------------------------------------*/
 /*                          PRIVATE FUNCTIONS HEADERS                         */
@@ -37,41 +83,46 @@ static size_t rotations_counterclockwise = 0;
 static direction_t rotate_clockwise(direction_t direction, size_t rotations);
 static direction_t rotate_counterclockwise(direction_t direction, size_t rotations);
 
-static direction_t obstacle_evasion_direction();
-static direction_t execute_detour_strategy();
-static void reset_stuck_data();
+static direction_t obstacle_evasion_direction(struct attacker_state* s);
+static direction_t execute_detour_strategy(struct attacker_state* s);
+static void reset_stuck_data(struct attacker_state* s);
 
 /*----------------------------------------------------------------------------*/
 /*                              PUBLIC FUNCTIONS                              */
 /*----------------------------------------------------------------------------*/
 
 direction_t execute_attacker_strategy(
-    position_t attacker_position, Spy defender_spy) {
+    position_t attacker_position, Spy defender_spy, StrategyContext context) {
+  struct attacker_state* s = get_strategy_state(context);
+
+  const double* parameters = get_strategy_parameters(context);
+  if (parameters == NULL) parameters = default_parameters;
+
+  size_t stuck_threshold = lround(parameters[ATTACKER_STUCK_THRESHOLD]);
 
   /* Check if attacker is stuck */
-  if (equal_positions(attacker_position, previous_position)) {
-    rounds_stuck++;
-    return obstacle_evasion_direction();
+  if (equal_positions(attacker_position, s->previous_position)) {
+    s->rounds_stuck++;
+    return obstacle_evasion_direction(s);
   }
-  else if (rounds_stuck >= 3) {
-    return execute_detour_strategy();
+  else if (s->rounds_stuck >= stuck_threshold) {
+    return execute_detour_strategy(s);
   }
   else {
-    reset_stuck_data();
+    reset_stuck_data(s);
   }
 
-  switch (state) {
+  switch (s->state) {
     case START :
-      height_estimate = attacker_position.i * 2;
+      s->height_estimate = attacker_position.i * 2;
 
       // Randomly chooses between going UP or DOWN
-      srand((int) time(NULL));
-      if (rand() <= RAND_MAX / 2)
-        current_direction = (direction_t) DIR_UP;
+      if (random_bool(get_strategy_rng(context)))
+        s->current_direction = (direction_t) DIR_UP;
       else
-        current_direction = (direction_t) DIR_DOWN;
-      
-      state = DISTRACT;
+        s->current_direction = (direction_t) DIR_DOWN;
+
+      s->state = DISTRACT;
       break;
 
     case DISTRACT :
@@ -79,13 +130,13 @@ direction_t execute_attacker_strategy(
        * then start moving to the center in a diagonal line
        */
       if (attacker_position.i == 1) { // Top of the field
-        current_direction = (direction_t) DIR_DOWN_RIGHT;
-        state = GO_TO_CENTER;
+        s->current_direction = (direction_t) DIR_DOWN_RIGHT;
+        s->state = GO_TO_CENTER;
       }
 
-      else if (attacker_position.i >= height_estimate - 2) { // Bottom of the field
-        current_direction = (direction_t) DIR_UP_RIGHT;
-        state = GO_TO_CENTER;
+      else if (attacker_position.i >= s->height_estimate - 2) { // Bottom of the field
+        s->current_direction = (direction_t) DIR_UP_RIGHT;
+        s->state = GO_TO_CENTER;
       }
       break;
 
@@ -93,17 +144,18 @@ direction_t execute_attacker_strategy(
       /* Keep going until you are close to the center, then Spy and
        * start sprinting to the opposite side of the defender
        */
-      if (attacker_position.i == height_estimate / 2) {
+      if (attacker_position.i
+          == (size_t) (s->height_estimate * parameters[ATTACKER_SPY_HEIGHT])) {
         size_t defender_i_at_spy = get_spy_position(defender_spy).i;
 
         if (attacker_position.i > defender_i_at_spy) {
-          current_direction = (direction_t) DIR_DOWN_RIGHT;
+          s->current_direction = (direction_t) DIR_DOWN_RIGHT;
         }
         else { // Defender is below or on the same height
-          current_direction = (direction_t) DIR_UP_RIGHT;
+          s->current_direction = (direction_t) DIR_UP_RIGHT;
         }
 
-        state = SPRINT;
+        s->state = SPRINT;
       }
       break;
 
@@ -112,18 +164,39 @@ direction_t execute_attacker_strategy(
        * If you reach a wall, just move straight ahead
        */
       if (attacker_position.i == 1 ||
-          attacker_position.i >= height_estimate - 2)
+          attacker_position.i >= s->height_estimate - 2)
       {
-        current_direction = (direction_t) DIR_RIGHT;
+        s->current_direction = (direction_t) DIR_RIGHT;
       }
       break;
 
     default : // Invalid state. Restart strategy
-      state = START;
+      s->state = START;
   }
 
-  previous_position = attacker_position;
-  return current_direction;
+  s->previous_position = attacker_position;
+  return s->current_direction;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void execute_attackers_team_strategy(dimension_t field_dimension,
+                                     size_t number_attackers,
+                                     const coordinate_t* lines,
+                                     const coordinate_t* columns,
+                                     direction_t* directions) {
+  UNUSED(columns);
+
+  for (size_t a = 0; a < number_attackers; a++) {
+    directions[a] = (direction_t) DIR_RIGHT;
+
+    // One third of the team goes up, one third goes down,
+    // until they reach the borders of the field
+    if (a % 3 == 0 && lines[a] > 1)
+      directions[a] = (direction_t) DIR_UP_RIGHT;
+    else if (a % 3 == 2 && lines[a] < field_dimension.height - 2)
+      directions[a] = (direction_t) DIR_DOWN_RIGHT;
+  }
 }
 
 /*----------------------------------------------------------------------------*/
@@ -154,27 +227,27 @@ direction_t rotate_counterclockwise(direction_t direction, size_t rotations) {
   return d;
 }
 
-direction_t obstacle_evasion_direction() {
-  if (rounds_stuck % 2 == 1)
-    return rotate_clockwise(current_direction, ++rotations_clockwise);
+direction_t obstacle_evasion_direction(struct attacker_state* s) {
+  if (s->rounds_stuck % 2 == 1)
+    return rotate_clockwise(s->current_direction, ++s->rotations_clockwise);
   else
-    return rotate_counterclockwise(current_direction,
-                                        ++rotations_counterclockwise);
+    return rotate_counterclockwise(s->current_direction,
+                                   ++s->rotations_counterclockwise);
 }
 
-direction_t execute_detour_strategy() {
-  rounds_stuck -= 2;
-  if (rounds_stuck % 2 == 1)
-    return rotate_clockwise(current_direction, --rotations_clockwise);
+direction_t execute_detour_strategy(struct attacker_state* s) {
+  s->rounds_stuck -= 2;
+  if (s->rounds_stuck % 2 == 1)
+    return rotate_clockwise(s->current_direction, --s->rotations_clockwise);
   else
-    return rotate_counterclockwise(current_direction,
-                                        --rotations_counterclockwise);
+    return rotate_counterclockwise(s->current_direction,
+                                   --s->rotations_counterclockwise);
 }
 
-void reset_stuck_data() {
-  rounds_stuck = 0;
-  rotations_clockwise = 0;
-  rotations_counterclockwise = 0;
+void reset_stuck_data(struct attacker_state* s) {
+  s->rounds_stuck = 0;
+  s->rotations_clockwise = 0;
+  s->rotations_counterclockwise = 0;
 }
 
 /*----------------------------------------------------------------------------*/
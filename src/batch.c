@@ -0,0 +1,825 @@
+// Standard headers
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Internal headers
+#include "bot.h"
+#include "cycle.h"
+#include "game.h"
+#include "item.h"
+#include "map.h"
+#include "rng.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Main header
+#include "batch.h"
+
+// Macros
+#define VECTOR_ALIGNMENT 32
+#define VECTOR_LANES 8 // 32-bit lanes of an AVX2 register
+
+// Lanes are split in groups, so a bot decides for a group while
+// the engine moves the players of another one
+#define BATCH_GROUPS 2
+#define GROUP_LANES (BATCH_LANES / BATCH_GROUPS)
+
+_Static_assert(GROUP_LANES % VECTOR_LANES == 0,
+               "Groups of lanes must fill whole vectors");
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * Lanes hold the state of every game of a batch, one array per field.
+ * Masks are -1 for the lanes they select and 0 for the others.
+ */
+struct lanes {
+  alignas(VECTOR_ALIGNMENT) int32_t attacker_i[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t attacker_j[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t defender_i[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t defender_j[BATCH_LANES];
+
+  alignas(VECTOR_ALIGNMENT) int32_t attacker_di[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t attacker_dj[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t defender_di[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t defender_dj[BATCH_LANES];
+
+  alignas(VECTOR_ALIGNMENT) int32_t attacker_spy_uses[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t defender_spy_uses[BATCH_LANES];
+
+  alignas(VECTOR_ALIGNMENT) int32_t live[BATCH_LANES]; // Unfinished games
+
+  // Simultaneous moves without conflicts, and who moves first
+  alignas(VECTOR_ALIGNMENT) int32_t moving[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t attacker_first[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t defender_first[BATCH_LANES];
+
+  alignas(VECTOR_ALIGNMENT) int32_t end_reasons[BATCH_LANES];
+  alignas(VECTOR_ALIGNMENT) int32_t number_turns[BATCH_LANES];
+};
+
+enum batch_player { BATCH_ATTACKER, BATCH_DEFENDER, NUMBER_BATCH_PLAYERS };
+
+/**
+ * A player view gathers the lanes and objects of one of the players
+ * of all games, so both players are handled by the same code.
+ */
+struct player_view {
+  int32_t* lines;
+  int32_t* columns;
+  int32_t* line_steps;
+  int32_t* column_steps;
+  int32_t* spy_uses;
+
+  const int32_t* opponent_lines;
+  const int32_t* opponent_columns;
+
+  PlayerStrategy strategy;
+  StrategyContext* contexts;
+  Item* opponents; // Read by the spies, updated before every decision
+  Spy* spies; // Used by this player
+
+  Bot bot; // If given, it decides instead of the strategy...
+  size_t pending[BATCH_GROUPS]; // ...with these requests in flight
+};
+
+struct batch {
+  struct lanes lanes;
+  struct player_view players[NUMBER_BATCH_PLAYERS];
+
+  int32_t height;
+  int32_t width;
+  int32_t* obstacles; // Not 0 on obstacles, by line
+  bool* layout; // The same, as the strategies take them
+  position_t attacker_start;
+  position_t defender_start;
+
+  int32_t max_number_spies;
+  bool simultaneous_moves;
+
+  StrategyContext attacker_contexts[BATCH_LANES];
+  StrategyContext defender_contexts[BATCH_LANES];
+
+  Item attackers[BATCH_LANES];
+  Item defenders[BATCH_LANES];
+  Spy attacker_spies[BATCH_LANES]; // Used by the defender
+  Spy defender_spies[BATCH_LANES]; // Used by the attacker
+
+  CycleDetector cycle_detectors[BATCH_LANES];
+  bool is_detecting_cycles[BATCH_LANES];
+
+  bool has_bot_failed;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void start_lanes(Batch batch, const uint64_t* seeds, size_t number_games);
+static bool has_live_lanes(const struct lanes* lanes);
+
+static void play_batch_turn(Batch batch);
+static void request_decisions(Batch batch,
+                              struct player_view* player,
+                              size_t group);
+static void await_decisions(Batch batch,
+                            struct player_view* player,
+                            size_t group);
+static void count_spy_uses(struct player_view* player);
+static void order_simultaneous_moves(struct lanes* lanes);
+
+static void move_lanes(const Batch batch,
+                       struct player_view* player,
+                       const int32_t* active,
+                       size_t first_lane,
+                       size_t end_lane);
+static void check_lane_outcomes(const Batch batch);
+
+static void start_cycle_detection(Batch batch, size_t number_games);
+static void check_lane_cycles(Batch batch);
+static uint64_t hash_lane_board(const Batch batch, size_t lane);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// The layout comes from a regular game, so batches accept exactly
+// the maps and dimensions that games accept
+Batch new_batch(Map map,
+                dimension_t field_dimension,
+                size_t max_number_spies,
+                bool simultaneous_moves,
+                PlayerStrategy attacker_strategy,
+                PlayerStrategy defender_strategy) {
+  Game game = map != NULL
+    ? new_game_from_map(map, max_number_spies,
+                        attacker_strategy, defender_strategy)
+    : new_game(field_dimension, max_number_spies,
+               attacker_strategy, defender_strategy);
+
+  if (game == NULL) return NULL;
+
+  size_t size = (sizeof(struct batch) + VECTOR_ALIGNMENT - 1)
+              / VECTOR_ALIGNMENT * VECTOR_ALIGNMENT;
+  Batch batch = aligned_alloc(VECTOR_ALIGNMENT, size);
+  memset(&batch->lanes, 0, sizeof(batch->lanes));
+
+  dimension_t dimension = get_game_dimension(game);
+  batch->height = dimension.height;
+  batch->width = dimension.width;
+  batch->obstacles = malloc(dimension.height * dimension.width
+                            * sizeof(*batch->obstacles));
+  batch->layout = malloc(dimension.height * dimension.width
+                         * sizeof(*batch->layout));
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
+      batch->layout[i * dimension.width + j]
+        = is_game_obstacle(game, position);
+      batch->obstacles[i * dimension.width + j]
+        = batch->layout[i * dimension.width + j];
+    }
+  }
+
+  batch->attacker_start = get_game_attacker_position(game);
+  batch->defender_start = get_game_defender_position(game);
+
+  delete_game(game);
+
+  batch->max_number_spies
+    = max_number_spies < INT32_MAX ? max_number_spies : INT32_MAX;
+  batch->simultaneous_moves = simultaneous_moves;
+
+  struct lanes* lanes = &batch->lanes;
+
+  batch->players[BATCH_ATTACKER] = (struct player_view) {
+    lanes->attacker_i, lanes->attacker_j,
+    lanes->attacker_di, lanes->attacker_dj, lanes->attacker_spy_uses,
+    lanes->defender_i, lanes->defender_j,
+    attacker_strategy, batch->attacker_contexts,
+    batch->defenders, batch->defender_spies,
+    NULL, { 0 }
+  };
+
+  batch->players[BATCH_DEFENDER] = (struct player_view) {
+    lanes->defender_i, lanes->defender_j,
+    lanes->defender_di, lanes->defender_dj, lanes->defender_spy_uses,
+    lanes->attacker_i, lanes->attacker_j,
+    defender_strategy, batch->defender_contexts,
+    batch->attackers, batch->attacker_spies,
+    NULL, { 0 }
+  };
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    batch->attacker_contexts[l] = new_strategy_context(seed_rng(0));
+    batch->defender_contexts[l] = new_strategy_context(seed_rng(0));
+    set_strategy_layout(batch->attacker_contexts[l], dimension, batch->layout);
+    set_strategy_layout(batch->defender_contexts[l], dimension, batch->layout);
+
+    batch->attackers[l] = new_item('A', true);
+    batch->defenders[l] = new_item('D', true);
+    batch->attacker_spies[l] = new_spy(batch->attackers[l]);
+    batch->defender_spies[l] = new_spy(batch->defenders[l]);
+
+    batch->cycle_detectors[l] = new_cycle_detector();
+  }
+
+  return batch;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_batch(Batch batch) {
+  if (batch == NULL) return;
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    delete_cycle_detector(batch->cycle_detectors[l]);
+    delete_spy(batch->defender_spies[l]);
+    delete_spy(batch->attacker_spies[l]);
+    delete_item(batch->defenders[l]);
+    delete_item(batch->attackers[l]);
+    delete_strategy_context(batch->defender_contexts[l]);
+    delete_strategy_context(batch->attacker_contexts[l]);
+  }
+
+  free(batch->layout);
+  batch->layout = NULL;
+
+  free(batch->obstacles);
+  batch->obstacles = NULL;
+
+  free(batch);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Same as set_game_strategy_parameters, for every lane
+void set_batch_strategy_parameters(Batch batch,
+                                   const double* attacker_parameters,
+                                   const double* defender_parameters) {
+  if (batch == NULL) return;
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    set_strategy_parameters(batch->attacker_contexts[l], attacker_parameters);
+    set_strategy_parameters(batch->defender_contexts[l], defender_parameters);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Bots replace the strategies of their players, if given. Fails if
+// positions of the field do not fit in the messages of bots.
+bool set_batch_bots(Batch batch, Bot attacker_bot, Bot defender_bot) {
+  if (batch == NULL) return false;
+
+  if (batch->height > BOT_MAX_COORDINATE + 1
+      || batch->width > BOT_MAX_COORDINATE + 1) {
+    fprintf(stderr, "ERROR: Field is too large for bots\n");
+    return false;
+  }
+
+  batch->players[BATCH_ATTACKER].bot = attacker_bot;
+  batch->players[BATCH_DEFENDER].bot = defender_bot;
+
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Plays one game per seed, at most BATCH_LANES of them.
+// Finished games are masked out until all of them are over.
+// Fails if a bot stops answering, leaving the results undefined.
+bool run_batch(Batch batch,
+               const uint64_t* seeds,
+               size_t number_games,
+               size_t max_turns,
+               game_result_t* results) {
+  if (batch == NULL) return false;
+  if (number_games > BATCH_LANES) number_games = BATCH_LANES;
+
+  struct lanes* lanes = &batch->lanes;
+  start_lanes(batch, seeds, number_games);
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    set_strategy_limits(batch->attacker_contexts[l], max_turns,
+                        batch->max_number_spies);
+    set_strategy_limits(batch->defender_contexts[l], max_turns,
+                        batch->max_number_spies);
+  }
+
+  for (size_t turn = 0;
+       has_live_lanes(lanes) && !batch->has_bot_failed; turn++) {
+    if (turn == max_turns) {
+      for (size_t l = 0; l < BATCH_LANES; l++) {
+        if (lanes->live[l]) lanes->end_reasons[l] = MAX_TURNS_REACHED;
+      }
+      break;
+    }
+
+    play_batch_turn(batch);
+    check_lane_outcomes(batch);
+    check_lane_cycles(batch);
+  }
+
+  for (size_t l = 0; l < number_games; l++) {
+    enum game_end_reason end_reason = lanes->end_reasons[l];
+
+    results[l] = (game_result_t) {
+      .end_reason = end_reason,
+      .winner = winner_of_end_reason(end_reason),
+      .number_turns = lanes->number_turns[l],
+      .attacker_spy_uses = get_spy_number_uses(batch->defender_spies[l]),
+      .defender_spy_uses = get_spy_number_uses(batch->attacker_spies[l]),
+    };
+  }
+
+  return !batch->has_bot_failed;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Seeds every lane as set_game_seed does, and leaves unused lanes dead
+void start_lanes(Batch batch, const uint64_t* seeds, size_t number_games) {
+  struct lanes* lanes = &batch->lanes;
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    lanes->attacker_i[l] = batch->attacker_start.i;
+    lanes->attacker_j[l] = batch->attacker_start.j;
+    lanes->defender_i[l] = batch->defender_start.i;
+    lanes->defender_j[l] = batch->defender_start.j;
+
+    lanes->attacker_spy_uses[l] = 0;
+    lanes->defender_spy_uses[l] = 0;
+
+    lanes->live[l] = l < number_games ? -1 : 0;
+    lanes->end_reasons[l] = GAME_CONTINUES;
+    lanes->number_turns[l] = 0;
+
+    if (l >= number_games) continue;
+
+    reset_strategy_context(batch->attacker_contexts[l],
+                           seed_attacker_rng(seeds[l]));
+    reset_strategy_context(batch->defender_contexts[l],
+                           seed_defender_rng(seeds[l]));
+
+    reset_spy(batch->attacker_spies[l]);
+    reset_spy(batch->defender_spies[l]);
+  }
+
+  // Bots keep one context per lane too
+  uint32_t games[BATCH_LANES];
+  for (size_t l = 0; l < number_games; l++) games[l] = l;
+
+  batch->has_bot_failed = false;
+  for (size_t p = 0; p < NUMBER_BATCH_PLAYERS; p++) {
+    Bot bot = batch->players[p].bot;
+    if (bot != NULL && !start_bot_games(bot, games, seeds, number_games)) {
+      batch->has_bot_failed = true;
+    }
+  }
+
+  start_cycle_detection(batch, number_games);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool has_live_lanes(const struct lanes* lanes) {
+  int32_t live = 0;
+  for (size_t l = 0; l < BATCH_LANES; l++) live |= lanes->live[l];
+  return live != 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Same order as play_turn: in sequential moves, the defender decides
+// after the attacker has moved. Each group of lanes moves as soon as
+// its decisions are in, while bots decide for the next groups.
+void play_batch_turn(Batch batch) {
+  struct lanes* l = &batch->lanes;
+  struct player_view* attacker = &batch->players[BATCH_ATTACKER];
+  struct player_view* defender = &batch->players[BATCH_DEFENDER];
+
+  if (!batch->simultaneous_moves) {
+    for (size_t g = 0; g < BATCH_GROUPS; g++) {
+      request_decisions(batch, attacker, g);
+    }
+
+    for (size_t g = 0; g < BATCH_GROUPS; g++) {
+      await_decisions(batch, attacker, g);
+      move_lanes(batch, attacker, l->live,
+                 g * GROUP_LANES, (g + 1) * GROUP_LANES);
+      request_decisions(batch, defender, g);
+    }
+
+    for (size_t g = 0; g < BATCH_GROUPS; g++) {
+      await_decisions(batch, defender, g);
+      move_lanes(batch, defender, l->live,
+                 g * GROUP_LANES, (g + 1) * GROUP_LANES);
+    }
+  }
+  else {
+    for (size_t g = 0; g < BATCH_GROUPS; g++) {
+      request_decisions(batch, attacker, g);
+      request_decisions(batch, defender, g);
+    }
+
+    for (size_t g = 0; g < BATCH_GROUPS; g++) {
+      await_decisions(batch, attacker, g);
+      await_decisions(batch, defender, g);
+    }
+
+    order_simultaneous_moves(l);
+
+    // Either the attacker or the defender moves first in each lane
+    move_lanes(batch, attacker, l->attacker_first, 0, BATCH_LANES);
+    move_lanes(batch, defender, l->moving, 0, BATCH_LANES);
+    move_lanes(batch, attacker, l->defender_first, 0, BATCH_LANES);
+  }
+
+  count_spy_uses(attacker);
+  count_spy_uses(defender);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Strategies decide right away, and bots get a single message
+// with all the live lanes of the group
+void request_decisions(Batch batch,
+                       struct player_view* player,
+                       size_t group) {
+  const int32_t* live = batch->lanes.live;
+  size_t first = group * GROUP_LANES;
+  size_t end = first + GROUP_LANES;
+
+  if (player->bot == NULL) {
+    for (size_t l = first; l < end; l++) {
+      if (!live[l]) continue;
+
+      position_t opponent = {
+        player->opponent_lines[l], player->opponent_columns[l]
+      };
+      set_item_position(player->opponents[l], opponent);
+
+      position_t position = { player->lines[l], player->columns[l] };
+      direction_t direction = player->strategy(
+          position, player->spies[l], player->contexts[l]);
+
+      player->line_steps[l] = direction.i;
+      player->column_steps[l] = direction.j;
+    }
+    return;
+  }
+
+  bot_request_t requests[GROUP_LANES];
+  size_t number_requests = 0;
+
+  for (size_t l = first; l < end; l++) {
+    if (!live[l]) continue;
+
+    requests[number_requests++] = (bot_request_t) {
+      .game = l,
+      .position = { player->lines[l], player->columns[l] },
+      .opponent_position = {
+        player->opponent_lines[l], player->opponent_columns[l]
+      },
+    };
+  }
+
+  player->pending[group] = number_requests;
+  if (number_requests > 0
+      && !send_bot_requests(player->bot, requests, number_requests)) {
+    batch->has_bot_failed = true;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Spy uses reported by bots are counted by the spies of the lanes,
+// as if the bots had used them
+void await_decisions(Batch batch,
+                     struct player_view* player,
+                     size_t group) {
+  size_t number_decisions = player->pending[group];
+  if (player->bot == NULL || number_decisions == 0) return;
+
+  player->pending[group] = 0;
+
+  bot_decision_t decisions[GROUP_LANES];
+  if (!receive_bot_decisions(player->bot, decisions, number_decisions)) {
+    memset(decisions, 0, sizeof(decisions));
+    batch->has_bot_failed = true;
+  }
+
+  const int32_t* live = batch->lanes.live;
+  size_t first = group * GROUP_LANES;
+  size_t end = first + GROUP_LANES;
+  size_t d = 0;
+
+  for (size_t l = first; l < end; l++) {
+    if (!live[l]) continue;
+
+    player->line_steps[l] = decisions[d].direction.i;
+    player->column_steps[l] = decisions[d].direction.j;
+
+    for (size_t u = 0; u < decisions[d].spy_uses; u++) {
+      get_spy_position(player->spies[l]);
+    }
+
+    d++;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void count_spy_uses(struct player_view* player) {
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    size_t uses = get_spy_number_uses(player->spies[l]);
+    player->spy_uses[l] = uses < INT32_MAX ? uses : INT32_MAX;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Same conflicts as move_items_simultaneously: nobody moves if both
+// target the same cell or swap cells, and the defender moves first
+// if the attacker follows it
+void order_simultaneous_moves(struct lanes* l) {
+  for (size_t k = 0; k < BATCH_LANES; k++) {
+    int32_t attacker_i = l->attacker_i[k] + l->attacker_di[k];
+    int32_t attacker_j = l->attacker_j[k] + l->attacker_dj[k];
+    int32_t defender_i = l->defender_i[k] + l->defender_di[k];
+    int32_t defender_j = l->defender_j[k] + l->defender_dj[k];
+
+    int32_t same_cell = attacker_i == defender_i && attacker_j == defender_j;
+    int32_t follows = attacker_i == l->defender_i[k]
+                      && attacker_j == l->defender_j[k];
+    int32_t swaps = follows && defender_i == l->attacker_i[k]
+                    && defender_j == l->attacker_j[k];
+
+    l->moving[k] = l->live[k] & -(!same_cell && !swaps);
+    l->attacker_first[k] = l->moving[k] & -!follows;
+    l->defender_first[k] = l->moving[k] & -follows;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Same rule as move_item_in_field: a player only moves to a cell
+// of the field without obstacles nor the other player
+#ifdef __AVX2__
+void move_lanes(const Batch batch,
+                struct player_view* player,
+                const int32_t* active,
+                size_t first_lane,
+                size_t end_lane) {
+  int32_t* lines = player->lines;
+  int32_t* columns = player->columns;
+  const int32_t* line_steps = player->line_steps;
+  const int32_t* column_steps = player->column_steps;
+  const int32_t* other_lines = player->opponent_lines;
+  const int32_t* other_columns = player->opponent_columns;
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i minus_one = _mm256_set1_epi32(-1);
+  const __m256i height = _mm256_set1_epi32(batch->height);
+  const __m256i width = _mm256_set1_epi32(batch->width);
+
+  for (size_t l = first_lane; l < end_lane; l += VECTOR_LANES) {
+    __m256i i = _mm256_load_si256((const __m256i*) &lines[l]);
+    __m256i j = _mm256_load_si256((const __m256i*) &columns[l]);
+    __m256i target_i = _mm256_add_epi32(
+        i, _mm256_load_si256((const __m256i*) &line_steps[l]));
+    __m256i target_j = _mm256_add_epi32(
+        j, _mm256_load_si256((const __m256i*) &column_steps[l]));
+
+    __m256i inside = _mm256_and_si256(
+        _mm256_and_si256(_mm256_cmpgt_epi32(target_i, minus_one),
+                         _mm256_cmpgt_epi32(height, target_i)),
+        _mm256_and_si256(_mm256_cmpgt_epi32(target_j, minus_one),
+                         _mm256_cmpgt_epi32(width, target_j)));
+
+    __m256i cell = _mm256_add_epi32(_mm256_mullo_epi32(target_i, width),
+                                    target_j);
+    __m256i obstacle = _mm256_mask_i32gather_epi32(
+        zero, (const int*) batch->obstacles, cell, inside, sizeof(int32_t));
+
+    __m256i other = _mm256_and_si256(
+        _mm256_cmpeq_epi32(
+            target_i, _mm256_load_si256((const __m256i*) &other_lines[l])),
+        _mm256_cmpeq_epi32(
+            target_j, _mm256_load_si256((const __m256i*) &other_columns[l])));
+
+    __m256i moves = _mm256_andnot_si256(
+        _mm256_or_si256(other, _mm256_xor_si256(
+            _mm256_cmpeq_epi32(obstacle, zero), minus_one)),
+        _mm256_and_si256(inside,
+                         _mm256_load_si256((const __m256i*) &active[l])));
+
+    _mm256_store_si256((__m256i*) &lines[l],
+                       _mm256_blendv_epi8(i, target_i, moves));
+    _mm256_store_si256((__m256i*) &columns[l],
+                       _mm256_blendv_epi8(j, target_j, moves));
+  }
+}
+#else
+void move_lanes(const Batch batch,
+                struct player_view* player,
+                const int32_t* active,
+                size_t first_lane,
+                size_t end_lane) {
+  int32_t* lines = player->lines;
+  int32_t* columns = player->columns;
+  const int32_t* line_steps = player->line_steps;
+  const int32_t* column_steps = player->column_steps;
+  const int32_t* other_lines = player->opponent_lines;
+  const int32_t* other_columns = player->opponent_columns;
+
+  for (size_t l = first_lane; l < end_lane; l++) {
+    int32_t target_i = lines[l] + line_steps[l];
+    int32_t target_j = columns[l] + column_steps[l];
+
+    bool inside = target_i >= 0 && target_i < batch->height
+                  && target_j >= 0 && target_j < batch->width;
+    bool moves = active[l] && inside
+                 && !batch->obstacles[target_i * batch->width + target_j]
+                 && !(target_i == other_lines[l]
+                      && target_j == other_columns[l]);
+
+    if (moves) {
+      lines[l] = target_i;
+      columns[l] = target_j;
+    }
+  }
+}
+#endif
+
+/*----------------------------------------------------------------------------*/
+
+// Same checks as check_turn_outcome, in the same order. The capture
+// check mirrors neighbor_positions exactly, which compares columns
+// against the line of the attacker, with unsigned arithmetic.
+#ifdef __AVX2__
+void check_lane_outcomes(const Batch batch) {
+  struct lanes* lanes = &batch->lanes;
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i max_spies = _mm256_set1_epi32(batch->max_number_spies);
+  const __m256i end_column = _mm256_set1_epi32(batch->width - 2);
+
+  for (size_t l = 0; l < BATCH_LANES; l += VECTOR_LANES) {
+    __m256i live = _mm256_load_si256((const __m256i*) &lanes->live[l]);
+    __m256i ai = _mm256_load_si256((const __m256i*) &lanes->attacker_i[l]);
+    __m256i aj = _mm256_load_si256((const __m256i*) &lanes->attacker_j[l]);
+    __m256i di = _mm256_load_si256((const __m256i*) &lanes->defender_i[l]);
+    __m256i dj = _mm256_load_si256((const __m256i*) &lanes->defender_j[l]);
+
+    __m256i low_i = _mm256_sub_epi32(ai, one);
+    __m256i high_i = _mm256_add_epi32(ai, one);
+    __m256i high_j = _mm256_add_epi32(aj, one);
+
+    // Unsigned x >= y is max(x, y) == x, and x <= y is min(x, y) == x
+    __m256i captured = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_cmpeq_epi32(_mm256_max_epu32(di, low_i), di),
+            _mm256_cmpeq_epi32(_mm256_min_epu32(di, high_i), di)),
+        _mm256_and_si256(
+            _mm256_cmpeq_epi32(_mm256_max_epu32(dj, low_i), dj),
+            _mm256_cmpeq_epi32(_mm256_min_epu32(dj, high_j), dj)));
+    __m256i arrived = _mm256_cmpeq_epi32(aj, end_column);
+    __m256i defender_cheated = _mm256_cmpgt_epi32(
+        _mm256_load_si256((const __m256i*) &lanes->defender_spy_uses[l]),
+        max_spies);
+    __m256i attacker_cheated = _mm256_cmpgt_epi32(
+        _mm256_load_si256((const __m256i*) &lanes->attacker_spy_uses[l]),
+        max_spies);
+
+    // From the last check to the first one, so the first one wins
+    __m256i reason = _mm256_and_si256(
+        captured, _mm256_set1_epi32(DEFENDER_CAPTURED_ATTACKER));
+    reason = _mm256_blendv_epi8(
+        reason, _mm256_set1_epi32(ATTACKER_ARRIVED_END_FIELD), arrived);
+    reason = _mm256_blendv_epi8(
+        reason, _mm256_set1_epi32(DEFENDER_CHEATED), defender_cheated);
+    reason = _mm256_blendv_epi8(
+        reason, _mm256_set1_epi32(ATTACKER_CHEATED), attacker_cheated);
+
+    __m256i over = _mm256_andnot_si256(_mm256_cmpeq_epi32(reason, zero), live);
+
+    // Live lanes are -1, so subtracting them counts their turn
+    __m256i* turns = (__m256i*) &lanes->number_turns[l];
+    _mm256_store_si256(turns, _mm256_sub_epi32(_mm256_load_si256(turns), live));
+
+    __m256i* reasons = (__m256i*) &lanes->end_reasons[l];
+    _mm256_store_si256(reasons, _mm256_blendv_epi8(
+        _mm256_load_si256(reasons), reason, over));
+
+    _mm256_store_si256((__m256i*) &lanes->live[l],
+                       _mm256_andnot_si256(over, live));
+  }
+}
+#else
+void check_lane_outcomes(const Batch batch) {
+  struct lanes* lanes = &batch->lanes;
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    if (!lanes->live[l]) continue;
+
+    uint32_t ai = lanes->attacker_i[l], aj = lanes->attacker_j[l];
+    uint32_t di = lanes->defender_i[l], dj = lanes->defender_j[l];
+
+    enum game_end_reason reason = GAME_CONTINUES;
+    if (lanes->attacker_spy_uses[l] > batch->max_number_spies)
+      reason = ATTACKER_CHEATED;
+    else if (lanes->defender_spy_uses[l] > batch->max_number_spies)
+      reason = DEFENDER_CHEATED;
+    else if (aj == (uint32_t) batch->width - 2)
+      reason = ATTACKER_ARRIVED_END_FIELD;
+    else if (di >= ai - 1 && di <= ai + 1 && dj >= ai - 1 && dj <= aj + 1)
+      reason = DEFENDER_CAPTURED_ATTACKER;
+
+    lanes->number_turns[l]++;
+
+    if (reason != GAME_CONTINUES) {
+      lanes->end_reasons[l] = reason;
+      lanes->live[l] = 0;
+    }
+  }
+}
+#endif
+
+/*----------------------------------------------------------------------------*/
+
+// Same detection as run_game, lane by lane. Bots keep their state out
+// of the contexts, so games with bots are never taken for cycles.
+void start_cycle_detection(Batch batch, size_t number_games) {
+  bool has_bots = batch->players[BATCH_ATTACKER].bot != NULL
+                  || batch->players[BATCH_DEFENDER].bot != NULL;
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    batch->is_detecting_cycles[l] = !has_bots && l < number_games;
+    if (!batch->is_detecting_cycles[l]) continue;
+
+    CycleDetector detector = batch->cycle_detectors[l];
+    reset_cycle_detector(detector);
+    may_repeat_cycle_board(detector, hash_lane_board(batch, l));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// After check_lane_outcomes, so only lanes that would continue are
+// checked, and their turn is already counted
+void check_lane_cycles(Batch batch) {
+  struct lanes* lanes = &batch->lanes;
+
+  for (size_t l = 0; l < BATCH_LANES; l++) {
+    if (!lanes->live[l] || !batch->is_detecting_cycles[l]) continue;
+
+    CycleDetector detector = batch->cycle_detectors[l];
+    uint64_t board_hash = hash_lane_board(batch, l);
+    if (!may_repeat_cycle_board(detector, board_hash)) continue;
+
+    uint64_t state_hash = hash_game_state(board_hash,
+                                          batch->attacker_contexts[l],
+                                          batch->defender_contexts[l]);
+
+    if (state_hash == NO_STATE_HASH) {
+      batch->is_detecting_cycles[l] = false;
+    }
+    else if (repeats_cycle_state(detector, state_hash)) {
+      lanes->end_reasons[l] = CYCLE_DETECTED;
+      lanes->live[l] = 0;
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t hash_lane_board(const Batch batch, size_t lane) {
+  const struct lanes* lanes = &batch->lanes;
+
+  position_t attacker = { lanes->attacker_i[lane], lanes->attacker_j[lane] };
+  position_t defender = { lanes->defender_i[lane], lanes->defender_j[lane] };
+
+  return hash_game_board(attacker,
+                         defender,
+                         lanes->attacker_spy_uses[lane],
+                         lanes->defender_spy_uses[lane]);
+}
+
+/*----------------------------------------------------------------------------*/
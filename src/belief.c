@@ -0,0 +1,327 @@
+// Standard headers
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include "dimension.h"
+#include "position.h"
+
+// Main header
+#include "belief.h"
+
+// Macros
+#define VECTOR_ALIGNMENT 32
+#define VECTOR_FLOATS (VECTOR_ALIGNMENT / sizeof(float))
+#define NUMBER_MOVES 9 // 8 directions, or staying
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+// Grids have a border of one zero cell all around, so the spread never
+// checks bounds, and rows padded to whole vectors
+struct belief {
+  dimension_t dimension;
+  size_t stride;
+
+  float* probabilities; // Current turn...
+  float* next; // ...and the previous one, overwritten by the next spread
+
+  float* free_weights; // 1/9 on free cells, 0 on obstacles and borders
+  float* stay_weights; // (1 + blocked neighbors) / 9 on free cells
+
+  // Frontier, in grid coordinates. Both grids are zero outside of it,
+  // as it only grows between collapses. Empty when first_i > last_i
+  size_t first_i, last_i;
+  size_t first_j, last_j;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static float* new_grid(size_t number_floats);
+static void spread_row(float* restrict next,
+                       const float* restrict up,
+                       const float* restrict middle,
+                       const float* restrict down,
+                       const float* restrict free_weights,
+                       const float* restrict stay_weights,
+                       size_t first_j,
+                       size_t last_j);
+static double get_total_probability(Belief belief);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Belief new_belief(dimension_t dimension, const bool* obstacles) {
+  if (dimension.height == 0 || dimension.width == 0) return NULL;
+
+  Belief belief = malloc(sizeof(*belief));
+
+  belief->dimension = dimension;
+  belief->stride = (dimension.width + 2 + VECTOR_FLOATS - 1)
+                 / VECTOR_FLOATS * VECTOR_FLOATS;
+
+  size_t number_floats = (dimension.height + 2) * belief->stride;
+  belief->probabilities = new_grid(number_floats);
+  belief->next = new_grid(number_floats);
+  belief->free_weights = new_grid(number_floats);
+  belief->stay_weights = new_grid(number_floats);
+
+  for (size_t i = 1; i <= dimension.height; i++) {
+    for (size_t j = 1; j <= dimension.width; j++) {
+      if (obstacles != NULL
+          && obstacles[(i - 1) * dimension.width + (j - 1)]) continue;
+
+      belief->free_weights[i * belief->stride + j] = 1.0f / NUMBER_MOVES;
+    }
+  }
+
+  // Moves into a blocked neighbor leave the opponent where it was
+  for (size_t i = 1; i <= dimension.height; i++) {
+    for (size_t j = 1; j <= dimension.width; j++) {
+      if (belief->free_weights[i * belief->stride + j] == 0) continue;
+
+      size_t number_blocked = 0;
+      for (size_t ni = i - 1; ni <= i + 1; ni++) {
+        for (size_t nj = j - 1; nj <= j + 1; nj++) {
+          number_blocked += belief->free_weights[ni * belief->stride + nj] == 0;
+        }
+      }
+
+      belief->stay_weights[i * belief->stride + j]
+        = (1.0f + number_blocked) / NUMBER_MOVES;
+    }
+  }
+
+  belief->first_i = 1;
+  belief->last_i = 0;
+  belief->first_j = 1;
+  belief->last_j = 0;
+
+  return belief;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_belief(Belief belief) {
+  if (belief == NULL) return;
+
+  free(belief->stay_weights - VECTOR_FLOATS);
+  free(belief->free_weights - VECTOR_FLOATS);
+  free(belief->next - VECTOR_FLOATS);
+  free(belief->probabilities - VECTOR_FLOATS);
+
+  free(belief);
+}
+
+/*----------------------------------------------------------------------------*/
+
+dimension_t get_belief_dimension(Belief belief) {
+  if (belief == NULL) return (dimension_t) NULL_DIMENSION;
+  return belief->dimension;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Positions out of the grid or on obstacles only clear the belief
+void collapse_belief(Belief belief, position_t position) {
+  if (belief == NULL) return;
+
+  for (size_t i = belief->first_i; i <= belief->last_i; i++) {
+    size_t row = i * belief->stride + belief->first_j;
+    size_t length = (belief->last_j - belief->first_j + 1) * sizeof(float);
+    memset(belief->probabilities + row, 0, length);
+    memset(belief->next + row, 0, length);
+  }
+
+  belief->first_i = 1;
+  belief->last_i = 0;
+  belief->first_j = 1;
+  belief->last_j = 0;
+
+  if (position.i >= belief->dimension.height
+      || position.j >= belief->dimension.width) return;
+
+  size_t i = position.i + 1;
+  size_t j = position.j + 1;
+  if (belief->free_weights[i * belief->stride + j] == 0) return;
+
+  belief->probabilities[i * belief->stride + j] = 1;
+  belief->first_i = belief->last_i = i;
+  belief->first_j = belief->last_j = j;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void spread_belief(Belief belief) {
+  if (belief == NULL || belief->first_i > belief->last_i) return;
+
+  // The opponent is at most one cell beyond the previous frontier
+  if (belief->first_i > 1) belief->first_i--;
+  if (belief->first_j > 1) belief->first_j--;
+  if (belief->last_i < belief->dimension.height) belief->last_i++;
+  if (belief->last_j < belief->dimension.width) belief->last_j++;
+
+  size_t stride = belief->stride;
+  const float* probabilities = belief->probabilities;
+
+  for (size_t i = belief->first_i; i <= belief->last_i; i++) {
+    spread_row(belief->next + i * stride,
+               probabilities + (i - 1) * stride,
+               probabilities + i * stride,
+               probabilities + (i + 1) * stride,
+               belief->free_weights + i * stride,
+               belief->stay_weights + i * stride,
+               belief->first_j,
+               belief->last_j);
+  }
+
+  float* swap = belief->probabilities;
+  belief->probabilities = belief->next;
+  belief->next = swap;
+}
+
+/*----------------------------------------------------------------------------*/
+
+double get_belief_probability(Belief belief, position_t position) {
+  if (belief == NULL
+      || position.i >= belief->dimension.height
+      || position.j >= belief->dimension.width) return 0;
+
+  double total = get_total_probability(belief);
+  if (total == 0) return 0;
+
+  size_t cell = (position.i + 1) * belief->stride + (position.j + 1);
+  return belief->probabilities[cell] / total;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Rounds the mean line and column of the opponent
+position_t get_belief_expected_position(Belief belief) {
+  if (belief == NULL) return (position_t) INVALID_POSITION;
+
+  double total = 0, sum_i = 0, sum_j = 0;
+  for (size_t i = belief->first_i; i <= belief->last_i; i++) {
+    const float* row = belief->probabilities + i * belief->stride;
+    for (size_t j = belief->first_j; j <= belief->last_j; j++) {
+      total += row[j];
+      sum_i += row[j] * (double) i;
+      sum_j += row[j] * (double) j;
+    }
+  }
+
+  if (total == 0) return (position_t) INVALID_POSITION;
+
+  position_t expected = {
+    lround(sum_i / total) - 1, lround(sum_j / total) - 1
+  };
+  return expected;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void get_belief_frontier(Belief belief, position_t* first, position_t* last) {
+  if (first == NULL || last == NULL) return;
+
+  if (belief == NULL || belief->first_i > belief->last_i) {
+    *first = (position_t) INVALID_POSITION;
+    *last = (position_t) INVALID_POSITION;
+    return;
+  }
+
+  *first = (position_t) { belief->first_i - 1, belief->first_j - 1 };
+  *last = (position_t) { belief->last_i - 1, belief->last_j - 1 };
+}
+
+/*----------------------------------------------------------------------------*/
+
+// H = log2(T) - sum(p log2 p) / T, for unnormalized p summing to T
+double get_belief_entropy(Belief belief) {
+  if (belief == NULL) return 0;
+
+  double total = 0, sum = 0;
+  for (size_t i = belief->first_i; i <= belief->last_i; i++) {
+    const float* row = belief->probabilities + i * belief->stride;
+    for (size_t j = belief->first_j; j <= belief->last_j; j++) {
+      if (row[j] <= 0) continue;
+
+      total += row[j];
+      sum += row[j] * log2(row[j]);
+    }
+  }
+
+  if (total == 0) return 0;
+  return log2(total) - sum / total;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_spy_advised(Belief belief, double min_bits) {
+  if (belief == NULL) return false;
+
+  // An empty belief knows nothing, so any spy is worth it
+  if (belief->first_i > belief->last_i) return true;
+
+  return get_belief_entropy(belief) >= min_bits;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// With one vector to spare before and after the grid, read by the
+// spread of its first and last cells
+float* new_grid(size_t number_floats) {
+  size_t size = (number_floats + 2 * VECTOR_FLOATS) * sizeof(float);
+  float* grid = aligned_alloc(VECTOR_ALIGNMENT, size);
+  memset(grid, 0, size);
+  return grid + VECTOR_FLOATS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Whole vectors at a time, without branches nor aliasing, so compilers
+// vectorize it. Cells beyond the frontier are zero, as are their weights
+void spread_row(float* restrict next,
+                const float* restrict up,
+                const float* restrict middle,
+                const float* restrict down,
+                const float* restrict free_weights,
+                const float* restrict stay_weights,
+                size_t first_j,
+                size_t last_j) {
+  first_j -= first_j % VECTOR_FLOATS;
+
+  for (size_t j = first_j; j <= last_j; j += VECTOR_FLOATS) {
+    for (size_t v = j; v < j + VECTOR_FLOATS; v++) {
+      float neighbors = up[v - 1] + up[v] + up[v + 1]
+                      + middle[v - 1] + middle[v + 1]
+                      + down[v - 1] + down[v] + down[v + 1];
+
+      next[v] = free_weights[v] * neighbors + stay_weights[v] * middle[v];
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+double get_total_probability(Belief belief) {
+  double total = 0;
+  for (size_t i = belief->first_i; i <= belief->last_i; i++) {
+    const float* row = belief->probabilities + i * belief->stride;
+    for (size_t j = belief->first_j; j <= belief->last_j; j++) {
+      total += row[j];
+    }
+  }
+
+  return total;
+}
+
+/*----------------------------------------------------------------------------*/
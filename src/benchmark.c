@@ -0,0 +1,557 @@
+// Standard headers
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Internal headers
+#include "attacker.h"
+#include "clock.h"
+#include "defender.h"
+#include "dimension.h"
+#include "direction.h"
+#include "field.h"
+#include "game.h"
+#include "item.h"
+#include "map.h"
+#include "position.h"
+#include "rng.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Main header
+#include "benchmark.h"
+
+// Macros
+#define NUMBER_INPUTS 1024 // Power of two
+#define MAD_TO_DEVIATION 1.4826 // Scales the MAD of normal samples
+#define MIN_OUTLIER_DISTANCE 0.05 // Fraction of the median
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A fixture holds what the primitives work on, and their inputs, which
+ * calls take in turn.
+ */
+struct benchmark_fixture {
+  Map map;
+  Field field; // With the obstacles and players of the game
+  Field added_field; // Where items are added over and over
+  Item obstacle;
+  Item mover; // Starts as the attacker
+  Item target; // Stays as the defender
+  Item added;
+  Spy spy; // On the target
+
+  StrategyContext attacker_context;
+  StrategyContext defender_context;
+
+  position_t free_positions[NUMBER_INPUTS];
+  position_t positions[NUMBER_INPUTS]; // Of any cell of the field
+  direction_t directions[NUMBER_INPUTS];
+};
+
+/**
+ * A benchmark function makes that many calls, from the given input
+ * index, and returns a checksum of their results, which is kept so
+ * that the calls are not optimized away.
+ */
+typedef uint64_t (*benchmark_function)(struct benchmark_fixture* fixture,
+                                       size_t first_input,
+                                       size_t number_calls);
+
+struct benchmark {
+  const char* name;
+  benchmark_function function;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static bool set_up_fixture(struct benchmark_fixture* fixture,
+                           Game game,
+                           uint64_t seed);
+static void tear_down_fixture(struct benchmark_fixture* fixture);
+
+static uint64_t time_move_position(struct benchmark_fixture* fixture,
+                                   size_t first_input,
+                                   size_t number_calls);
+static uint64_t time_neighbor_positions(struct benchmark_fixture* fixture,
+                                        size_t first_input,
+                                        size_t number_calls);
+static uint64_t time_equal_positions(struct benchmark_fixture* fixture,
+                                     size_t first_input,
+                                     size_t number_calls);
+static uint64_t time_get_map_symbol(struct benchmark_fixture* fixture,
+                                    size_t first_input,
+                                    size_t number_calls);
+static uint64_t time_add_item_to_field(struct benchmark_fixture* fixture,
+                                       size_t first_input,
+                                       size_t number_calls);
+static uint64_t time_move_item_in_field(struct benchmark_fixture* fixture,
+                                        size_t first_input,
+                                        size_t number_calls);
+static uint64_t time_get_spy_position(struct benchmark_fixture* fixture,
+                                      size_t first_input,
+                                      size_t number_calls);
+static uint64_t time_attacker_strategy(struct benchmark_fixture* fixture,
+                                       size_t first_input,
+                                       size_t number_calls);
+static uint64_t time_defender_strategy(struct benchmark_fixture* fixture,
+                                       size_t first_input,
+                                       size_t number_calls);
+
+static void summarize_samples(const double* cycles,
+                              const double* nanoseconds,
+                              size_t number_samples,
+                              benchmark_result_t* result);
+static double find_median(double* values, size_t number_values);
+static int compare_doubles(const void* a, const void* b);
+
+static uint64_t read_cycle_counter();
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE VARIABLES                              */
+/*----------------------------------------------------------------------------*/
+
+static const struct benchmark benchmarks[NUMBER_BENCHMARKS] = {
+  [BENCHMARK_MOVE_POSITION]
+    = { "move_position", time_move_position },
+  [BENCHMARK_NEIGHBOR_POSITIONS]
+    = { "neighbor_positions", time_neighbor_positions },
+  [BENCHMARK_EQUAL_POSITIONS]
+    = { "equal_positions", time_equal_positions },
+  [BENCHMARK_GET_MAP_SYMBOL]
+    = { "get_map_symbol", time_get_map_symbol },
+  [BENCHMARK_ADD_ITEM_TO_FIELD]
+    = { "add_item_to_field", time_add_item_to_field },
+  [BENCHMARK_MOVE_ITEM_IN_FIELD]
+    = { "move_item_in_field", time_move_item_in_field },
+  [BENCHMARK_GET_SPY_POSITION]
+    = { "get_spy_position", time_get_spy_position },
+  [BENCHMARK_ATTACKER_STRATEGY]
+    = { "execute_attacker_strategy", time_attacker_strategy },
+  [BENCHMARK_DEFENDER_STRATEGY]
+    = { "execute_defender_strategy", time_defender_strategy },
+};
+
+// Checksums of all calls end here, where the compiler cannot drop them
+static volatile uint64_t benchmark_sink;
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Every benchmark is run once before sampling, to warm up the caches.
+// Strategies start every sample from a new game, as if sampling the
+// first turns of games.
+void run_benchmarks(benchmark_config_t config,
+                    benchmark_result_t results[NUMBER_BENCHMARKS]) {
+  memset(results, 0, NUMBER_BENCHMARKS * sizeof(*results));
+  if (config.number_samples == 0 || config.calls_per_sample == 0) return;
+
+  struct benchmark_fixture fixture;
+  if (!set_up_fixture(&fixture, config.game, config.seed)) return;
+
+  size_t number_values = NUMBER_BENCHMARKS * config.number_samples;
+  double* cycles = malloc(number_values * sizeof(*cycles));
+  double* nanoseconds = malloc(number_values * sizeof(*nanoseconds));
+
+  for (size_t b = 0; b < NUMBER_BENCHMARKS; b++) {
+    benchmark_sink += benchmarks[b].function(&fixture, 0,
+                                             config.calls_per_sample);
+  }
+
+  for (size_t s = 0; s < config.number_samples; s++) {
+    size_t first_input = s * config.calls_per_sample;
+    rng_t rng = seed_rng(mix_seed(config.seed, s));
+
+    for (size_t b = 0; b < NUMBER_BENCHMARKS; b++) {
+      reset_strategy_context(fixture.attacker_context, split_rng(&rng));
+      reset_strategy_context(fixture.defender_context, split_rng(&rng));
+
+      uint64_t start_nanoseconds = read_monotonic_nanoseconds();
+      uint64_t start_cycles = read_cycle_counter();
+
+      benchmark_sink += benchmarks[b].function(&fixture, first_input,
+                                               config.calls_per_sample);
+
+      uint64_t end_cycles = read_cycle_counter();
+      uint64_t end_nanoseconds = read_monotonic_nanoseconds();
+
+      size_t v = b * config.number_samples + s;
+      cycles[v] = (double) (end_cycles - start_cycles)
+                  / config.calls_per_sample;
+      nanoseconds[v] = (double) (end_nanoseconds - start_nanoseconds)
+                       / config.calls_per_sample;
+    }
+  }
+
+  for (size_t b = 0; b < NUMBER_BENCHMARKS; b++) {
+    size_t v = b * config.number_samples;
+    summarize_samples(&cycles[v], &nanoseconds[v],
+                      config.number_samples, &results[b]);
+  }
+
+  free(nanoseconds);
+  free(cycles);
+
+  tear_down_fixture(&fixture);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// One line per primitive, always in the same order, to compare runs
+void print_benchmark_results(
+    const benchmark_result_t results[NUMBER_BENCHMARKS]) {
+  printf("%-26s %12s %10s %10s %9s\n",
+         "Primitive", "Cycles/call", "MAD", "ns/call", "Outliers");
+
+  for (size_t b = 0; b < NUMBER_BENCHMARKS; b++) {
+    const benchmark_result_t* result = &results[b];
+    printf("%-26s %12.2f %10.2f %10.2f %4zu/%zu\n",
+           benchmarks[b].name,
+           result->median_cycles,
+           result->mad_cycles,
+           result->median_nanoseconds,
+           result->number_outliers,
+           result->number_samples + result->number_outliers);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Items are laid out as in the game, on fields of its dimension
+bool set_up_fixture(struct benchmark_fixture* fixture,
+                    Game game,
+                    uint64_t seed) {
+  if (game == NULL) return false;
+
+  dimension_t dimension = get_game_dimension(game);
+
+  fixture->field = new_field(dimension);
+  fixture->added_field = new_field(dimension);
+  if (fixture->field == NULL || fixture->added_field == NULL) {
+    delete_field(fixture->field);
+    delete_field(fixture->added_field);
+    return false;
+  }
+
+  fixture->map = copy_game_map(game);
+  fixture->obstacle = new_item('X', false);
+  fixture->mover = new_item('A', true);
+  fixture->target = new_item('D', true);
+  fixture->added = new_item('I', true);
+  fixture->spy = new_spy(fixture->target);
+
+  rng_t rng = seed_rng(seed);
+  fixture->attacker_context = new_strategy_context(split_rng(&rng));
+  fixture->defender_context = new_strategy_context(split_rng(&rng));
+
+  size_t number_free = 0;
+  position_t* free_cells
+    = malloc(dimension.height * dimension.width * sizeof(*free_cells));
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
+      if (is_game_obstacle(game, position)) {
+        add_item_to_field(fixture->field, fixture->obstacle, position);
+      }
+      else {
+        free_cells[number_free++] = position;
+      }
+    }
+  }
+
+  add_item_to_field(fixture->field, fixture->mover,
+                    get_game_attacker_position(game));
+  add_item_to_field(fixture->field, fixture->target,
+                    get_game_defender_position(game));
+
+  static const direction_t directions[] = {
+    DIR_STAY, DIR_UP, DIR_UP_RIGHT, DIR_RIGHT, DIR_DOWN_RIGHT,
+    DIR_DOWN, DIR_DOWN_LEFT, DIR_LEFT, DIR_UP_LEFT
+  };
+  size_t number_directions = sizeof(directions) / sizeof(*directions);
+
+  for (size_t k = 0; k < NUMBER_INPUTS; k++) {
+    fixture->free_positions[k]
+      = number_free > 0
+        ? free_cells[random_below(&rng, number_free)]
+        : get_game_attacker_position(game);
+
+    fixture->positions[k] = (position_t) {
+      random_below(&rng, dimension.height),
+      random_below(&rng, dimension.width)
+    };
+
+    fixture->directions[k]
+      = directions[random_below(&rng, number_directions)];
+  }
+
+  free(free_cells);
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void tear_down_fixture(struct benchmark_fixture* fixture) {
+  delete_strategy_context(fixture->defender_context);
+  delete_strategy_context(fixture->attacker_context);
+
+  delete_spy(fixture->spy);
+
+  delete_item(fixture->added);
+  delete_item(fixture->target);
+  delete_item(fixture->mover);
+  delete_item(fixture->obstacle);
+
+  delete_map(fixture->map);
+  delete_field(fixture->added_field);
+  delete_field(fixture->field);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_move_position(struct benchmark_fixture* fixture,
+                            size_t first_input,
+                            size_t number_calls) {
+  uint64_t checksum = 0;
+
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    position_t position = move_position(fixture->free_positions[input],
+                                        fixture->directions[input]);
+    checksum += position.i + position.j;
+  }
+
+  return checksum;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_neighbor_positions(struct benchmark_fixture* fixture,
+                                 size_t first_input,
+                                 size_t number_calls) {
+  uint64_t checksum = 0;
+
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    checksum += neighbor_positions(fixture->free_positions[input],
+                                   fixture->positions[input]);
+  }
+
+  return checksum;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_equal_positions(struct benchmark_fixture* fixture,
+                              size_t first_input,
+                              size_t number_calls) {
+  uint64_t checksum = 0;
+
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    checksum += equal_positions(fixture->free_positions[input],
+                                fixture->positions[input]);
+  }
+
+  return checksum;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_get_map_symbol(struct benchmark_fixture* fixture,
+                             size_t first_input,
+                             size_t number_calls) {
+  uint64_t checksum = 0;
+
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    checksum += get_map_symbol(fixture->map, fixture->positions[input]);
+  }
+
+  return checksum;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_add_item_to_field(struct benchmark_fixture* fixture,
+                                size_t first_input,
+                                size_t number_calls) {
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    add_item_to_field(fixture->added_field, fixture->added,
+                      fixture->positions[input]);
+  }
+
+  position_t position = get_item_position(fixture->added);
+  return position.i + position.j;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The mover wanders through the field, blocked as in games
+uint64_t time_move_item_in_field(struct benchmark_fixture* fixture,
+                                 size_t first_input,
+                                 size_t number_calls) {
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    move_item_in_field(fixture->field, fixture->mover,
+                       fixture->directions[input]);
+  }
+
+  position_t position = get_item_position(fixture->mover);
+  return position.i + position.j;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_get_spy_position(struct benchmark_fixture* fixture,
+                               size_t first_input,
+                               size_t number_calls) {
+  uint64_t checksum = 0;
+
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    position_t position = get_spy_position(fixture->spy);
+    checksum += position.i + position.j;
+  }
+
+  return checksum;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_attacker_strategy(struct benchmark_fixture* fixture,
+                                size_t first_input,
+                                size_t number_calls) {
+  uint64_t checksum = 0;
+
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    direction_t direction = execute_attacker_strategy(
+        fixture->free_positions[input],
+        fixture->spy,
+        fixture->attacker_context);
+    checksum += direction.i + direction.j;
+  }
+
+  return checksum;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t time_defender_strategy(struct benchmark_fixture* fixture,
+                                size_t first_input,
+                                size_t number_calls) {
+  uint64_t checksum = 0;
+
+  for (size_t k = first_input; k < first_input + number_calls; k++) {
+    size_t input = k % NUMBER_INPUTS;
+    direction_t direction = execute_defender_strategy(
+        fixture->free_positions[input],
+        fixture->spy,
+        fixture->defender_context);
+    checksum += direction.i + direction.j;
+  }
+
+  return checksum;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Rejects the samples further than BENCHMARK_OUTLIER_DISTANCE standard
+// deviations from the median, estimated robustly from the MAD. Samples
+// within 5% of the median are always kept, as a steady primitive has
+// a MAD so small that it would reject much of its samples otherwise.
+void summarize_samples(const double* cycles,
+                       const double* nanoseconds,
+                       size_t number_samples,
+                       benchmark_result_t* result) {
+  double* values = malloc(number_samples * sizeof(*values));
+  double* kept_cycles = malloc(number_samples * sizeof(*kept_cycles));
+  double* kept_nanoseconds
+    = malloc(number_samples * sizeof(*kept_nanoseconds));
+
+  memcpy(values, cycles, number_samples * sizeof(*values));
+  double median = find_median(values, number_samples);
+
+  for (size_t s = 0; s < number_samples; s++) {
+    values[s] = fabs(cycles[s] - median);
+  }
+  double mad = find_median(values, number_samples);
+
+  double max_distance = BENCHMARK_OUTLIER_DISTANCE * MAD_TO_DEVIATION * mad;
+  if (max_distance < MIN_OUTLIER_DISTANCE * median) {
+    max_distance = MIN_OUTLIER_DISTANCE * median;
+  }
+  size_t number_kept = 0;
+
+  for (size_t s = 0; s < number_samples; s++) {
+    if (fabs(cycles[s] - median) <= max_distance) {
+      kept_cycles[number_kept] = cycles[s];
+      kept_nanoseconds[number_kept] = nanoseconds[s];
+      number_kept++;
+    }
+  }
+
+  result->number_samples = number_kept;
+  result->number_outliers = number_samples - number_kept;
+  result->median_nanoseconds = find_median(kept_nanoseconds, number_kept);
+  result->median_cycles = find_median(kept_cycles, number_kept);
+
+  for (size_t s = 0; s < number_kept; s++) {
+    kept_cycles[s] = fabs(kept_cycles[s] - result->median_cycles);
+  }
+  result->mad_cycles = find_median(kept_cycles, number_kept);
+
+  free(kept_nanoseconds);
+  free(kept_cycles);
+  free(values);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Sorts the values
+double find_median(double* values, size_t number_values) {
+  if (number_values == 0) return 0;
+
+  qsort(values, number_values, sizeof(*values), compare_doubles);
+
+  size_t middle = number_values / 2;
+  return number_values % 2 == 1
+    ? values[middle]
+    : (values[middle - 1] + values[middle]) / 2;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int compare_doubles(const void* a, const void* b) {
+  double x = *(const double*) a, y = *(const double*) b;
+  return (x > y) - (x < y);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t read_cycle_counter() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return read_monotonic_nanoseconds();
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,354 @@
+// Standard headers
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Internal headers
+#include "file_io.h"
+#include "game.h"
+#include "item.h"
+#include "rng.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Main header
+#include "bot.h"
+
+// Macros
+#define HEADER_SIZE 8
+#define START_SIZE 12
+#define REQUEST_SIZE 12
+#define DECISION_SIZE 4
+
+#define MAX_REPORTED_SPY_USES UINT8_MAX
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+enum message_type { HELLO, START, REQUEST, DECISION };
+
+struct bot {
+  pid_t process;
+  int socket;
+  bool is_alive;
+
+  // Messages are encoded in a single buffer, grown as needed
+  unsigned char* buffer;
+  size_t buffer_size;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static unsigned char* reserve_buffer(Bot bot, size_t size);
+static bool send_message(Bot bot, size_t size);
+static bool receive_message(Bot bot, size_t size);
+
+static void write_header(unsigned char* out, uint32_t type, uint32_t count);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Runs the command with a shell, talking to it through a socket
+// connected to both its standard input and output
+Bot new_bot(const char* command, enum bot_role role) {
+  int sockets[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) {
+    fprintf(stderr, "ERROR: Could not create socket for bot %s\n", command);
+    return NULL;
+  }
+
+  pid_t process = fork();
+  if (process < 0) {
+    fprintf(stderr, "ERROR: Could not start bot %s\n", command);
+    close(sockets[0]);
+    close(sockets[1]);
+    return NULL;
+  }
+
+  if (process == 0) {
+    dup2(sockets[1], STDIN_FILENO);
+    dup2(sockets[1], STDOUT_FILENO);
+    execl("/bin/sh", "sh", "-c", command, (char*) NULL);
+    _exit(127);
+  }
+
+  close(sockets[1]);
+
+  Bot bot = malloc(sizeof(*bot));
+  bot->process = process;
+  bot->socket = sockets[0];
+  bot->is_alive = true;
+  bot->buffer = NULL;
+  bot->buffer_size = 0;
+
+  write_header(reserve_buffer(bot, HEADER_SIZE), HELLO, role);
+  send_message(bot, HEADER_SIZE);
+
+  return bot;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Closing the socket tells the bot to exit
+void delete_bot(Bot bot) {
+  if (bot == NULL) return;
+
+  close(bot->socket);
+  bot->socket = -1;
+
+  waitpid(bot->process, NULL, 0);
+
+  free(bot->buffer);
+  bot->buffer = NULL;
+
+  free(bot);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_bot_alive(Bot bot) {
+  return bot != NULL && bot->is_alive;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool start_bot_games(Bot bot,
+                     const uint32_t* games,
+                     const uint64_t* seeds,
+                     size_t number_games) {
+  if (!is_bot_alive(bot)) return false;
+
+  size_t size = HEADER_SIZE + number_games * START_SIZE;
+  unsigned char* out = reserve_buffer(bot, size);
+
+  write_header(out, START, number_games);
+  out += HEADER_SIZE;
+
+  for (size_t g = 0; g < number_games; g++, out += START_SIZE) {
+    write_u32(out, games[g]);
+    write_u64(out + 4, seeds[g]);
+  }
+
+  return send_message(bot, size);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Positions must be at most BOT_MAX_COORDINATE
+bool send_bot_requests(Bot bot,
+                       const bot_request_t* requests,
+                       size_t number_requests) {
+  if (!is_bot_alive(bot)) return false;
+
+  size_t size = HEADER_SIZE + number_requests * REQUEST_SIZE;
+  unsigned char* out = reserve_buffer(bot, size);
+
+  write_header(out, REQUEST, number_requests);
+  out += HEADER_SIZE;
+
+  for (size_t r = 0; r < number_requests; r++, out += REQUEST_SIZE) {
+    write_u32(out, requests[r].game);
+    write_u16(out + 4, requests[r].position.i);
+    write_u16(out + 6, requests[r].position.j);
+    write_u16(out + 8, requests[r].opponent_position.i);
+    write_u16(out + 10, requests[r].opponent_position.j);
+  }
+
+  return send_message(bot, size);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Receives the answer to the oldest request not yet answered
+bool receive_bot_decisions(Bot bot,
+                           bot_decision_t* decisions,
+                           size_t number_decisions) {
+  if (!is_bot_alive(bot)) return false;
+
+  if (!receive_message(bot, HEADER_SIZE)) return false;
+
+  if (read_u32(bot->buffer) != DECISION
+      || read_u32(bot->buffer + 4) != number_decisions) {
+    fprintf(stderr, "ERROR: Bot answered with an invalid message\n");
+    bot->is_alive = false;
+    return false;
+  }
+
+  if (!receive_message(bot, number_decisions * DECISION_SIZE)) return false;
+
+  const unsigned char* in = bot->buffer;
+  for (size_t d = 0; d < number_decisions; d++, in += DECISION_SIZE) {
+    decisions[d].direction.i = (int8_t) in[0];
+    decisions[d].direction.j = (int8_t) in[1];
+    decisions[d].spy_uses = in[2];
+  }
+
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Answers requests with the strategy until the engine closes the input.
+// Spies of the strategy read the opponent position sent with requests.
+int serve_bot(PlayerStrategy strategy, int input, int output) {
+  unsigned char header[HEADER_SIZE];
+  unsigned char record[START_SIZE > REQUEST_SIZE ? START_SIZE : REQUEST_SIZE];
+
+  if (!read_all(input, header, HEADER_SIZE) || read_u32(header) != HELLO) {
+    fprintf(stderr, "ERROR: Bot did not receive a hello\n");
+    return EXIT_FAILURE;
+  }
+  enum bot_role role = read_u32(header + 4);
+
+  Item opponent = new_item(role == ATTACKER_BOT ? 'D' : 'A', true);
+  Spy spy = new_spy(opponent);
+
+  StrategyContext* contexts = NULL;
+  size_t number_contexts = 0;
+
+  unsigned char* decisions = NULL;
+  size_t decisions_size = 0;
+
+  while (read_all(input, header, HEADER_SIZE)) {
+    uint32_t type = read_u32(header);
+    uint32_t count = read_u32(header + 4);
+
+    if (type == START) {
+      for (uint32_t s = 0; s < count; s++) {
+        if (!read_all(input, record, START_SIZE)) break;
+        uint32_t game = read_u32(record);
+        uint64_t seed = read_u64(record + 4);
+
+        if (game >= number_contexts) {
+          size_t size = game + 1;
+          contexts = realloc(contexts, size * sizeof(*contexts));
+          for (size_t c = number_contexts; c < size; c++) {
+            contexts[c] = new_strategy_context(seed_rng(0));
+          }
+          number_contexts = size;
+        }
+
+        reset_strategy_context(contexts[game], role == ATTACKER_BOT
+                                               ? seed_attacker_rng(seed)
+                                               : seed_defender_rng(seed));
+      }
+    }
+
+    else if (type == REQUEST) {
+      size_t size = HEADER_SIZE + count * DECISION_SIZE;
+      if (size > decisions_size) {
+        decisions = realloc(decisions, size);
+        decisions_size = size;
+      }
+
+      write_header(decisions, DECISION, count);
+      unsigned char* out = decisions + HEADER_SIZE;
+
+      for (uint32_t r = 0; r < count; r++, out += DECISION_SIZE) {
+        if (!read_all(input, record, REQUEST_SIZE)) break;
+
+        uint32_t game = read_u32(record);
+        position_t position = { read_u16(record + 4), read_u16(record + 6) };
+        position_t opponent_position = {
+          read_u16(record + 8), read_u16(record + 10)
+        };
+
+        set_item_position(opponent, opponent_position);
+        size_t spy_uses = get_spy_number_uses(spy);
+
+        direction_t direction = game < number_contexts
+          ? strategy(position, spy, contexts[game])
+          : (direction_t) DIR_STAY;
+
+        spy_uses = get_spy_number_uses(spy) - spy_uses;
+
+        out[0] = (uint8_t) (int8_t) direction.i;
+        out[1] = (uint8_t) (int8_t) direction.j;
+        out[2] = spy_uses < MAX_REPORTED_SPY_USES
+                 ? spy_uses : MAX_REPORTED_SPY_USES;
+        out[3] = 0;
+      }
+
+      if (!write_all(output, decisions, size)) break;
+    }
+
+    else {
+      fprintf(stderr, "ERROR: Bot received an invalid message\n");
+      break;
+    }
+  }
+
+  for (size_t c = 0; c < number_contexts; c++) {
+    delete_strategy_context(contexts[c]);
+  }
+  free(contexts);
+  free(decisions);
+
+  delete_spy(spy);
+  delete_item(opponent);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+unsigned char* reserve_buffer(Bot bot, size_t size) {
+  if (size > bot->buffer_size) {
+    bot->buffer = realloc(bot->buffer, size);
+    bot->buffer_size = size;
+  }
+  return bot->buffer;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// A bot that does not answer is never talked to again
+bool send_message(Bot bot, size_t size) {
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t result = send(bot->socket, bot->buffer + sent, size - sent,
+                          MSG_NOSIGNAL);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) {
+      fprintf(stderr, "ERROR: Could not send message to bot\n");
+      bot->is_alive = false;
+      return false;
+    }
+    sent += result;
+  }
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool receive_message(Bot bot, size_t size) {
+  if (!read_all(bot->socket, reserve_buffer(bot, size), size)) {
+    fprintf(stderr, "ERROR: Could not receive message from bot\n");
+    bot->is_alive = false;
+    return false;
+  }
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void write_header(unsigned char* out, uint32_t type, uint32_t count) {
+  write_u32(out, type);
+  write_u32(out + 4, count);
+}
+
+/*----------------------------------------------------------------------------*/
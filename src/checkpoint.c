@@ -0,0 +1,277 @@
+// Standard headers
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include "file_io.h"
+#include "game.h"
+#include "runner.h"
+
+// Main header
+#include "checkpoint.h"
+
+// Macros
+#define CHECKPOINT_MAGIC "RUGBYCKP"
+#define CHECKPOINT_VERSION 3
+
+#define HEADER_SIZE 40
+#define SUMMARY_SIZE \
+  (8 * (3 + NUMBER_GAME_WINNERS + NUMBER_GAME_END_REASONS))
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct checkpoint {
+  uint64_t fingerprint;
+  size_t number_games;
+  size_t number_completed;
+  uint64_t results_size;
+
+  runner_summary_t summary; // Without wall time
+  uint64_t* completed; // One bit per game
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static size_t get_number_words(size_t number_games);
+static size_t get_file_size(size_t number_games);
+
+static unsigned char* write_checkpoint(Checkpoint checkpoint, size_t size);
+static bool read_checkpoint(Checkpoint checkpoint,
+                            const unsigned char* file,
+                            size_t size);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Checkpoint new_checkpoint(uint64_t fingerprint, size_t number_games) {
+  Checkpoint checkpoint = malloc(sizeof(*checkpoint));
+
+  checkpoint->fingerprint = fingerprint;
+  checkpoint->number_games = number_games;
+  checkpoint->number_completed = 0;
+  checkpoint->results_size = 0;
+
+  checkpoint->summary = (runner_summary_t) { 0 };
+  checkpoint->completed = calloc(get_number_words(number_games),
+                                 sizeof(*checkpoint->completed));
+
+  return checkpoint;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Starts afresh when there is no checkpoint yet, but fails when there
+// is one of another sweep, or a corrupt one, rather than overwrite it
+Checkpoint load_checkpoint(const char* path,
+                           uint64_t fingerprint,
+                           size_t number_games) {
+  if (path == NULL) return NULL;
+
+  Checkpoint checkpoint = new_checkpoint(fingerprint, number_games);
+
+  FILE* stream = fopen(path, "rb");
+  if (stream == NULL) {
+    if (errno == ENOENT) return checkpoint;
+
+    fprintf(stderr, "ERROR: Could not open file %s\n", path);
+    delete_checkpoint(checkpoint);
+    return NULL;
+  }
+
+  size_t size = get_file_size(number_games);
+  unsigned char* file = malloc(size + 1);
+  size_t number_read = fread(file, 1, size + 1, stream);
+  fclose(stream);
+
+  bool is_read = number_read == size
+                 && read_checkpoint(checkpoint, file, size);
+  free(file);
+
+  if (!is_read) {
+    fprintf(stderr, "ERROR: File %s is not a checkpoint of this sweep\n",
+            path);
+    delete_checkpoint(checkpoint);
+    return NULL;
+  }
+
+  return checkpoint;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_checkpoint(Checkpoint checkpoint) {
+  if (checkpoint == NULL) return;
+
+  free(checkpoint->completed);
+  checkpoint->completed = NULL;
+
+  free(checkpoint);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool save_checkpoint(Checkpoint checkpoint, const char* path) {
+  if (checkpoint == NULL || path == NULL) return false;
+
+  size_t size = get_file_size(checkpoint->number_games);
+  unsigned char* file = write_checkpoint(checkpoint, size);
+
+  bool is_saved = publish_file(path, file, size);
+  free(file);
+
+  return is_saved;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void complete_checkpoint_game(Checkpoint checkpoint, size_t index) {
+  if (checkpoint == NULL || index >= checkpoint->number_games) return;
+
+  uint64_t bit = UINT64_C(1) << (index % 64);
+  if (checkpoint->completed[index / 64] & bit) return;
+
+  checkpoint->completed[index / 64] |= bit;
+  checkpoint->number_completed++;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_checkpoint_game_completed(Checkpoint checkpoint, size_t index) {
+  if (checkpoint == NULL || index >= checkpoint->number_games) return false;
+  return (checkpoint->completed[index / 64] >> (index % 64)) & 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_checkpoint_number_completed(Checkpoint checkpoint) {
+  if (checkpoint == NULL) return 0;
+  return checkpoint->number_completed;
+}
+
+/*----------------------------------------------------------------------------*/
+
+runner_summary_t* get_checkpoint_summary(Checkpoint checkpoint) {
+  if (checkpoint == NULL) return NULL;
+  return &checkpoint->summary;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t get_checkpoint_results_size(Checkpoint checkpoint) {
+  if (checkpoint == NULL) return 0;
+  return checkpoint->results_size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_checkpoint_results_size(Checkpoint checkpoint, uint64_t size) {
+  if (checkpoint == NULL) return;
+  checkpoint->results_size = size;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+size_t get_number_words(size_t number_games) {
+  return (number_games + 63) / 64;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_file_size(size_t number_games) {
+  return HEADER_SIZE + SUMMARY_SIZE + 8 * get_number_words(number_games);
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned char* write_checkpoint(Checkpoint checkpoint, size_t size) {
+  unsigned char* file = calloc(size, 1);
+
+  memcpy(file, CHECKPOINT_MAGIC, 8);
+  write_u32(file + 8, CHECKPOINT_VERSION);
+  write_u64(file + 16, checkpoint->fingerprint);
+  write_u64(file + 24, checkpoint->number_games);
+  write_u64(file + 32, checkpoint->results_size);
+
+  const runner_summary_t* summary = &checkpoint->summary;
+  unsigned char* out = file + HEADER_SIZE;
+
+  write_u64(out, summary->number_games); out += 8;
+  write_u64(out, summary->number_failed_games); out += 8;
+  write_u64(out, summary->number_turns); out += 8;
+  for (size_t w = 0; w < NUMBER_GAME_WINNERS; w++, out += 8) {
+    write_u64(out, summary->winners[w]);
+  }
+  for (size_t r = 0; r < NUMBER_GAME_END_REASONS; r++, out += 8) {
+    write_u64(out, summary->end_reasons[r]);
+  }
+
+  size_t number_words = get_number_words(checkpoint->number_games);
+  for (size_t k = 0; k < number_words; k++, out += 8) {
+    write_u64(out, checkpoint->completed[k]);
+  }
+
+  return file;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool read_checkpoint(Checkpoint checkpoint,
+                     const unsigned char* file,
+                     size_t size) {
+  if (size < HEADER_SIZE + SUMMARY_SIZE
+      || memcmp(file, CHECKPOINT_MAGIC, 8) != 0
+      || read_u32(file + 8) != CHECKPOINT_VERSION
+      || read_u64(file + 16) != checkpoint->fingerprint
+      || read_u64(file + 24) != checkpoint->number_games) {
+    return false;
+  }
+
+  checkpoint->results_size = read_u64(file + 32);
+
+  runner_summary_t* summary = &checkpoint->summary;
+  const unsigned char* in = file + HEADER_SIZE;
+
+  summary->number_games = read_u64(in); in += 8;
+  summary->number_failed_games = read_u64(in); in += 8;
+  summary->number_turns = read_u64(in); in += 8;
+  for (size_t w = 0; w < NUMBER_GAME_WINNERS; w++, in += 8) {
+    summary->winners[w] = read_u64(in);
+  }
+  for (size_t r = 0; r < NUMBER_GAME_END_REASONS; r++, in += 8) {
+    summary->end_reasons[r] = read_u64(in);
+  }
+
+  size_t number_words = get_number_words(checkpoint->number_games);
+  for (size_t k = 0; k < number_words; k++, in += 8) {
+    checkpoint->completed[k] = read_u64(in);
+  }
+
+  // Bits beyond the last game would be counted as completed games
+  size_t number_tail_bits = checkpoint->number_games % 64;
+  if (number_words > 0 && number_tail_bits > 0) {
+    checkpoint->completed[number_words - 1]
+      &= (UINT64_C(1) << number_tail_bits) - 1;
+  }
+
+  checkpoint->number_completed = 0;
+  for (size_t k = 0; k < number_words; k++) {
+    checkpoint->number_completed
+      += __builtin_popcountll(checkpoint->completed[k]);
+  }
+
+  return checkpoint->number_completed == summary->number_games;
+}
+
+/*----------------------------------------------------------------------------*/
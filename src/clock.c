@@ -0,0 +1,22 @@
+// Standard headers
+#include <stdint.h>
+#include <time.h>
+
+// Main header
+#include "clock.h"
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+uint64_t read_monotonic_nanoseconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000UL + (uint64_t) now.tv_nsec;
+}
+
+/*----------------------------------------------------------------------------*/
+
+double read_monotonic_seconds() {
+  return read_monotonic_nanoseconds() * 1e-9;
+}
@@ -0,0 +1,450 @@
+// Standard headers
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Internal headers
+#include "clock.h"
+#include "map.h"
+#include "runner.h"
+#include "tracer.h"
+
+// Main header
+#include "corpus.h"
+
+// Macros
+#define MAP_SUFFIX ".map"
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A queue is a bounded buffer between two stages. Pushing waits while
+ * it is full, and popping while it is empty, until all of its producers
+ * have closed it.
+ */
+struct queue {
+  void** items;
+  size_t capacity;
+  size_t front;
+  size_t size;
+  size_t number_producers;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+};
+
+struct map_file {
+  char* path;
+  int descriptor;
+};
+
+/**
+ * A pipeline is the state shared by all stages of a corpus sweep.
+ */
+struct pipeline {
+  const corpus_config_t* config;
+
+  struct queue paths; // Of map paths...
+  struct queue files; // ...of their opened files...
+  struct queue maps; // ...and of their parsed maps
+
+  pthread_mutex_t summary_mutex;
+  corpus_summary_t summary;
+};
+
+/**
+ * A stage is run by number_threads threads, each of which closes the
+ * output queue once there is nothing more to take from its input.
+ */
+struct stage {
+  void* (*execute)(void* pipeline);
+  size_t number_threads;
+  struct queue* output;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void init_queue(struct queue* queue,
+                       size_t capacity,
+                       size_t number_producers);
+static void destroy_queue(struct queue* queue);
+static void push_queue(struct queue* queue, void* item);
+static void* pop_queue(struct queue* queue);
+static void close_queue(struct queue* queue);
+
+static void* scan_maps(void* pipeline);
+static void* read_maps(void* pipeline);
+static void* parse_maps(void* pipeline);
+static void* play_maps(void* pipeline);
+
+static void add_busy_seconds(struct pipeline* pipeline,
+                             double* stage_seconds,
+                             double seconds);
+static void count_failed_map(struct pipeline* pipeline);
+static bool has_map_suffix(const char* name);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+corpus_summary_t run_corpus(corpus_config_t config) {
+  if (config.runner.number_workers == 0) config.runner.number_workers = 1;
+  if (config.number_parsers == 0) config.number_parsers = 1;
+  if (config.queue_capacity == 0) config.queue_capacity = 1;
+
+  double start = read_monotonic_seconds();
+
+  struct pipeline pipeline = { .config = &config };
+  init_queue(&pipeline.paths, config.queue_capacity, 1);
+  init_queue(&pipeline.files, config.queue_capacity, 1);
+  init_queue(&pipeline.maps, config.queue_capacity, config.number_parsers);
+  pthread_mutex_init(&pipeline.summary_mutex, NULL);
+
+  // The calling thread is the first player. Later stages start first,
+  // and a stage only starts when the next one has threads to consume
+  // what it produces, so no stage ever waits for a missing one
+  const struct stage stages[] = {
+    { play_maps, config.runner.number_workers - 1, NULL },
+    { parse_maps, config.number_parsers, &pipeline.maps },
+    { read_maps, 1, &pipeline.files },
+    { scan_maps, 1, &pipeline.paths },
+  };
+  size_t number_stages = sizeof(stages) / sizeof(*stages);
+
+  size_t max_number_threads = 0;
+  for (size_t s = 0; s < number_stages; s++) {
+    max_number_threads += stages[s].number_threads;
+  }
+
+  pthread_t* threads = malloc(max_number_threads * sizeof(*threads));
+  size_t number_started = 0;
+
+  bool has_consumers = true;
+  for (size_t s = 0; s < number_stages; s++) {
+    size_t number_stage_started = 0;
+    while (has_consumers && number_stage_started < stages[s].number_threads
+           && pthread_create(&threads[number_started], NULL,
+                             stages[s].execute, &pipeline) == 0) {
+      number_started++;
+      number_stage_started++;
+    }
+
+    if (stages[s].output == NULL) continue; // Players always have one
+
+    for (size_t t = number_stage_started; t < stages[s].number_threads; t++) {
+      close_queue(stages[s].output);
+    }
+    has_consumers = number_stage_started > 0;
+  }
+
+  if (!has_consumers) {
+    fprintf(stderr, "ERROR: Could not start the stages of the pipeline\n");
+  }
+
+  play_maps(&pipeline);
+
+  for (size_t t = 0; t < number_started; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  free(threads);
+  pthread_mutex_destroy(&pipeline.summary_mutex);
+  destroy_queue(&pipeline.maps);
+  destroy_queue(&pipeline.files);
+  destroy_queue(&pipeline.paths);
+
+  pipeline.summary.games.wall_seconds = read_monotonic_seconds() - start;
+  return pipeline.summary;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void print_corpus_summary(corpus_summary_t summary) {
+  printf("Maps: %ld (%ld failed)\n",
+         summary.number_maps, summary.number_failed_maps);
+  printf("Busy: scan %.3f s, read %.3f s, parse %.3f s, play %.3f s\n",
+         summary.scan_seconds, summary.read_seconds,
+         summary.parse_seconds, summary.play_seconds);
+
+  print_runner_summary(summary.games);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+void init_queue(struct queue* queue,
+                size_t capacity,
+                size_t number_producers) {
+  queue->items = malloc(capacity * sizeof(*queue->items));
+  queue->capacity = capacity;
+  queue->front = 0;
+  queue->size = 0;
+  queue->number_producers = number_producers;
+
+  pthread_mutex_init(&queue->mutex, NULL);
+  pthread_cond_init(&queue->not_empty, NULL);
+  pthread_cond_init(&queue->not_full, NULL);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void destroy_queue(struct queue* queue) {
+  pthread_cond_destroy(&queue->not_full);
+  pthread_cond_destroy(&queue->not_empty);
+  pthread_mutex_destroy(&queue->mutex);
+
+  free(queue->items);
+  queue->items = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void push_queue(struct queue* queue, void* item) {
+  pthread_mutex_lock(&queue->mutex);
+
+  while (queue->size == queue->capacity) {
+    pthread_cond_wait(&queue->not_full, &queue->mutex);
+  }
+
+  queue->items[(queue->front + queue->size) % queue->capacity] = item;
+  queue->size++;
+
+  pthread_cond_signal(&queue->not_empty);
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Returns NULL once the queue is empty and closed by all its producers
+void* pop_queue(struct queue* queue) {
+  pthread_mutex_lock(&queue->mutex);
+
+  while (queue->size == 0 && queue->number_producers > 0) {
+    pthread_cond_wait(&queue->not_empty, &queue->mutex);
+  }
+
+  void* item = NULL;
+  if (queue->size > 0) {
+    item = queue->items[queue->front];
+    queue->front = (queue->front + 1) % queue->capacity;
+    queue->size--;
+
+    pthread_cond_signal(&queue->not_full);
+  }
+
+  pthread_mutex_unlock(&queue->mutex);
+  return item;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void close_queue(struct queue* queue) {
+  pthread_mutex_lock(&queue->mutex);
+
+  queue->number_producers--;
+  if (queue->number_producers == 0) {
+    pthread_cond_broadcast(&queue->not_empty);
+  }
+
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Map files are taken in directory order, which does not change the
+// results, as every map is played with the same seeds
+void* scan_maps(void* pipeline) {
+  struct pipeline* p = pipeline;
+  const char* directory = p->config->directory;
+
+  double busy = 0;
+  double start = read_monotonic_seconds();
+
+  DIR* stream = opendir(directory);
+  if (stream == NULL) {
+    fprintf(stderr, "ERROR: Could not open directory %s\n", directory);
+  }
+
+  struct dirent* entry;
+  while (stream != NULL && (entry = readdir(stream)) != NULL) {
+    if (!has_map_suffix(entry->d_name)) continue;
+
+    size_t size = strlen(directory) + strlen(entry->d_name) + 2;
+    char* path = malloc(size);
+    snprintf(path, size, "%s/%s", directory, entry->d_name);
+
+    busy += read_monotonic_seconds() - start;
+    push_queue(&p->paths, path);
+    start = read_monotonic_seconds();
+  }
+
+  if (stream != NULL) closedir(stream);
+  busy += read_monotonic_seconds() - start;
+
+  add_busy_seconds(p, &p->summary.scan_seconds, busy);
+  close_queue(&p->paths);
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Opens files ahead of the parsers, and has the kernel start reading
+// them in the background, so parsers seldom wait for the disk
+void* read_maps(void* pipeline) {
+  struct pipeline* p = pipeline;
+
+  double busy = 0;
+
+  char* path;
+  while ((path = pop_queue(&p->paths)) != NULL) {
+    double start = read_monotonic_seconds();
+
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) {
+      fprintf(stderr, "ERROR: Could not open file %s\n", path);
+      count_failed_map(p);
+      free(path);
+      busy += read_monotonic_seconds() - start;
+      continue;
+    }
+
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_WILLNEED);
+
+    struct map_file* file = malloc(sizeof(*file));
+    file->path = path;
+    file->descriptor = descriptor;
+
+    busy += read_monotonic_seconds() - start;
+    push_queue(&p->files, file);
+  }
+
+  add_busy_seconds(p, &p->summary.read_seconds, busy);
+  close_queue(&p->files);
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void* parse_maps(void* pipeline) {
+  struct pipeline* p = pipeline;
+
+  double busy = 0;
+
+  struct map_file* file;
+  while ((file = pop_queue(&p->files)) != NULL) {
+    double start = read_monotonic_seconds();
+
+    Map map = NULL;
+    FILE* stream = fdopen(file->descriptor, "r");
+    if (stream != NULL) {
+      map = read_map(stream);
+      fclose(stream);
+    }
+    else {
+      close(file->descriptor);
+    }
+
+    dimension_t dimension = get_map_dimension(map);
+    if (dimension.height == 0 || dimension.width == 0) {
+      fprintf(stderr, "ERROR: Could not read map %s\n", file->path);
+      count_failed_map(p);
+      delete_map(map);
+      map = NULL;
+    }
+
+    free(file->path);
+    free(file);
+
+    busy += read_monotonic_seconds() - start;
+    if (map != NULL) push_queue(&p->maps, map);
+  }
+
+  add_busy_seconds(p, &p->summary.parse_seconds, busy);
+  close_queue(&p->maps);
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Every player plays the games of one map at a time
+void* play_maps(void* pipeline) {
+  struct pipeline* p = pipeline;
+
+  double busy = 0;
+  corpus_summary_t summary = { 0 };
+
+  Map map;
+  while ((map = pop_queue(&p->maps)) != NULL) {
+    TRACE_BEGIN(map);
+
+    double start = read_monotonic_seconds();
+
+    runner_config_t config = p->config->runner;
+    config.map = map;
+    config.map_id = hash_map(map);
+    config.number_workers = 1;
+    config.expected_turns = NULL;
+
+    runner_summary_t games = run_games(config);
+    merge_runner_summaries(&summary.games, &games);
+    summary.number_maps++;
+
+    delete_map(map);
+
+    busy += read_monotonic_seconds() - start;
+
+    TRACE_END(map, "map");
+  }
+
+  pthread_mutex_lock(&p->summary_mutex);
+  p->summary.number_maps += summary.number_maps;
+  merge_runner_summaries(&p->summary.games, &summary.games);
+  p->summary.play_seconds += busy;
+  pthread_mutex_unlock(&p->summary_mutex);
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void add_busy_seconds(struct pipeline* pipeline,
+                      double* stage_seconds,
+                      double seconds) {
+  pthread_mutex_lock(&pipeline->summary_mutex);
+  *stage_seconds += seconds;
+  pthread_mutex_unlock(&pipeline->summary_mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void count_failed_map(struct pipeline* pipeline) {
+  pthread_mutex_lock(&pipeline->summary_mutex);
+  pipeline->summary.number_maps++;
+  pipeline->summary.number_failed_maps++;
+  pthread_mutex_unlock(&pipeline->summary_mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool has_map_suffix(const char* name) {
+  size_t length = strlen(name);
+  size_t suffix_length = strlen(MAP_SUFFIX);
+
+  return length > suffix_length
+         && strcmp(name + length - suffix_length, MAP_SUFFIX) == 0;
+}
+
+/*----------------------------------------------------------------------------*/
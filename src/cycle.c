@@ -0,0 +1,237 @@
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include "position.h"
+#include "strategy.h"
+
+// Main header
+#include "cycle.h"
+
+// Macros
+#define BOARD_FILTER_BITS 512 // Power of two, over twice the usual turns
+#define INITIAL_NUMBER_SLOTS 16 // Power of two
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15UL
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A hash set holds hashes in open addressing, with linear probing.
+ */
+struct hash_set {
+  uint64_t* slots; // NO_STATE_HASH when empty
+  size_t number_slots;
+  size_t number_hashes;
+};
+
+/**
+ * The first slots of the set are allocated with the detector, as most
+ * games are short, and a detector is made for every game.
+ */
+struct cycle_detector {
+  uint64_t boards[BOARD_FILTER_BITS / 64]; // One bit per board hash
+  struct hash_set states; // Only of the boards that may repeat
+  uint64_t initial_slots[INITIAL_NUMBER_SLOTS];
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void initialize_hash_set(struct hash_set* set, uint64_t* slots);
+static void clear_hash_set(struct hash_set* set);
+static bool insert_hash(struct hash_set* set, uint64_t hash);
+static bool insert_slot(uint64_t* slots, size_t number_slots, uint64_t hash);
+static void grow_hash_set(struct hash_set* set);
+static void free_hash_set(struct hash_set* set);
+
+static uint64_t mix_word(uint64_t hash, uint64_t word);
+static uint64_t finish_hash(uint64_t hash);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+CycleDetector new_cycle_detector() {
+  CycleDetector detector = malloc(sizeof(*detector));
+
+  memset(detector->boards, 0, sizeof(detector->boards));
+  initialize_hash_set(&detector->states, detector->initial_slots);
+
+  return detector;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_cycle_detector(CycleDetector detector) {
+  if (detector == NULL) return;
+
+  free_hash_set(&detector->states);
+
+  free(detector);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Keeps the slots of longer games, so that later games do not grow again
+void reset_cycle_detector(CycleDetector detector) {
+  if (detector == NULL) return;
+
+  memset(detector->boards, 0, sizeof(detector->boards));
+  clear_hash_set(&detector->states);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Remembers the board, and tells whether it may have been seen already:
+// either it was, or another board with the same bit in the filter was
+bool may_repeat_cycle_board(CycleDetector detector, uint64_t board_hash) {
+  if (detector == NULL || board_hash == NO_STATE_HASH) return false;
+
+  size_t bit = board_hash >> (64 - __builtin_ctz(BOARD_FILTER_BITS));
+  uint64_t mask = UINT64_C(1) << (bit % 64);
+
+  bool is_seen = detector->boards[bit / 64] & mask;
+  detector->boards[bit / 64] |= mask;
+
+  return is_seen;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Remembers the state, and tells whether it was already seen. Two states
+// with the same hash are taken for the same, which ends a game early
+// once in about 2^64 / number_turns^2 games.
+bool repeats_cycle_state(CycleDetector detector, uint64_t state_hash) {
+  if (detector == NULL || state_hash == NO_STATE_HASH) return false;
+  return !insert_hash(&detector->states, state_hash);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t hash_game_board(position_t attacker_position,
+                         position_t defender_position,
+                         size_t attacker_spy_uses,
+                         size_t defender_spy_uses) {
+  uint64_t hash = 0;
+  hash = mix_word(hash, attacker_position.i);
+  hash = mix_word(hash, attacker_position.j);
+  hash = mix_word(hash, defender_position.i);
+  hash = mix_word(hash, defender_position.j);
+  hash = mix_word(hash, attacker_spy_uses);
+  hash = mix_word(hash, defender_spy_uses);
+
+  return finish_hash(hash);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t hash_game_state(uint64_t board_hash,
+                         StrategyContext attacker_context,
+                         StrategyContext defender_context) {
+  if (get_strategy_scratch(attacker_context) != NULL
+      || get_strategy_scratch(defender_context) != NULL) {
+    return NO_STATE_HASH;
+  }
+
+  uint64_t hash = board_hash;
+  hash = hash_strategy_context(attacker_context, hash);
+  hash = hash_strategy_context(defender_context, hash);
+
+  return finish_hash(hash);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+void initialize_hash_set(struct hash_set* set, uint64_t* slots) {
+  set->slots = slots;
+  set->number_slots = INITIAL_NUMBER_SLOTS;
+  set->number_hashes = 0;
+  memset(set->slots, 0, set->number_slots * sizeof(*set->slots));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void clear_hash_set(struct hash_set* set) {
+  if (set->number_hashes == 0) return;
+
+  memset(set->slots, 0, set->number_slots * sizeof(*set->slots));
+  set->number_hashes = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Returns false if the hash was already there. Sets are kept at most
+// half full, so that probes stay short.
+bool insert_hash(struct hash_set* set, uint64_t hash) {
+  if (2 * (set->number_hashes + 1) > set->number_slots) grow_hash_set(set);
+
+  if (!insert_slot(set->slots, set->number_slots, hash)) return false;
+
+  set->number_hashes++;
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool insert_slot(uint64_t* slots, size_t number_slots, uint64_t hash) {
+  size_t mask = number_slots - 1;
+
+  for (size_t s = hash & mask; ; s = (s + 1) & mask) {
+    if (slots[s] == hash) return false;
+    if (slots[s] == NO_STATE_HASH) {
+      slots[s] = hash;
+      return true;
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The slots allocated with the detector are left unused from then on
+void grow_hash_set(struct hash_set* set) {
+  size_t number_slots = 2 * set->number_slots;
+  uint64_t* slots = calloc(number_slots, sizeof(*slots));
+
+  for (size_t s = 0; s < set->number_slots; s++) {
+    if (set->slots[s] != NO_STATE_HASH) {
+      insert_slot(slots, number_slots, set->slots[s]);
+    }
+  }
+
+  if (set->number_slots > INITIAL_NUMBER_SLOTS) free(set->slots);
+  set->slots = slots;
+  set->number_slots = number_slots;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void free_hash_set(struct hash_set* set) {
+  if (set->number_slots > INITIAL_NUMBER_SLOTS) free(set->slots);
+  set->slots = NULL;
+  set->number_slots = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t mix_word(uint64_t hash, uint64_t word) {
+  return (hash ^ word) * HASH_MULTIPLIER;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Spreads the last words over the low bits, which index the slots
+uint64_t finish_hash(uint64_t hash) {
+  hash ^= hash >> 32;
+  return hash == NO_STATE_HASH ? 1 : hash;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -1,11 +1,14 @@
 // Standard headers
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 // Internal headers
+#include "dimension.h"
 #include "direction.h"
 #include "position.h"
 #include "spy.h"
+#include "strategy.h"
 
 // Main header
 #include "defender.h"
@@ -14,21 +17,72 @@
 #define UNUSED(x) (void)(x) // Auxiliary to avoid error of unused parameter
 
 /*----------------------------------------------------------------------------*/
-/*                         PRIVATE VARIABLES                                  */
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
 /*----------------------------------------------------------------------------*/
 
 enum Defense_state {START, ADVANCE, RETREAT, HOLD_GROUND, PATROL};
-static enum Defense_state state = START;
 
-static position_t previous_position;
-static direction_t current_direction;
+// Kept in the strategy context, which starts zeroed (in the START state)
+struct defender_state {
+  enum Defense_state state;
+
+  position_t previous_position;
+  direction_t current_direction;
+
+  size_t height_estimate; // Either height or (height - 1)
+  size_t width; // Exactly the field width
+
+  size_t rounds_stuck;
+  size_t rotations_clockwise;
+  size_t rotations_counterclockwise;
+};
+
+_Static_assert(sizeof(struct defender_state) <= STRATEGY_STATE_SIZE,
+               "Defender state must fit in a strategy context");
 
-static size_t height_estimate; // Either height or (height - 1)
-static size_t width; // Exactly the field width
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
 
-static size_t rounds_stuck = 0;
-static size_t rotations_clockwise = 0;
-static size_t rotations_counterclockwise = 0;
+static const char* const parameter_names[NUMBER_DEFENDER_PARAMETERS] = {
+  [DEFENDER_SPY_WIDTH]       = "spy width",
+  [DEFENDER_RETREAT_OFFSET]  = "retreat offset",
+  [DEFENDER_PATROL_MARGIN]   = "patrol margin",
+  [DEFENDER_STUCK_THRESHOLD] = "stuck threshold",
+};
+
+static const double default_parameters[NUMBER_DEFENDER_PARAMETERS] = {
+  [DEFENDER_SPY_WIDTH]       = 0.5,
+  [DEFENDER_RETREAT_OFFSET]  = 3,
+  [DEFENDER_PATROL_MARGIN]   = 2,
+  [DEFENDER_STUCK_THRESHOLD] = 3,
+};
+
+static const double lower_bounds[NUMBER_DEFENDER_PARAMETERS] = {
+  [DEFENDER_SPY_WIDTH]       = 0.0,
+  [DEFENDER_RETREAT_OFFSET]  = 2,
+  [DEFENDER_PATROL_MARGIN]   = 1,
+  [DEFENDER_STUCK_THRESHOLD] = 2, // Detours step back two turns
+};
+
+static const double upper_bounds[NUMBER_DEFENDER_PARAMETERS] = {
+  [DEFENDER_SPY_WIDTH]       = 1.0,
+  [DEFENDER_RETREAT_OFFSET]  = 6,
+  [DEFENDER_PATROL_MARGIN]   = 4,
+  [DEFENDER_STUCK_THRESHOLD] = 8,
+};
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC VARIABLES                              */
+/*----------------------------------------------------------------------------*/
+
+const parameter_space_t defender_parameter_space = {
+  .number_parameters = NUMBER_DEFENDER_PARAMETERS,
+  .names = parameter_names,
+  .defaults = default_parameters,
+  .lower_bounds = lower_bounds,
+  .upper_bounds = upper_bounds,
+};
 
 /*----------------------------------------------------------------------------*/
 /*                          PRIVATE FUNCTIONS HEADERS                         */
@@ -37,56 +91,64 @@ static size_t rotations_counterclockwise = 0;
 static direction_t rotate_clockwise(direction_t d, size_t rotations);
 static direction_t rotate_counterclockwise(direction_t d, size_t rotations);
 
-static direction_t obstacle_evasion_direction();
-static direction_t execute_detour_strategy();
-static void reset_stuck_data();
+static direction_t obstacle_evasion_direction(struct defender_state* s);
+static direction_t execute_detour_strategy(struct defender_state* s);
+static void reset_stuck_data(struct defender_state* s);
 
 /*----------------------------------------------------------------------------*/
 /*                              PUBLIC FUNCTIONS                              */
 /*----------------------------------------------------------------------------*/
 
 direction_t execute_defender_strategy(
-    position_t defender_position, Spy attacker_spy) {
+    position_t defender_position, Spy attacker_spy, StrategyContext context) {
+  struct defender_state* s = get_strategy_state(context);
+
+  const double* parameters = get_strategy_parameters(context);
+  if (parameters == NULL) parameters = default_parameters;
+
+  size_t stuck_threshold = lround(parameters[DEFENDER_STUCK_THRESHOLD]);
+  size_t patrol_margin = lround(parameters[DEFENDER_PATROL_MARGIN]);
 
   /* Check if defender is stuck */
-  if (equal_positions(defender_position, previous_position)) {
-    rounds_stuck++;
-    return obstacle_evasion_direction();
+  if (equal_positions(defender_position, s->previous_position)) {
+    s->rounds_stuck++;
+    return obstacle_evasion_direction(s);
   }
-  else if (rounds_stuck >= 3) {
-    return execute_detour_strategy();
+  else if (s->rounds_stuck >= stuck_threshold) {
+    return execute_detour_strategy(s);
   }
   else {
-    reset_stuck_data();
+    reset_stuck_data(s);
   }
 
-  switch (state) {
+  switch (s->state) {
     case START :
-      height_estimate = defender_position.i * 2;
-      width = defender_position.j + 2;
+      s->height_estimate = defender_position.i * 2;
+      s->width = defender_position.j + 2;
 
-      current_direction = (direction_t) DIR_LEFT;
-      state = ADVANCE;
+      s->current_direction = (direction_t) DIR_LEFT;
+      s->state = ADVANCE;
       break;
 
     case ADVANCE :
       /* Go forward until you reach the center, then Spy and
        * start retreating on the direction of the attacker
        */
-      if (defender_position.j == width / 2) {
+      if (defender_position.j
+          == (size_t) (s->width * parameters[DEFENDER_SPY_WIDTH])) {
         size_t attacker_i_at_spy = get_spy_position(attacker_spy).i;
 
         if (attacker_i_at_spy > defender_position.i) {
-          current_direction = (direction_t) DIR_DOWN_RIGHT;
+          s->current_direction = (direction_t) DIR_DOWN_RIGHT;
         }
         else if (attacker_i_at_spy < defender_position.i) {
-          current_direction = (direction_t) DIR_UP_RIGHT;
+          s->current_direction = (direction_t) DIR_UP_RIGHT;
         }
         else { // The attacker is coming from the centre line
-          current_direction = (direction_t) DIR_RIGHT;
+          s->current_direction = (direction_t) DIR_RIGHT;
         }
 
-        state = RETREAT;
+        s->state = RETREAT;
       }
       break;
 
@@ -95,15 +157,16 @@ direction_t execute_defender_strategy(
        * When you reach the second to last walkable column,
        * start patrolling or hold your ground
        */
-      if (defender_position.j == width - 3) {
-        if (abs(current_direction.i) == height_estimate / 2) {
-          current_direction = (direction_t) DIR_STAY;
-          state = HOLD_GROUND;
+      if (defender_position.j
+          == s->width - lround(parameters[DEFENDER_RETREAT_OFFSET])) {
+        if (abs(s->current_direction.i) == s->height_estimate / 2) {
+          s->current_direction = (direction_t) DIR_STAY;
+          s->state = HOLD_GROUND;
         }
 
         else {
-          current_direction = (direction_t) {current_direction.i, 0};
-          state = PATROL;
+          s->current_direction = (direction_t) {s->current_direction.i, 0};
+          s->state = PATROL;
         }
       }
       break;
@@ -112,20 +175,40 @@ direction_t execute_defender_strategy(
 
     case PATROL : 
       /* Keep going up and down until the second to last line */
-      if (defender_position.i <= 2) {
-        current_direction = (direction_t) DIR_DOWN;
+      if (defender_position.i <= patrol_margin) {
+        s->current_direction = (direction_t) DIR_DOWN;
       }
-      else if (defender_position.i >= height_estimate - 2) {
-        current_direction = (direction_t) DIR_UP;
+      else if (defender_position.i >= s->height_estimate - patrol_margin) {
+        s->current_direction = (direction_t) DIR_UP;
       }
       break;
 
     default : // Invalid state. Restart strategy
-      state = START;
+      s->state = START;
   }
 
-  previous_position = defender_position;
-  return current_direction;
+  s->previous_position = defender_position;
+  return s->current_direction;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void execute_defenders_team_strategy(dimension_t field_dimension,
+                                     size_t number_defenders,
+                                     const coordinate_t* lines,
+                                     const coordinate_t* columns,
+                                     direction_t* directions) {
+  size_t wall_column = field_dimension.width / 2;
+  size_t walkable_lines = field_dimension.height - 2;
+
+  for (size_t d = 0; d < number_defenders; d++) {
+    // Spread defenders evenly over the walkable lines
+    size_t target_line = 1 + (d * walkable_lines) / number_defenders
+                           + walkable_lines / (2 * number_defenders);
+
+    directions[d].i = (lines[d] < target_line) - (lines[d] > target_line);
+    directions[d].j = (columns[d] < wall_column) - (columns[d] > wall_column);
+  }
 }
 
 /*----------------------------------------------------------------------------*/
@@ -156,27 +239,27 @@ direction_t rotate_counterclockwise(direction_t direction, size_t rotations) {
   return d;
 }
 
-direction_t obstacle_evasion_direction() {
-  if (rounds_stuck % 2 == 1)
-    return rotate_clockwise(current_direction, ++rotations_clockwise);
+direction_t obstacle_evasion_direction(struct defender_state* s) {
+  if (s->rounds_stuck % 2 == 1)
+    return rotate_clockwise(s->current_direction, ++s->rotations_clockwise);
   else
-    return rotate_counterclockwise(current_direction,
-                                        ++rotations_counterclockwise);
+    return rotate_counterclockwise(s->current_direction,
+                                   ++s->rotations_counterclockwise);
 }
 
-direction_t execute_detour_strategy() {
-  rounds_stuck -= 2;
-  if (rounds_stuck % 2 == 1)
-    return rotate_clockwise(current_direction, --rotations_clockwise);
+direction_t execute_detour_strategy(struct defender_state* s) {
+  s->rounds_stuck -= 2;
+  if (s->rounds_stuck % 2 == 1)
+    return rotate_clockwise(s->current_direction, --s->rotations_clockwise);
   else
-    return rotate_counterclockwise(current_direction,
-                                        --rotations_counterclockwise);
+    return rotate_counterclockwise(s->current_direction,
+                                   --s->rotations_counterclockwise);
 }
 
-void reset_stuck_data() {
-  rounds_stuck = 0;
-  rotations_clockwise = 0;
-  rotations_counterclockwise = 0;
+void reset_stuck_data(struct defender_state* s) {
+  s->rounds_stuck = 0;
+  s->rotations_clockwise = 0;
+  s->rotations_counterclockwise = 0;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -0,0 +1,256 @@
+// Standard headers
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Internal headers
+#include "game.h"
+#include "rng.h"
+#include "runner.h"
+
+// Main header
+#include "evaluation.h"
+
+// Macros
+#define MIN_VARIANCE 1e-9 // Keeps the test defined for a null difference
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A tally sums the scores of both strategies, from the evaluated side,
+ * over the pairs of games they played with the same seed, and the
+ * squares of the differences of their scores in each pair.
+ */
+struct tally {
+  double number_pairs;
+  double baseline_scores;
+  double candidate_scores;
+  double squared_differences;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+static const char* verdict_messages[] = {
+  [CANDIDATE_IS_BETTER]       = "candidate is better than baseline",
+  [CANDIDATE_IS_WORSE]        = "candidate is worse than baseline",
+  [NO_SIGNIFICANT_DIFFERENCE] = "no significant difference",
+  [INCONCLUSIVE]              = "inconclusive",
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void play_batch(const evaluation_config_t* config,
+                       Runner runner,
+                       PlayerStrategy strategy,
+                       size_t player,
+                       size_t batch,
+                       size_t number_games,
+                       enum game_winner* winners);
+static void tally_pairs(const evaluation_config_t* config,
+                        const enum game_winner* baseline_winners,
+                        const enum game_winner* candidate_winners,
+                        size_t number_games,
+                        struct tally* tally);
+
+static double score_game(enum evaluated_side side, enum game_winner winner);
+static double tally_difference(const struct tally* tally);
+static double tally_variance(const struct tally* tally);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// The mean difference of scores over the pairs of games is approximately
+// normal, so each side of the test is the SPRT of H0: difference = 0
+// against H1: difference = d, for d = +min_difference and
+// d = -min_difference. Both games of a pair have the same seed, so the
+// variance is the one of the differences within pairs, which is lower
+// than the sum of the variances of the strategies when their games are
+// alike, and the test stops sooner. The variance is never taken below
+// that of the closest strategies that still differ by d: those whose
+// games differ by 1/2 in a fraction 2d of the pairs, and are alike in
+// all others. Otherwise a first batch without any differing pair would
+// accept H0 at once, however rare the games that tell them apart.
+evaluation_result_t evaluate_strategies(evaluation_config_t config) {
+  evaluation_result_t result = { INCONCLUSIVE, 0, 0.0, 0.0, 0.0 };
+
+  if (config.batch_size == 0) config.batch_size = 1;
+  if (config.batch_size > config.max_games) {
+    config.batch_size = config.max_games;
+  }
+
+  double accept_h1 = log((1 - config.beta) / config.alpha);
+  double accept_h0 = log(config.beta / (1 - config.alpha));
+  double d = config.min_difference;
+  double min_variance = fabs(d) / 2 > MIN_VARIANCE ? fabs(d) / 2
+                      : MIN_VARIANCE;
+
+  // One runner plays every batch, so its workers and the analysis of
+  // the map are not made again for each of them
+  Runner runner = new_runner(config.runner);
+  enum game_winner* baseline_winners
+    = malloc((config.batch_size + 1) * sizeof(*baseline_winners));
+  enum game_winner* candidate_winners
+    = malloc((config.batch_size + 1) * sizeof(*candidate_winners));
+
+  struct tally tally = { 0 };
+
+  for (size_t batch = 0; result.number_games < config.max_games; batch++) {
+    size_t number_games = config.max_games - result.number_games;
+    if (number_games > config.batch_size) number_games = config.batch_size;
+
+    play_batch(&config, runner, config.baseline_strategy,
+               config.baseline_player, batch, number_games,
+               baseline_winners);
+    play_batch(&config, runner, config.candidate_strategy,
+               config.candidate_player, batch, number_games,
+               candidate_winners);
+    tally_pairs(&config, baseline_winners, candidate_winners, number_games,
+                &tally);
+    result.number_games += number_games;
+
+    double difference = tally_difference(&tally);
+    double variance = tally_variance(&tally);
+    if (variance < min_variance) variance = min_variance;
+
+    double n = tally.number_pairs;
+    double llr_better = n * (d * difference - d * d / 2) / variance;
+    double llr_worse = n * (-d * difference - d * d / 2) / variance;
+
+    if (n > 0) {
+      result.baseline_score = tally.baseline_scores / n;
+      result.candidate_score = tally.candidate_scores / n;
+    }
+    result.log_likelihood_ratio
+      = llr_better > llr_worse ? llr_better : llr_worse;
+
+    if (llr_better >= accept_h1) {
+      result.verdict = CANDIDATE_IS_BETTER;
+      break;
+    }
+
+    if (llr_worse >= accept_h1) {
+      result.verdict = CANDIDATE_IS_WORSE;
+      break;
+    }
+
+    if (llr_better <= accept_h0 && llr_worse <= accept_h0) {
+      result.verdict = NO_SIGNIFICANT_DIFFERENCE;
+      break;
+    }
+  }
+
+  free(candidate_winners);
+  free(baseline_winners);
+  delete_runner(runner);
+
+  return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void print_evaluation_result(evaluation_result_t result) {
+  printf("Verdict: %s\n", verdict_messages[result.verdict]);
+  printf("Games per strategy: %ld\n", result.number_games);
+  printf("Baseline score: %.4f\n", result.baseline_score);
+  printf("Candidate score: %.4f\n", result.candidate_score);
+  printf("Log-likelihood ratio: %.3f\n", result.log_likelihood_ratio);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Both strategies play the same batch with the same seeds,
+// so neither of them is favored by luckier games
+void play_batch(const evaluation_config_t* config,
+                Runner runner,
+                PlayerStrategy strategy,
+                size_t player,
+                size_t batch,
+                size_t number_games,
+                enum game_winner* winners) {
+  const runner_config_t* defaults = &config->runner;
+
+  runner_sweep_t sweep = {
+    .number_games = number_games,
+    .seed = mix_seed(defaults->seed, batch),
+    .attacker_strategy = defaults->attacker_strategy,
+    .defender_strategy = defaults->defender_strategy,
+    .attacker_player = defaults->attacker_player,
+    .defender_player = defaults->defender_player,
+    .winners = winners,
+  };
+
+  if (config->side == ATTACKER_SIDE) {
+    sweep.attacker_strategy = strategy;
+    sweep.attacker_player = player;
+  } else {
+    sweep.defender_strategy = strategy;
+    sweep.defender_player = player;
+  }
+
+  run_runner_sweep(runner, sweep);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Pairs in which a game failed are left out
+void tally_pairs(const evaluation_config_t* config,
+                 const enum game_winner* baseline_winners,
+                 const enum game_winner* candidate_winners,
+                 size_t number_games,
+                 struct tally* tally) {
+  for (size_t g = 0; g < number_games; g++) {
+    if (baseline_winners[g] == NUMBER_GAME_WINNERS
+        || candidate_winners[g] == NUMBER_GAME_WINNERS) {
+      continue;
+    }
+
+    double baseline_score = score_game(config->side, baseline_winners[g]);
+    double candidate_score = score_game(config->side, candidate_winners[g]);
+    double difference = candidate_score - baseline_score;
+
+    tally->number_pairs++;
+    tally->baseline_scores += baseline_score;
+    tally->candidate_scores += candidate_score;
+    tally->squared_differences += difference * difference;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// 1 for a win of the evaluated side, 1/2 for a draw
+double score_game(enum evaluated_side side, enum game_winner winner) {
+  if (winner == NO_WINNER) return 0.5;
+
+  enum game_winner side_winner
+    = side == ATTACKER_SIDE ? ATTACKER_WINNER : DEFENDER_WINNER;
+  return winner == side_winner ? 1.0 : 0.0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+double tally_difference(const struct tally* tally) {
+  if (tally->number_pairs == 0) return 0.0;
+  return (tally->candidate_scores - tally->baseline_scores)
+         / tally->number_pairs;
+}
+
+/*----------------------------------------------------------------------------*/
+
+double tally_variance(const struct tally* tally) {
+  if (tally->number_pairs == 0) return 0.0;
+
+  double mean = tally_difference(tally);
+  return tally->squared_differences / tally->number_pairs - mean * mean;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -2,27 +2,68 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include "profiler.h"
 
 // Main header
 #include "field.h"
 
+// Macros
+#ifdef FIELD_FIXED_DIMENSION
+#define FIELD_HEIGHT RUGBY_FIXED_FIELD_HEIGHT
+#define FIELD_WIDTH RUGBY_FIXED_FIELD_WIDTH
+#define FIELD_MAX_ITEMS 4 // Attacker, defender and obstacles fit
+#endif
+
 /*----------------------------------------------------------------------------*/
 /*                        PRIVATE STRUCT IMPLEMENTATION                       */
 /*----------------------------------------------------------------------------*/
 
+#ifdef FIELD_FIXED_DIMENSION
+
+/**
+ * A fixed field holds, for every cell, the slot of the item in it, in a
+ * single byte, so that the standard field fits in a few cache lines,
+ * and holds no grid to allocate. Slot 0 is for empty cells.
+ */
+struct field {
+  uint8_t cells[FIELD_HEIGHT * FIELD_WIDTH]; // By line
+  uint8_t number_slots;
+  Item items[FIELD_MAX_ITEMS + 1]; // By slot
+};
+
+#else
+
 struct field {
   dimension_t dimension;
   Item** grid;
 };
 
+#endif
+
 /*----------------------------------------------------------------------------*/
 /*                          PRIVATE FUNCTIONS HEADERS                         */
 /*----------------------------------------------------------------------------*/
 
+#ifdef FIELD_FIXED_DIMENSION
+size_t get_field_cell(position_t position);
+uint8_t find_field_item_slot(Field field, Item item);
+#else
 Item** allocate_field_grid(dimension_t dimension);
 void free_field_grid(Item** grid, dimension_t dimension);
+#endif
+
+Item find_field_item(Field field, position_t position);
+void place_field_item(Field field, Item item, position_t position);
+void shift_field_item(Field field,
+                      Item item,
+                      position_t position,
+                      position_t new_position);
 
 bool position_is_beyond_limit_of_field(Field field, position_t p);
 void print_item_in_field(Item item);
@@ -46,10 +87,35 @@ Field new_field(dimension_t dimension) {
     return NULL;
   }
 
+  // Coordinates must hold every line and column, and one more for
+  // invalid positions (see coordinate.h)
+  if (dimension.height > FIELD_MAX_DIMENSION.height
+      || dimension.width > FIELD_MAX_DIMENSION.width) {
+    fprintf(stderr,
+        "Height and width must be at most %ld with %d-bit coordinates\n",
+        FIELD_MAX_DIMENSION.height, RUGBY_COORDINATE_BITS);
+    return NULL;
+  }
+
+#ifdef FIELD_FIXED_DIMENSION
+  if (dimension.height != FIELD_HEIGHT || dimension.width != FIELD_WIDTH) {
+    fprintf(stderr,
+        "Height and width must be %d x %d, as fixed in this build\n",
+        FIELD_HEIGHT, FIELD_WIDTH);
+    return NULL;
+  }
+
+  Field field = malloc(sizeof(*field));
+
+  memset(field->cells, 0, sizeof(field->cells));
+  field->number_slots = 1;
+  field->items[0] = NULL;
+#else
   Field field = malloc(sizeof(*field));
 
   field->dimension = dimension;
   field->grid = allocate_field_grid(dimension);
+#endif
 
   return field;
 }
@@ -59,10 +125,12 @@ Field new_field(dimension_t dimension) {
 void delete_field(Field field) {
   if (field == NULL) return;
 
+#ifndef FIELD_FIXED_DIMENSION
   free_field_grid(field->grid, field->dimension);
   field->grid = NULL;
 
   field->dimension = (dimension_t) NULL_DIMENSION;
+#endif
 
   free(field);
 }
@@ -71,7 +139,12 @@ void delete_field(Field field) {
 
 dimension_t get_field_dimension(Field field) {
   if (field == NULL) return (dimension_t) NULL_DIMENSION;
+
+#ifdef FIELD_FIXED_DIMENSION
+  return FIELD_FIXED_DIMENSION;
+#else
   return field->dimension;
+#endif
 }
 
 /*----------------------------------------------------------------------------*/
@@ -79,8 +152,10 @@ dimension_t get_field_dimension(Field field) {
 void print_field_info(Field field) {
   if (field == NULL) return;
 
+  dimension_t dimension = get_field_dimension(field);
+
   printf("Dimensions (H x W): %ld x %ld\n",
-      field->dimension.height, field->dimension.width);
+      dimension.height, dimension.width);
   putchar('\n');
 }
 
@@ -89,10 +164,13 @@ void print_field_info(Field field) {
 void print_field_grid(Field field) {
   if (field == NULL) return;
 
-  for (size_t i = 0; i < field->dimension.height; i++) {
-    for (size_t j = 0; j < field->dimension.width; j++) {
+  dimension_t dimension = get_field_dimension(field);
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
       putchar('|');
-      print_item_in_field(field->grid[i][j]);
+      print_item_in_field(find_field_item(field, position));
     }
     putchar('|');
     putchar('\n');
@@ -102,6 +180,15 @@ void print_field_grid(Field field) {
 
 /*----------------------------------------------------------------------------*/
 
+Item get_field_item(Field field, position_t position) {
+  if (field == NULL) return NULL;
+  if (position_is_beyond_limit_of_field(field, position)) return NULL;
+
+  return find_field_item(field, position);
+}
+
+/*----------------------------------------------------------------------------*/
+
 void add_item_to_field(Field field, Item item, position_t position) {
   if (field == NULL || item == NULL) return;
 
@@ -111,8 +198,7 @@ void add_item_to_field(Field field, Item item, position_t position) {
     return;
   }
 
-  field->grid[position.i][position.j] = item;
-  set_item_position(item, position);
+  place_field_item(field, item, position);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -120,6 +206,8 @@ void add_item_to_field(Field field, Item item, position_t position) {
 void move_item_in_field(Field field, Item item, direction_t direction) {
   if (field == NULL || item == NULL) return;
 
+  PROFILE_BEGIN(PROFILE_MOVE_ITEM_IN_FIELD);
+
   position_t item_position = get_item_position(item);
 
   // Given how items are added to the field, their position
@@ -128,24 +216,115 @@ void move_item_in_field(Field field, Item item, direction_t direction) {
 
   if (!is_item_movable(item)) {
     fprintf(stderr, "WARNING: Item is not movable!\n");
+    PROFILE_END(PROFILE_MOVE_ITEM_IN_FIELD);
     return;
   }
 
   position_t new_position = move_position(get_item_position(item), direction);
 
-  // Item cannot be moved if position is already occupied
-  if (field->grid[new_position.i][new_position.j] != NULL) return;
+  // Item can only be moved if position is not occupied yet
+  if (find_field_item(field, new_position) == NULL) {
+    shift_field_item(field, item, item_position, new_position);
+    set_item_position(item, new_position);
+  }
 
-  // Change current position in the grid
-  field->grid[new_position.i][new_position.j] = item;
-  field->grid[item_position.i][item_position.j] = NULL;
-  set_item_position(item, new_position);
+  PROFILE_END(PROFILE_MOVE_ITEM_IN_FIELD);
 }
 
 /*----------------------------------------------------------------------------*/
 /*                             PRIVATE FUNCTIONS                              */
 /*----------------------------------------------------------------------------*/
 
+#ifdef FIELD_FIXED_DIMENSION
+
+size_t get_field_cell(position_t position) {
+  return position.i * FIELD_WIDTH + position.j;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Returns 0 if the item is not in the field
+uint8_t find_field_item_slot(Field field, Item item) {
+  for (uint8_t k = 1; k < field->number_slots; k++) {
+    if (field->items[k] == item) return k;
+  }
+
+  return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+Item find_field_item(Field field, position_t position) {
+  return field->items[field->cells[get_field_cell(position)]];
+}
+
+/*----------------------------------------------------------------------------*/
+
+void place_field_item(Field field, Item item, position_t position) {
+  uint8_t slot = find_field_item_slot(field, item);
+
+  if (slot == 0) {
+    if (field->number_slots == FIELD_MAX_ITEMS + 1) {
+      fprintf(stderr, "ERROR: Field must hold at most %d items!\n",
+          FIELD_MAX_ITEMS);
+      return;
+    }
+
+    slot = field->number_slots++;
+    field->items[slot] = item;
+  }
+
+  field->cells[get_field_cell(position)] = slot;
+  set_item_position(item, position);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void shift_field_item(Field field,
+                      Item item,
+                      position_t position,
+                      position_t new_position) {
+  (void) item;
+
+  size_t cell = get_field_cell(position);
+  field->cells[get_field_cell(new_position)] = field->cells[cell];
+  field->cells[cell] = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The dimension is constant, so the check folds into two comparisons
+bool position_is_beyond_limit_of_field(Field field, position_t p) {
+  if (field == NULL) return false;
+  return p.i > FIELD_HEIGHT-1 || p.j > FIELD_WIDTH-1;
+}
+
+#else
+
+Item find_field_item(Field field, position_t position) {
+  return field->grid[position.i][position.j];
+}
+
+/*----------------------------------------------------------------------------*/
+
+void place_field_item(Field field, Item item, position_t position) {
+  field->grid[position.i][position.j] = item;
+  set_item_position(item, position);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Change current position in the grid
+void shift_field_item(Field field,
+                      Item item,
+                      position_t position,
+                      position_t new_position) {
+  field->grid[new_position.i][new_position.j] = item;
+  field->grid[position.i][position.j] = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
 // Allocate field's grid as C-matrix in the heap
 Item** allocate_field_grid(dimension_t dimension) {
   Item** grid = malloc(dimension.height * sizeof(*grid));
@@ -182,6 +361,8 @@ bool position_is_beyond_limit_of_field(Field field, position_t p) {
   return p.i > field->dimension.height-1 || p.j > field->dimension.width-1;
 }
 
+#endif
+
 /*----------------------------------------------------------------------------*/
 
 void print_item_in_field(Item item) {
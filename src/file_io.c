@@ -0,0 +1,116 @@
+// Standard headers
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Main header
+#include "file_io.h"
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+bool read_all(int input, unsigned char* bytes, size_t size) {
+  size_t read_size = 0;
+  while (read_size < size) {
+    ssize_t result = read(input, bytes + read_size, size - read_size);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) return false;
+    read_size += result;
+  }
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool write_all(int output, const unsigned char* bytes, size_t size) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t result = write(output, bytes + written, size - written);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) return false;
+    written += result;
+  }
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// A failed publish removes its temporary file, and leaves the path as
+// it was
+bool publish_file(const char* path, const unsigned char* data, size_t size) {
+  size_t length = strlen(path);
+  char* temporary_path = malloc(length + sizeof(".XXXXXX"));
+  memcpy(temporary_path, path, length);
+  memcpy(temporary_path + length, ".XXXXXX", sizeof(".XXXXXX"));
+
+  int descriptor = mkstemp(temporary_path);
+  if (descriptor < 0) {
+    fprintf(stderr, "ERROR: Could not create file %s\n", temporary_path);
+    free(temporary_path);
+    return false;
+  }
+
+  // Temporary files are private, but published files may be shared
+  bool is_published = write_all(descriptor, data, size)
+                      && fchmod(descriptor, 0644) == 0
+                      && fsync(descriptor) == 0;
+  close(descriptor);
+
+  is_published = is_published && rename(temporary_path, path) == 0;
+  if (!is_published) {
+    fprintf(stderr, "ERROR: Could not write file %s\n", path);
+    unlink(temporary_path);
+  }
+
+  free(temporary_path);
+
+  return is_published;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void write_u16(unsigned char* out, uint16_t value) {
+  out[0] = value;
+  out[1] = value >> 8;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint16_t read_u16(const unsigned char* in) {
+  return in[0] | (uint16_t) in[1] << 8;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void write_u32(unsigned char* out, uint32_t value) {
+  for (size_t k = 0; k < 4; k++) out[k] = value >> (8 * k);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t read_u32(const unsigned char* in) {
+  uint32_t value = 0;
+  for (size_t k = 0; k < 4; k++) value |= (uint32_t) in[k] << (8 * k);
+  return value;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void write_u64(unsigned char* out, uint64_t value) {
+  for (size_t k = 0; k < 8; k++) out[k] = value >> (8 * k);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t read_u64(const unsigned char* in) {
+  uint64_t value = 0;
+  for (size_t k = 0; k < 8; k++) value |= (uint64_t) in[k] << (8 * k);
+  return value;
+}
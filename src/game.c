@@ -1,39 +1,102 @@
 // Standard headers
 #include <assert.h>
+#include <pthread.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 // Internal headers
+#include "clock.h"
+#include "cycle.h"
 #include "field.h"
 #include "map.h"
+#include "profiler.h"
+#include "rng.h"
 #include "spy.h"
+#include "strategy.h"
+#include "tracer.h"
 
 // Main header
 #include "game.h"
 
 // Macros
 #define MAX_SINGLE_OCCURRENCE 1UL
+#define DEFAULT_GAME_SEED 0UL
 #define UNUSED(x) (void)(x) // Auxiliary to avoid error of unused parameter
 
 /*----------------------------------------------------------------------------*/
 /*                        PRIVATE STRUCT IMPLEMENTATION                       */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * Player turns keep what the game records of the decisions of a player
+ * with a turn budget.
+ */
+struct player_turns {
+  direction_t last_direction; // Played, for LAST_DIRECTION_FALLBACK
+  turn_timings_t timings;
+};
+
 struct game {
   Field field;
 
   size_t max_number_spies;
+  bool simultaneous_moves;
+  bool concurrent_decisions;
+  struct decision_helper* helper; // Started on the first concurrent turn
 
   PlayerStrategy execute_attacker_strategy;
   PlayerStrategy execute_defender_strategy;
 
+  StrategyContext attacker_context;
+  StrategyContext defender_context;
+
   Item attacker;
   Item defender;
   Item obstacle;
+  bool* obstacles; // Of the field, row-major, for the strategies
 
   Spy attacker_spy;
   Spy defender_spy;
+
+  CycleDetector cycle_detector;
+
+  uint64_t turn_budget; // In nanoseconds
+  enum turn_fallback turn_fallback;
+  struct player_turns attacker_turns;
+  struct player_turns defender_turns;
+};
+
+/**
+ * A decision is the request for a strategy to choose the direction
+ * of an item, and its answer, to be evaluated in this thread or in the
+ * helper thread of the game.
+ */
+struct decision {
+  position_t item_position;
+  Spy opponent_spy;
+  PlayerStrategy execute_item_strategy;
+  StrategyContext item_context;
+  direction_t item_direction;
+
+  uint64_t turn_budget;
+  enum turn_fallback turn_fallback;
+  struct player_turns* item_turns;
+};
+
+/**
+ * A decision helper is a thread that evaluates the decisions of a game
+ * on request, so that concurrent decisions do not start a thread every
+ * turn. It lives as long as the game.
+ */
+struct decision_helper {
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t requested; // A decision is pending, or the helper stops
+  pthread_cond_t completed;
+  struct decision* decision; // Pending, NULL once evaluated
+  bool is_stopping;
 };
 
 /*----------------------------------------------------------------------------*/
@@ -53,16 +116,40 @@ void set_item_in_field_from_map(Field field, Item item, Map map);
 void set_attacker_in_field(Field field, Item attacker);
 void set_defender_in_field(Field field, Item defender);
 void set_obstacles_in_field(Field field, Item obstacle);
+void set_strategy_layouts(Game game);
 
 bool has_spy_exceeded_max_number_uses(Spy opponent_spy,
                                       size_t max_number_spies);
 bool has_defender_captured_attacker(Item defender, Item attacker);
 bool has_attacker_arrived_end_field(Field field, Item attacker);
-
-void move_item(Field field,
-               Item item,
-               Spy opponent_spy,
-               PlayerStrategy execute_item_strategy);
+enum game_end_reason check_turn_outcome(Game game);
+
+void start_cycle_detection(Game game);
+enum game_end_reason check_turn_cycle(Game game, bool* is_detecting_cycles);
+uint64_t hash_current_board(Game game);
+
+void start_turn_timings(Game game);
+void start_strategy_limits(Game game, size_t max_turns);
+struct decision make_decision(Game game,
+                              Item item,
+                              Spy opponent_spy,
+                              PlayerStrategy execute_item_strategy,
+                              StrategyContext item_context,
+                              struct player_turns* item_turns);
+
+void move_item(Field field, Item item, struct decision* decision);
+
+void play_turn(Game game);
+void move_items_simultaneously(Game game);
+void* execute_decision(void* decision);
+void decide_within_budget(struct decision* d);
+
+struct decision_helper* start_decision_helper();
+void stop_decision_helper(struct decision_helper* helper);
+void* run_decision_helper(void* helper);
+void request_decision(struct decision_helper* helper,
+                      struct decision* decision);
+void await_decision(struct decision_helper* helper);
 
 /*----------------------------------------------------------------------------*/
 /*                              PUBLIC FUNCTIONS                              */
@@ -79,9 +166,12 @@ Game new_game(
       execute_attacker_strategy,
       execute_defender_strategy);
 
+  if (game == NULL) return NULL;
+
   set_attacker_in_field(game->field, game->attacker);
   set_defender_in_field(game->field, game->defender);
   set_obstacles_in_field(game->field, game->obstacle);
+  set_strategy_layouts(game);
 
   return game;
 }
@@ -95,6 +185,9 @@ Game new_game_from_map(
     PlayerStrategy execute_defender_strategy) {
   if (map == NULL) return NULL;
 
+  PROFILE_BEGIN(PROFILE_NEW_GAME_FROM_MAP);
+  TRACE_BEGIN(new_game_from_map);
+
   dimension_t field_dimension = get_map_dimension(map);
 
   Game game = allocate_game(
@@ -103,6 +196,12 @@ Game new_game_from_map(
       execute_attacker_strategy,
       execute_defender_strategy);
 
+  if (game == NULL) {
+    TRACE_END(new_game_from_map, "new_game_from_map");
+    PROFILE_END(PROFILE_NEW_GAME_FROM_MAP);
+    return NULL;
+  }
+
   if (has_map_exceeded_max_occurrences_of_symbol(
         map, get_item_symbol(game->attacker), MAX_SINGLE_OCCURRENCE)) {
     fprintf(stderr, "ERROR: Map exceeded max occurrences of symbol %c\n",
@@ -122,7 +221,10 @@ Game new_game_from_map(
   set_item_in_field_from_map(game->field, game->attacker, map);
   set_item_in_field_from_map(game->field, game->defender, map);
   set_item_in_field_from_map(game->field, game->obstacle, map);
+  set_strategy_layouts(game);
 
+  TRACE_END(new_game_from_map, "new_game_from_map");
+  PROFILE_END(PROFILE_NEW_GAME_FROM_MAP);
   return game;
 }
 
@@ -131,6 +233,14 @@ Game new_game_from_map(
 void delete_game(Game game) {
   if (game == NULL) return;
 
+  TRACE_BEGIN(delete_game);
+
+  stop_decision_helper(game->helper);
+  game->helper = NULL;
+
+  delete_cycle_detector(game->cycle_detector);
+  game->cycle_detector = NULL;
+
   delete_spy(game->defender_spy);
   game->defender_spy = NULL;
 
@@ -140,12 +250,21 @@ void delete_game(Game game) {
   delete_item(game->obstacle);
   game->obstacle = NULL;
 
+  free(game->obstacles);
+  game->obstacles = NULL;
+
   delete_item(game->defender);
   game->defender = NULL;
 
   delete_item(game->attacker);
   game->attacker = NULL;
 
+  delete_strategy_context(game->defender_context);
+  game->defender_context = NULL;
+
+  delete_strategy_context(game->attacker_context);
+  game->attacker_context = NULL;
+
   game->execute_defender_strategy = NULL;
   game->execute_attacker_strategy = NULL;
 
@@ -155,6 +274,8 @@ void delete_game(Game game) {
   game->field = NULL;
 
   free(game);
+
+  TRACE_END(delete_game, "delete_game");
 }
 
 /*----------------------------------------------------------------------------*/
@@ -167,51 +288,146 @@ void print_game(Game game) {
 
 /*----------------------------------------------------------------------------*/
 
+void set_game_simultaneous_moves(Game game, bool simultaneous_moves) {
+  if (game == NULL) return;
+  game->simultaneous_moves = simultaneous_moves;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_game_concurrent_decisions(Game game, bool concurrent_decisions) {
+  if (game == NULL) return;
+  game->concurrent_decisions = concurrent_decisions;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_game_seed(Game game, uint64_t seed) {
+  if (game == NULL) return;
+
+  reset_strategy_context(game->attacker_context, seed_attacker_rng(seed));
+  reset_strategy_context(game->defender_context, seed_defender_rng(seed));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_game_strategy_parameters(Game game,
+                                  const double* attacker_parameters,
+                                  const double* defender_parameters) {
+  if (game == NULL) return;
+
+  set_strategy_parameters(game->attacker_context, attacker_parameters);
+  set_strategy_parameters(game->defender_context, defender_parameters);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_game_turn_budget(Game game,
+                          uint64_t turn_budget,
+                          enum turn_fallback fallback) {
+  if (game == NULL) return;
+
+  game->turn_budget = turn_budget;
+  game->turn_fallback = fallback;
+}
+
+/*----------------------------------------------------------------------------*/
+
+turn_timings_t get_game_attacker_timings(Game game) {
+  if (game == NULL) return (turn_timings_t) { 0 };
+  return game->attacker_turns.timings;
+}
+
+/*----------------------------------------------------------------------------*/
+
+turn_timings_t get_game_defender_timings(Game game) {
+  if (game == NULL) return (turn_timings_t) { 0 };
+  return game->defender_turns.timings;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Each player draws from its own stream, split from the game seed.
+// The first split is a copy of the game stream, so the attacker
+// takes it as is.
+rng_t seed_attacker_rng(uint64_t game_seed) {
+  return seed_rng(game_seed);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The defender takes the rest of the game stream, which is never
+// split again, so it does not pay for a second jump
+rng_t seed_defender_rng(uint64_t game_seed) {
+  rng_t game_rng = seed_rng(game_seed);
+  split_rng(&game_rng);
+  return game_rng;
+}
+
+/*----------------------------------------------------------------------------*/
+
 void play_game(Game game, size_t max_turns) {
   if (game == NULL) return;
 
   printf("Turn 0\n");
   print_game(game);
 
+  start_turn_timings(game);
+  start_strategy_limits(game, max_turns);
+  start_cycle_detection(game);
+  bool is_detecting_cycles = game->turn_budget == NO_TURN_BUDGET;
+
   for (size_t turn = 0; turn < max_turns; turn++) {
-    printf("Turn %ld\n", turn+1);
+    PROFILE_BEGIN(PROFILE_TURN);
+    TRACE_BEGIN(turn);
 
-    move_item(game->field,
-              game->attacker,
-              game->defender_spy,
-              game->execute_attacker_strategy);
+    printf("Turn %ld\n", turn+1);
 
-    move_item(game->field,
-              game->defender,
-              game->attacker_spy,
-              game->execute_defender_strategy);
+    play_turn(game);
 
+    PROFILE_BEGIN(PROFILE_RENDERING);
     print_game(game);
+    PROFILE_END(PROFILE_RENDERING);
 
-    if (has_spy_exceeded_max_number_uses(
-          game->defender_spy, game->max_number_spies)) {
-      printf("GAME OVER! Attacker cheated spying more than %ld %s!\n",
-             game->max_number_spies,
-             game->max_number_spies == 1UL ? "time" : "times");
-      return;
+    PROFILE_BEGIN(PROFILE_WIN_CHECKS);
+    enum game_end_reason outcome = check_turn_outcome(game);
+    if (outcome == GAME_CONTINUES && is_detecting_cycles) {
+      outcome = check_turn_cycle(game, &is_detecting_cycles);
     }
+    PROFILE_END(PROFILE_WIN_CHECKS);
 
-    if (has_spy_exceeded_max_number_uses(
-          game->attacker_spy, game->max_number_spies)) {
-      printf("GAME OVER! Defender cheated spying more than %ld %s!\n",
-             game->max_number_spies,
-             game->max_number_spies == 1UL ? "time" : "times");
-      return;
-    }
+    TRACE_END(turn, "turn");
+    PROFILE_END(PROFILE_TURN);
 
-    if (has_attacker_arrived_end_field(game->field, game->attacker)) {
-      printf("GAME OVER! Attacker wins!\n");
-      return;
-    }
+    switch (outcome) {
+      case GAME_CONTINUES: break;
+
+      case ATTACKER_CHEATED:
+        printf("GAME OVER! Attacker cheated spying more than %ld %s!\n",
+               game->max_number_spies,
+               game->max_number_spies == 1UL ? "time" : "times");
+        return;
 
-    if (has_defender_captured_attacker(game->attacker, game->defender)) {
-      printf("GAME OVER! Defender wins!\n");
-      return;
+      case DEFENDER_CHEATED:
+        printf("GAME OVER! Defender cheated spying more than %ld %s!\n",
+               game->max_number_spies,
+               game->max_number_spies == 1UL ? "time" : "times");
+        return;
+
+      case ATTACKER_ARRIVED_END_FIELD:
+        printf("GAME OVER! Attacker wins!\n");
+        return;
+
+      case DEFENDER_CAPTURED_ATTACKER:
+        printf("GAME OVER! Defender wins!\n");
+        return;
+
+      case CYCLE_DETECTED:
+        printf("GAME OVER! Attacker and Defender draw, "
+               "the game repeats itself!\n");
+        return;
+
+      default: break;
     }
   }
 
@@ -219,6 +435,124 @@ void play_game(Game game, size_t max_turns) {
   printf("GAME OVER! Attacker and Defender draw!\n");
 }
 
+/*----------------------------------------------------------------------------*/
+
+// Same rules as play_game, without printing anything
+game_result_t run_game(Game game, size_t max_turns) {
+  game_result_t result = { GAME_CONTINUES, NO_WINNER, 0, 0, 0 };
+  if (game == NULL) return result;
+
+  start_turn_timings(game);
+  start_strategy_limits(game, max_turns);
+  start_cycle_detection(game);
+  bool is_detecting_cycles = game->turn_budget == NO_TURN_BUDGET;
+
+  while (result.end_reason == GAME_CONTINUES) {
+    if (result.number_turns == max_turns) {
+      result.end_reason = MAX_TURNS_REACHED;
+      break;
+    }
+
+    PROFILE_BEGIN(PROFILE_TURN);
+    TRACE_BEGIN(turn);
+
+    play_turn(game);
+    result.number_turns++;
+
+    PROFILE_BEGIN(PROFILE_WIN_CHECKS);
+    result.end_reason = check_turn_outcome(game);
+    if (result.end_reason == GAME_CONTINUES && is_detecting_cycles) {
+      result.end_reason = check_turn_cycle(game, &is_detecting_cycles);
+    }
+    PROFILE_END(PROFILE_WIN_CHECKS);
+
+    TRACE_END(turn, "turn");
+    PROFILE_END(PROFILE_TURN);
+  }
+
+  result.winner = winner_of_end_reason(result.end_reason);
+  result.attacker_spy_uses = get_spy_number_uses(game->defender_spy);
+  result.defender_spy_uses = get_spy_number_uses(game->attacker_spy);
+
+  return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+enum game_winner winner_of_end_reason(enum game_end_reason end_reason) {
+  switch (end_reason) {
+    case DEFENDER_CHEATED:
+    case ATTACKER_ARRIVED_END_FIELD:
+      return ATTACKER_WINNER;
+
+    case ATTACKER_CHEATED:
+    case DEFENDER_CAPTURED_ATTACKER:
+      return DEFENDER_WINNER;
+
+    default:
+      return NO_WINNER;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+dimension_t get_game_dimension(Game game) {
+  if (game == NULL) return (dimension_t) NULL_DIMENSION;
+  return get_field_dimension(game->field);
+}
+
+/*----------------------------------------------------------------------------*/
+
+position_t get_game_attacker_position(Game game) {
+  if (game == NULL) return (position_t) INVALID_POSITION;
+  return get_item_position(game->attacker);
+}
+
+/*----------------------------------------------------------------------------*/
+
+position_t get_game_defender_position(Game game) {
+  if (game == NULL) return (position_t) INVALID_POSITION;
+  return get_item_position(game->defender);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_game_obstacle(Game game, position_t position) {
+  if (game == NULL) return false;
+  return get_field_item(game->field, position) == game->obstacle;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Games do not keep their map, so it is written back from the layout
+Map copy_game_map(Game game) {
+  if (game == NULL) return NULL;
+
+  FILE* map_file = tmpfile();
+  if (map_file == NULL) {
+    fprintf(stderr, "ERROR: Temporary map file could not be created!\n");
+    return NULL;
+  }
+
+  dimension_t dimension = get_field_dimension(game->field);
+  fprintf(map_file, "%zu,%zu\n", dimension.height, dimension.width);
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
+      Item item = get_field_item(game->field, position);
+      fputc(item != NULL ? get_item_symbol(item) : '.', map_file);
+    }
+    fputc('\n', map_file);
+  }
+
+  rewind(map_file);
+  Map map = read_map(map_file);
+  fclose(map_file);
+
+  return map;
+}
+
 /*----------------------------------------------------------------------------*/
 /*                             PRIVATE FUNCTIONS                              */
 /*----------------------------------------------------------------------------*/
@@ -228,22 +562,40 @@ Game allocate_game(
     size_t max_number_spies,
     PlayerStrategy execute_attacker_strategy,
     PlayerStrategy execute_defender_strategy) {
+  Field field = new_field(field_dimension);
+  if (field == NULL) return NULL;
+
   Game game = malloc(sizeof(*game));
 
-  game->field = new_field(field_dimension);
+  game->field = field;
 
   game->max_number_spies = max_number_spies;
+  game->simultaneous_moves = false;
+  game->concurrent_decisions = false;
+  game->helper = NULL;
 
   game->execute_attacker_strategy = execute_attacker_strategy;
   game->execute_defender_strategy = execute_defender_strategy;
 
+  game->attacker_context = new_strategy_context(seed_rng(DEFAULT_GAME_SEED));
+  game->defender_context = new_strategy_context(seed_rng(DEFAULT_GAME_SEED));
+
   game->attacker = new_item('A', true);
   game->defender = new_item('D', true);
   game->obstacle = new_item('X', false);
+  game->obstacles = NULL;
 
   game->attacker_spy = new_spy(game->attacker);
   game->defender_spy = new_spy(game->defender);
 
+  game->cycle_detector = new_cycle_detector();
+
+  game->turn_budget = NO_TURN_BUDGET;
+  game->turn_fallback = STAY_FALLBACK;
+  start_turn_timings(game);
+
+  set_game_seed(game, DEFAULT_GAME_SEED);
+
   return game;
 }
 
@@ -353,6 +705,27 @@ void set_obstacles_in_field(Field field, Item obstacle) {
 
 /*----------------------------------------------------------------------------*/
 
+// Once the field is set, so that strategies see the obstacles of the
+// game, including those of maps
+void set_strategy_layouts(Game game) {
+  dimension_t dimension = get_field_dimension(game->field);
+  game->obstacles = malloc(dimension.height * dimension.width
+                           * sizeof(*game->obstacles));
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
+      game->obstacles[i * dimension.width + j]
+        = get_field_item(game->field, position) == game->obstacle;
+    }
+  }
+
+  set_strategy_layout(game->attacker_context, dimension, game->obstacles);
+  set_strategy_layout(game->defender_context, dimension, game->obstacles);
+}
+
+/*----------------------------------------------------------------------------*/
+
 bool has_spy_exceeded_max_number_uses(Spy opponent_spy,
                                       size_t max_number_spies) {
   return get_spy_number_uses(opponent_spy) > max_number_spies;
@@ -382,16 +755,346 @@ bool has_attacker_arrived_end_field(Field field, Item attacker) {
 
 /*----------------------------------------------------------------------------*/
 
-void move_item(Field field,
-               Item item,
-               Spy opponent_spy,
-               PlayerStrategy execute_item_strategy) {
-  position_t item_position = get_item_position(item);
+enum game_end_reason check_turn_outcome(Game game) {
+  if (has_spy_exceeded_max_number_uses(
+        game->defender_spy, game->max_number_spies)) {
+    return ATTACKER_CHEATED;
+  }
+
+  if (has_spy_exceeded_max_number_uses(
+        game->attacker_spy, game->max_number_spies)) {
+    return DEFENDER_CHEATED;
+  }
+
+  if (has_attacker_arrived_end_field(game->field, game->attacker)) {
+    return ATTACKER_ARRIVED_END_FIELD;
+  }
+
+  if (has_defender_captured_attacker(game->attacker, game->defender)) {
+    return DEFENDER_CAPTURED_ATTACKER;
+  }
+
+  return GAME_CONTINUES;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Forgets the states of the previous game
+void start_cycle_detection(Game game) {
+  reset_cycle_detector(game->cycle_detector);
+  may_repeat_cycle_board(game->cycle_detector, hash_current_board(game));
+}
+
+/*----------------------------------------------------------------------------*/
+
+// A strategy may take a scratch in the middle of a game, after which
+// its states cannot be hashed anymore, so detection stops there
+enum game_end_reason check_turn_cycle(Game game, bool* is_detecting_cycles) {
+  uint64_t board_hash = hash_current_board(game);
+  if (!may_repeat_cycle_board(game->cycle_detector, board_hash)) {
+    return GAME_CONTINUES;
+  }
+
+  uint64_t state_hash = hash_game_state(
+      board_hash, game->attacker_context, game->defender_context);
+
+  if (state_hash == NO_STATE_HASH) {
+    *is_detecting_cycles = false;
+    return GAME_CONTINUES;
+  }
+
+  return repeats_cycle_state(game->cycle_detector, state_hash)
+    ? CYCLE_DETECTED
+    : GAME_CONTINUES;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t hash_current_board(Game game) {
+  return hash_game_board(get_item_position(game->attacker),
+                         get_item_position(game->defender),
+                         get_spy_number_uses(game->defender_spy),
+                         get_spy_number_uses(game->attacker_spy));
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Players start every game staying, as far as the fallback knows
+void start_turn_timings(Game game) {
+  game->attacker_turns = (struct player_turns) { DIR_STAY, { 0 } };
+  game->defender_turns = (struct player_turns) { DIR_STAY, { 0 } };
+}
+
+/*----------------------------------------------------------------------------*/
+
+void start_strategy_limits(Game game, size_t max_turns) {
+  set_strategy_limits(game->attacker_context, max_turns,
+                      game->max_number_spies);
+  set_strategy_limits(game->defender_context, max_turns,
+                      game->max_number_spies);
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct decision make_decision(Game game,
+                              Item item,
+                              Spy opponent_spy,
+                              PlayerStrategy execute_item_strategy,
+                              StrategyContext item_context,
+                              struct player_turns* item_turns) {
+  return (struct decision) {
+    .item_position = get_item_position(item),
+    .opponent_spy = opponent_spy,
+    .execute_item_strategy = execute_item_strategy,
+    .item_context = item_context,
+    .item_direction = DIR_STAY,
+    .turn_budget = game->turn_budget,
+    .turn_fallback = game->turn_fallback,
+    .item_turns = item_turns,
+  };
+}
+
+/*----------------------------------------------------------------------------*/
+
+void move_item(Field field, Item item, struct decision* decision) {
+  TRACE_BEGIN(move_item);
+
+  execute_decision(decision);
+  move_item_in_field(field, item, decision->item_direction);
+
+  TRACE_END(move_item, "move_item");
+}
+
+/*----------------------------------------------------------------------------*/
+
+void play_turn(Game game) {
+  if (game->simultaneous_moves) {
+    move_items_simultaneously(game);
+    return;
+  }
+
+  // The defender decides once the attacker has moved
+  struct decision attacker_decision = make_decision(
+      game, game->attacker, game->defender_spy,
+      game->execute_attacker_strategy, game->attacker_context,
+      &game->attacker_turns);
+  move_item(game->field, game->attacker, &attacker_decision);
+
+  struct decision defender_decision = make_decision(
+      game, game->defender, game->attacker_spy,
+      game->execute_defender_strategy, game->defender_context,
+      &game->defender_turns);
+  move_item(game->field, game->defender, &defender_decision);
+}
 
-  direction_t item_direction
-    = execute_item_strategy(item_position, opponent_spy);
+/*----------------------------------------------------------------------------*/
 
-  move_item_in_field(field, item, item_direction);
+void move_items_simultaneously(Game game) {
+  position_t attacker_position = get_item_position(game->attacker);
+  position_t defender_position = get_item_position(game->defender);
+
+  struct decision attacker_decision = make_decision(
+      game, game->attacker, game->defender_spy,
+      game->execute_attacker_strategy, game->attacker_context,
+      &game->attacker_turns);
+  struct decision defender_decision = make_decision(
+      game, game->defender, game->attacker_spy,
+      game->execute_defender_strategy, game->defender_context,
+      &game->defender_turns);
+
+  // Both strategies only read the field, which does not change until
+  // they have both decided, so the attacker may decide in the helper
+  // thread. Without a helper, they decide one after the other.
+  if (game->concurrent_decisions && game->helper == NULL) {
+    game->helper = start_decision_helper();
+    game->concurrent_decisions = game->helper != NULL;
+  }
+
+  if (game->concurrent_decisions) {
+    request_decision(game->helper, &attacker_decision);
+    execute_decision(&defender_decision);
+    await_decision(game->helper);
+  }
+  else {
+    execute_decision(&attacker_decision);
+    execute_decision(&defender_decision);
+  }
+
+  direction_t attacker_direction = attacker_decision.item_direction;
+  direction_t defender_direction = defender_decision.item_direction;
+
+  position_t attacker_target
+    = move_position(attacker_position, attacker_direction);
+  position_t defender_target
+    = move_position(defender_position, defender_direction);
+
+  // Same-cell conflict: nobody moves
+  if (equal_positions(attacker_target, defender_target)) return;
+
+  // Swap conflict: players cannot go through each other
+  if (equal_positions(attacker_target, defender_position)
+      && equal_positions(defender_target, attacker_position)) return;
+
+  // If the attacker follows the defender, the defender must vacate
+  // its cell first. Otherwise, the order of the moves does not matter.
+  if (equal_positions(attacker_target, defender_position)) {
+    move_item_in_field(game->field, game->defender, defender_direction);
+    move_item_in_field(game->field, game->attacker, attacker_direction);
+  }
+  else {
+    move_item_in_field(game->field, game->attacker, attacker_direction);
+    move_item_in_field(game->field, game->defender, defender_direction);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void* execute_decision(void* decision) {
+  struct decision* d = decision;
+
+  if (d->turn_budget != NO_TURN_BUDGET) {
+    decide_within_budget(d);
+    return NULL;
+  }
+
+  PROFILE_BEGIN(PROFILE_STRATEGY_DECISION);
+  TRACE_BEGIN(strategy);
+  d->item_direction = d->execute_item_strategy(
+      d->item_position, d->opponent_spy, d->item_context);
+  TRACE_END(strategy, "strategy");
+  PROFILE_END(PROFILE_STRATEGY_DECISION);
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Each player has its own turns, so decisions in different threads
+// record them without sharing anything
+void decide_within_budget(struct decision* d) {
+  struct player_turns* turns = d->item_turns;
+
+  // Budgets past the end of the clock never end
+  uint64_t start = read_monotonic_nanoseconds();
+  start_strategy_turn(d->item_context,
+                      d->turn_budget < NO_STRATEGY_DEADLINE - start
+                        ? start + d->turn_budget : NO_STRATEGY_DEADLINE);
+
+  PROFILE_BEGIN(PROFILE_STRATEGY_DECISION);
+  TRACE_BEGIN(strategy);
+  d->item_direction = d->execute_item_strategy(
+      d->item_position, d->opponent_spy, d->item_context);
+  TRACE_END(strategy, "strategy");
+  PROFILE_END(PROFILE_STRATEGY_DECISION);
+
+  uint64_t nanoseconds = read_monotonic_nanoseconds() - start;
+
+  turns->timings.number_decisions++;
+  turns->timings.total_nanoseconds += nanoseconds;
+  if (nanoseconds > turns->timings.max_nanoseconds) {
+    turns->timings.max_nanoseconds = nanoseconds;
+  }
+
+  if (nanoseconds > d->turn_budget) {
+    turns->timings.number_missed_deadlines++;
+
+    if (!get_strategy_offer(d->item_context, &d->item_direction)) {
+      turns->timings.number_fallbacks++;
+      d->item_direction = d->turn_fallback == LAST_DIRECTION_FALLBACK
+        ? turns->last_direction
+        : (direction_t) DIR_STAY;
+    }
+  }
+
+  start_strategy_turn(d->item_context, NO_STRATEGY_DEADLINE);
+  turns->last_direction = d->item_direction;
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct decision_helper* start_decision_helper() {
+  struct decision_helper* helper = malloc(sizeof(*helper));
+
+  pthread_mutex_init(&helper->mutex, NULL);
+  pthread_cond_init(&helper->requested, NULL);
+  pthread_cond_init(&helper->completed, NULL);
+  helper->decision = NULL;
+  helper->is_stopping = false;
+
+  if (pthread_create(&helper->thread, NULL,
+                     run_decision_helper, helper) != 0) {
+    pthread_cond_destroy(&helper->completed);
+    pthread_cond_destroy(&helper->requested);
+    pthread_mutex_destroy(&helper->mutex);
+    free(helper);
+    return NULL;
+  }
+
+  return helper;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void stop_decision_helper(struct decision_helper* helper) {
+  if (helper == NULL) return;
+
+  pthread_mutex_lock(&helper->mutex);
+  helper->is_stopping = true;
+  pthread_cond_signal(&helper->requested);
+  pthread_mutex_unlock(&helper->mutex);
+
+  pthread_join(helper->thread, NULL);
+
+  pthread_cond_destroy(&helper->completed);
+  pthread_cond_destroy(&helper->requested);
+  pthread_mutex_destroy(&helper->mutex);
+  free(helper);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void* run_decision_helper(void* helper) {
+  struct decision_helper* h = helper;
+
+  pthread_mutex_lock(&h->mutex);
+  for (;;) {
+    while (h->decision == NULL && !h->is_stopping) {
+      pthread_cond_wait(&h->requested, &h->mutex);
+    }
+    if (h->decision == NULL) break;
+
+    // The game waits for the decision, so it can be evaluated unlocked
+    struct decision* decision = h->decision;
+    pthread_mutex_unlock(&h->mutex);
+    execute_decision(decision);
+    pthread_mutex_lock(&h->mutex);
+
+    h->decision = NULL;
+    pthread_cond_signal(&h->completed);
+  }
+  pthread_mutex_unlock(&h->mutex);
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void request_decision(struct decision_helper* helper,
+                      struct decision* decision) {
+  pthread_mutex_lock(&helper->mutex);
+  helper->decision = decision;
+  pthread_cond_signal(&helper->requested);
+  pthread_mutex_unlock(&helper->mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void await_decision(struct decision_helper* helper) {
+  pthread_mutex_lock(&helper->mutex);
+  while (helper->decision != NULL) {
+    pthread_cond_wait(&helper->completed, &helper->mutex);
+  }
+  pthread_mutex_unlock(&helper->mutex);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -0,0 +1,133 @@
+// Standard headers
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Internal headers
+#include "game.h"
+#include "result_sink.h"
+#include "rng.h"
+#include "runner.h"
+
+// Main header
+#include "history.h"
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A turns history finds the games of a sweep in a result file, by their
+ * seeds, to expect the same number of turns from them.
+ */
+struct turns_history {
+  uint64_t map_id;
+  uint64_t attacker_player;
+  uint64_t defender_player;
+
+  size_t table_mask;
+  uint64_t* seeds; // Open addressing table of the seeds of the games...
+  size_t* games; // ...and of their indices, plus one (zero if empty)
+
+  uint32_t* expected_turns;
+  uint64_t number_turns; // Of all recorded games of the matchup
+  size_t number_recorded;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void add_history_block(size_t number_rows, uint64_t* const* columns,
+                              void* history);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+uint32_t* load_expected_turns(const char* history_path,
+                              const runner_config_t* config) {
+  if (history_path == NULL || config->number_games == 0) return NULL;
+
+  size_t table_size = 1;
+  while (table_size < 2 * config->number_games) table_size *= 2;
+
+  struct turns_history history = {
+    .map_id = config->map_id,
+    .attacker_player = config->attacker_player,
+    .defender_player = config->defender_player,
+    .table_mask = table_size - 1,
+    .seeds = malloc(table_size * sizeof(*history.seeds)),
+    .games = calloc(table_size, sizeof(*history.games)),
+    .expected_turns = calloc(config->number_games,
+                             sizeof(*history.expected_turns)),
+  };
+
+  // Seeds are already mixed, so their low bits are a good hash
+  for (size_t g = 0; g < config->number_games; g++) {
+    uint64_t seed = mix_seed(config->seed, g);
+
+    size_t slot = seed & history.table_mask;
+    while (history.games[slot] != 0) slot = (slot + 1) & history.table_mask;
+
+    history.seeds[slot] = seed;
+    history.games[slot] = g + 1;
+  }
+
+  scan_result_file(history_path, add_history_block, &history);
+
+  if (history.number_recorded > 0) {
+    uint32_t average_turns
+      = history.number_turns / history.number_recorded + 1;
+    for (size_t g = 0; g < config->number_games; g++) {
+      if (history.expected_turns[g] == 0) {
+        history.expected_turns[g] = average_turns;
+      }
+    }
+  }
+  else {
+    free(history.expected_turns);
+    history.expected_turns = NULL;
+  }
+
+  free(history.seeds);
+  free(history.games);
+
+  return history.expected_turns;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Games resolved on a drawn map were not played, so they tell nothing
+// about the length of games
+static void add_history_block(size_t number_rows, uint64_t* const* columns,
+                              void* history) {
+  struct turns_history* h = history;
+
+  for (size_t r = 0; r < number_rows; r++) {
+    if (columns[RESULT_MAP_ID][r] != h->map_id
+        || columns[RESULT_ATTACKER_STRATEGY][r] != h->attacker_player
+        || columns[RESULT_DEFENDER_STRATEGY][r] != h->defender_player
+      || columns[RESULT_END_REASON][r] == MAP_DRAWN) {
+      continue;
+    }
+
+    uint64_t turns = columns[RESULT_NUMBER_TURNS][r];
+    h->number_turns += turns;
+    h->number_recorded++;
+
+    // Turns are expected plus one, so zero marks games missing from it
+    uint64_t seed = columns[RESULT_SEED][r];
+    size_t slot = seed & h->table_mask;
+    while (h->games[slot] != 0) {
+      if (h->seeds[slot] == seed) {
+        h->expected_turns[h->games[slot] - 1]
+          = turns < UINT32_MAX ? turns + 1 : UINT32_MAX;
+        break;
+      }
+      slot = (slot + 1) & h->table_mask;
+    }
+  }
+}
@@ -1,57 +1,501 @@
 // Standard headers
 #include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 // Internal headers
 #include "attacker.h"
+#include "benchmark.h"
+#include "bot.h"
+#include "corpus.h"
 #include "defender.h"
 #include "dimension.h"
 #include "map.h"
+#include "map_analysis.h"
+#include "map_cache.h"
+#include "metrics.h"
+#include "evaluation.h"
 #include "game.h"
+#include "history.h"
+#include "random_walker.h"
+#include "ratings.h"
+#include "result_sink.h"
+#include "rng.h"
+#include "runner.h"
+#include "search.h"
+#include "searching_attacker.h"
+#include "team_game.h"
+#include "tracking_defender.h"
+#include "tuner.h"
 
 // Macros
 #define STANDARD_FIELD_DIMENSION (dimension_t) { 10, 10 }
 #define STANDARD_MAX_NUMBER_SPIES 1LU
 #define STANDARD_MAX_TURNS 42
+#define STANDINGS_REPORT_PERIOD 1.0 // Seconds
+#define CHECKPOINT_PERIOD 10.0 // Seconds
+
+#define EVALUATION_MIN_DIFFERENCE 0.02
+#define EVALUATION_ERROR_RATE 0.05
+#define EVALUATION_GAMES_PER_WORKER 256
+
+#define TUNER_GENERATIONS 40
+#define TUNER_INITIAL_STEP 0.3
+
+#define CORPUS_QUEUE_CAPACITY 64 // Files and maps in flight
+#define CORPUS_WORKERS_PER_PARSER 4
+
+#define SEARCH_BUDGET 1000 // Milliseconds
+#define SEARCH_TABLE_SIZE 64 // Megabytes
+
+#define BENCHMARK_SEED 0 // Unless given, so that runs time the same calls
+#define BENCHMARK_SAMPLES 101
+#define BENCHMARK_CALLS_PER_SAMPLE 1000
+
+/*----------------------------------------------------------------------------*/
+/*                              AUXILIARY STRUCTS                             */
+/*----------------------------------------------------------------------------*/
+
+struct options {
+  bool team_mode;
+  bool rating_mode;
+  bool evaluation_mode;
+  enum evaluated_side evaluated_side;
+  bool tuning_mode;
+  enum evaluated_side tuned_side;
+  size_t number_generations;
+  bool search_mode;
+  bool benchmark_mode;
+  bool is_seed_given;
+  uint64_t turn_budget; // In microseconds
+  enum turn_fallback turn_fallback;
+  enum search_player searching_player;
+  uint64_t search_budget; // In milliseconds
+  size_t search_table_size; // In megabytes
+  bool simultaneous_moves;
+  bool concurrent_decisions;
+  uint64_t seed;
+  size_t number_games; // If not zero, play a sweep without printing games
+  size_t number_workers;
+  bool batched;
+  const char* results_path; // If given, sweeps append their games to it
+  const char* attacker_bot; // If given, sweeps play with these bots
+  const char* defender_bot;
+  const char* history_path; // If given, longest games are played first
+  const char* cache_directory; // If given, map analyses are cached in it
+  const char* checkpoint_path; // If given, sweeps resume from it
+  const char* metrics_path; // If given, sweeps serve their metrics on it
+  Metrics metrics;
+  MapCache cache;
+};
+
+struct results_totals {
+  size_t number_games;
+  size_t number_resolved_games; // On a drawn map, so they were not played
+  size_t winners[NUMBER_GAME_WINNERS];
+  uint64_t number_turns;
+  uint64_t wall_nanoseconds;
+};
+
+struct named_strategy {
+  const char* name;
+  PlayerStrategy strategy;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                             AUXILIARY VARIABLES                            */
+/*----------------------------------------------------------------------------*/
+
+static const struct named_strategy attacker_strategies[] = {
+  { "scripted attacker", execute_attacker_strategy },
+  { "random attacker", execute_random_walker_strategy },
+  { "searching attacker", execute_searching_attacker_strategy },
+};
+
+static const struct named_strategy defender_strategies[] = {
+  { "scripted defender", execute_defender_strategy },
+  { "random defender", execute_random_walker_strategy },
+  { "tracking defender", execute_tracking_defender_strategy },
+};
 
 /*----------------------------------------------------------------------------*/
 /*                       AUXILIARY FUNCTIONS DECLARATION                      */
 /*----------------------------------------------------------------------------*/
 
-Game choose_game(int argc, char** argv);
+void print_usage(const char* program_name);
+bool parse_number(const char* text, uint64_t* number);
+
+Game choose_game(int number_arguments, char** arguments);
 Game make_standard_game();
 Game make_game_from_map(const char* map_path);
 
+int play_team_game_from_map(const char* map_path);
+int run_sweeps(struct options options, const char* map_path);
+int run_sweep(struct options options, const char* map_path);
+int run_corpus_sweep(struct options options, const char* map_directory);
+int run_rating_sweeps(struct options options, const char* map_path);
+int run_evaluation(struct options options, const char* map_path);
+int run_tuning(struct options options, const char* map_path);
+int run_search(struct options options, int number_arguments,
+               char** arguments);
+int run_benchmark(struct options options, int number_arguments,
+                  char** arguments);
+
+int summarize_results(const char* results_path);
+void add_results_block(size_t number_rows, uint64_t* const* columns,
+                       void* totals);
+
+void print_map_analysis(Map map, MapCache cache);
+const char* name_direction(direction_t direction);
+void print_turn_timings(const char* player, turn_timings_t timings);
+bool is_directory(const char* path);
+
 /*----------------------------------------------------------------------------*/
 /*                               MAIN FUNCTION                                */
 /*----------------------------------------------------------------------------*/
 
 int main(int argc, char** argv) {
-  if (argc >= 3) {
-    fprintf(stderr, "USAGE: %s [map_path]\n", argv[0]);
-    return EXIT_FAILURE;
+  struct options options = {
+    .team_mode = false,
+    .rating_mode = false,
+    .evaluation_mode = false,
+    .evaluated_side = DEFENDER_SIDE,
+    .tuning_mode = false,
+    .tuned_side = DEFENDER_SIDE,
+    .number_generations = TUNER_GENERATIONS,
+    .search_mode = false,
+    .benchmark_mode = false,
+    .is_seed_given = false,
+    .turn_budget = NO_TURN_BUDGET,
+    .turn_fallback = STAY_FALLBACK,
+    .searching_player = SEARCH_ATTACKER,
+    .search_budget = SEARCH_BUDGET,
+    .search_table_size = SEARCH_TABLE_SIZE,
+    .simultaneous_moves = false,
+    .concurrent_decisions = false,
+    .seed = (uint64_t) time(NULL),
+    .number_games = 0,
+    .number_workers = 1,
+    .batched = false,
+    .results_path = NULL,
+    .attacker_bot = NULL,
+    .defender_bot = NULL,
+    .history_path = NULL,
+    .cache_directory = NULL,
+  };
+
+  int option;
+  uint64_t number;
+  const char* option_letters = "tRE:T:G:F:w:H:Pu:f:SCs:n:j:bo:r:l:c:k:m:A:D:B:";
+  while ((option = getopt(argc, argv, option_letters)) != -1) {
+    switch (option) {
+      case 't': options.team_mode = true; break;
+      case 'R': options.rating_mode = true; break;
+
+      case 'E':
+        options.evaluation_mode = true;
+        if (optarg[0] == 'a' && optarg[1] == '\0')
+          options.evaluated_side = ATTACKER_SIDE;
+        else if (optarg[0] == 'd' && optarg[1] == '\0')
+          options.evaluated_side = DEFENDER_SIDE;
+        else
+          goto invalid_usage;
+        break;
+
+      case 'T':
+        options.tuning_mode = true;
+        if (optarg[0] == 'a' && optarg[1] == '\0')
+          options.tuned_side = ATTACKER_SIDE;
+        else if (optarg[0] == 'd' && optarg[1] == '\0')
+          options.tuned_side = DEFENDER_SIDE;
+        else
+          goto invalid_usage;
+        break;
+
+      case 'G':
+        if (!parse_number(optarg, &number) || number == 0) goto invalid_usage;
+        options.number_generations = number;
+        break;
+
+      case 'F':
+        options.search_mode = true;
+        if (optarg[0] == 'a' && optarg[1] == '\0')
+          options.searching_player = SEARCH_ATTACKER;
+        else if (optarg[0] == 'd' && optarg[1] == '\0')
+          options.searching_player = SEARCH_DEFENDER;
+        else
+          goto invalid_usage;
+        break;
+
+      case 'w':
+        if (!parse_number(optarg, &number) || number == 0) goto invalid_usage;
+        options.search_budget = number;
+        break;
+
+      case 'H':
+        if (!parse_number(optarg, &number) || number == 0) goto invalid_usage;
+        options.search_table_size = number;
+        break;
+
+      case 'P': options.benchmark_mode = true; break;
+
+      case 'u':
+        // Budgets are given in microseconds, and kept in nanoseconds
+        if (!parse_number(optarg, &number) || number == 0
+            || number > UINT64_MAX / 1000) {
+          goto invalid_usage;
+        }
+        options.turn_budget = number;
+        break;
+
+      case 'f':
+        if (optarg[0] == 's' && optarg[1] == '\0')
+          options.turn_fallback = STAY_FALLBACK;
+        else if (optarg[0] == 'l' && optarg[1] == '\0')
+          options.turn_fallback = LAST_DIRECTION_FALLBACK;
+        else
+          goto invalid_usage;
+        break;
+
+      case 'S': options.simultaneous_moves = true; break;
+      case 'C': options.concurrent_decisions = true; break;
+
+      case 's':
+        if (!parse_number(optarg, &options.seed)) goto invalid_usage;
+        options.is_seed_given = true;
+        break;
+
+      case 'n':
+        if (!parse_number(optarg, &number) || number == 0) goto invalid_usage;
+        options.number_games = number;
+        break;
+
+      case 'j':
+        if (!parse_number(optarg, &number) || number == 0) goto invalid_usage;
+        options.number_workers = number;
+        break;
+
+      case 'b': options.batched = true; break;
+      case 'o': options.results_path = optarg; break;
+      case 'r': return summarize_results(optarg);
+      case 'l': options.history_path = optarg; break;
+      case 'c': options.cache_directory = optarg; break;
+      case 'k': options.checkpoint_path = optarg; break;
+      case 'm': options.metrics_path = optarg; break;
+
+      case 'A': options.attacker_bot = optarg; break;
+      case 'D': options.defender_bot = optarg; break;
+
+      // Bots talk through the standard output, so nothing else is printed
+      case 'B':
+        if (optarg[0] == 'a' && optarg[1] == '\0') {
+          return serve_bot(attacker_strategies[0].strategy,
+                           STDIN_FILENO, STDOUT_FILENO);
+        }
+        if (optarg[0] == 'd' && optarg[1] == '\0') {
+          return serve_bot(defender_strategies[0].strategy,
+                           STDIN_FILENO, STDOUT_FILENO);
+        }
+        goto invalid_usage;
+
+      default: goto invalid_usage;
+    }
+  }
+
+  // Positional arguments, after all options
+  int number_arguments = argc - optind;
+  char** arguments = argv + optind;
+
+  if (number_arguments >= 2
+      || (options.team_mode && number_arguments != 1)
+      || (options.rating_mode && options.number_games == 0)
+      || (options.evaluation_mode && options.number_games == 0)
+      || (options.tuning_mode && options.number_games == 0)
+      || ((options.attacker_bot != NULL || options.defender_bot != NULL)
+          && (options.number_games == 0
+              || options.rating_mode || options.evaluation_mode
+              || options.tuning_mode))
+      || (options.metrics_path != NULL && options.number_games == 0)
+      || (options.cache_directory != NULL
+          && options.number_games == 0 && !options.search_mode)
+      || (options.search_mode
+          && (options.number_games > 0 || options.team_mode))
+      || (options.benchmark_mode
+          && (options.number_games > 0 || options.team_mode
+              || options.search_mode))
+      || (options.concurrent_decisions
+          && (!options.simultaneous_moves || options.batched
+              || options.attacker_bot != NULL || options.defender_bot != NULL
+              || options.team_mode || options.search_mode
+              || options.benchmark_mode))
+      || (options.turn_budget != NO_TURN_BUDGET
+          && (options.batched || options.team_mode
+              || options.attacker_bot != NULL || options.defender_bot != NULL
+              || options.tuning_mode || options.search_mode
+              || options.benchmark_mode))
+      || (options.checkpoint_path != NULL
+          && (options.number_games == 0
+              || options.turn_budget != NO_TURN_BUDGET
+              || options.rating_mode || options.evaluation_mode
+              || options.tuning_mode
+              || (number_arguments == 1 && is_directory(arguments[0]))))) {
+    goto invalid_usage;
   }
 
   printf("## RUGBY GAME ##\n\n");
 
-  Game game = choose_game(argc, argv);
+  if (options.team_mode) return play_team_game_from_map(arguments[0]);
+
+  if (options.benchmark_mode) {
+    return run_benchmark(options, number_arguments, arguments);
+  }
+
+  // Searches and sweeps open the cache once, for all of their maps
+  if (options.cache_directory != NULL) {
+    options.cache = new_map_cache(options.cache_directory);
+    if (options.cache == NULL) return EXIT_FAILURE;
+  }
+
+  if (options.search_mode) {
+    int status = run_search(options, number_arguments, arguments);
+
+    delete_map_cache(options.cache);
+    return status;
+  }
+
+  if (options.number_games > 0) {
+    if (options.metrics_path != NULL) {
+      options.metrics = new_metrics(options.metrics_path);
+      if (options.metrics == NULL) {
+        delete_map_cache(options.cache);
+        return EXIT_FAILURE;
+      }
+    }
+
+    int status
+      = run_sweeps(options, number_arguments == 1 ? arguments[0] : NULL);
+
+    delete_metrics(options.metrics);
+    delete_map_cache(options.cache);
+    return status;
+  }
+
+  printf("Seed: %lu\n\n", options.seed);
+
+  Game game = choose_game(number_arguments, arguments);
+  set_game_seed(game, options.seed);
+  set_game_simultaneous_moves(game, options.simultaneous_moves);
+  set_game_concurrent_decisions(game, options.concurrent_decisions);
+  set_game_turn_budget(game, options.turn_budget * 1000,
+                       options.turn_fallback);
   play_game(game, STANDARD_MAX_TURNS);
+
+  if (options.turn_budget != NO_TURN_BUDGET) {
+    putchar('\n');
+    print_turn_timings("Attacker", get_game_attacker_timings(game));
+    print_turn_timings("Defender", get_game_defender_timings(game));
+  }
+
   delete_game(game);
 
   return EXIT_SUCCESS;
+
+invalid_usage:
+  print_usage(argv[0]);
+  return EXIT_FAILURE;
 }
 
 /*----------------------------------------------------------------------------*/
 /*                             AUXILIARY FUNCTIONS                            */
 /*----------------------------------------------------------------------------*/
 
-Game choose_game(int argc, char** argv) {
-  switch (argc) {
-    case 1: return make_standard_game();
-    case 2: return make_game_from_map(argv[1]);
+// -S plays simultaneous moves instead of attacker first, then defender
+// -C lets the players of simultaneous moves decide concurrently, in a
+//    helper thread per game, which only pays off for slow strategies
+// -s sets the seed of the game (or of the sweep), for reproducible runs
+// -n plays a sweep of games without printing them, on -j workers, or
+//    a sweep for every map of a directory, in a pipeline (see corpus.h)
+// -b plays the sweep in lockstep batches of games, with the same results
+// -R rates all strategies, playing a sweep for every matchup
+// -E compares the two strategies of the attacker (a) or defender (d)
+//    side, stopping as soon as the difference is significant
+// -T tunes the parameters of the scripted attacker (a) or defender (d)
+//    over -G generations, scoring every candidate with -n games
+// -o appends every game of the sweeps to a columnar result file
+// -r summarizes a result file
+// -l plays first the games that lasted longest in a result file, when
+//    they were played with the same seeds, map and strategies
+// -c keeps the analyses of maps of sweeps and searches in a cache
+//    directory, across runs
+// -m serves live metrics of the sweeps on a Unix domain socket, in the
+//    Prometheus text format (see metrics.h)
+// -k saves the progress of a sweep to a checkpoint file, and resumes it
+//    from there when run again with the same options (see checkpoint.h),
+//    unless its games have a turn budget, as they depend on timings
+// -A and -D run the attacker or defender of a sweep as a bot, started
+//    by a shell command (see bot.h)
+// -B serves the scripted attacker (a) or defender (d) as a bot
+// -F searches the first move of the attacker (a) or defender (d) of the
+//    game, on -j threads, for -w milliseconds, with a table of -H
+//    megabytes (see search.h)
+// -u gives strategies that many microseconds to decide every move of a
+//    game, sweep, rating or evaluation, and -f replaces the moves decided
+//    too late, unless they offered one in time, by staying (s) or by
+//    their last move (l)
+// -P times the core primitives of the game, each on its own, with the
+//    inputs drawn from the seed (see benchmark.h)
+void print_usage(const char* program_name) {
+  fprintf(stderr, "USAGE: %s [-S [-C]] [-s seed] [-u microseconds] "
+                  "[-f s|l] [map_path]\n", program_name);
+  fprintf(stderr, "       %s [-R | -E a|d] -n number_games "
+                  "[-j number_workers] [-b] [-S [-C]] [-s seed] "
+                  "[-o results_path] [-l results_path] [-c cache_directory] "
+                  "[-m metrics_socket] [-u microseconds] [-f s|l] "
+                  "[map_path]\n",
+                  program_name);
+  fprintf(stderr, "       %s -T a|d -n number_games [-G number_generations] "
+                  "[-j number_workers] [-b] [-S] [-s seed] "
+                  "[-c cache_directory] [-m metrics_socket] [map_path]\n",
+                  program_name);
+  fprintf(stderr, "       %s -n number_games [-j number_workers] "
+                  "[-A attacker_command] [-D defender_command] [-S] "
+                  "[-s seed] [-o results_path] [-k checkpoint_path] "
+                  "[-c cache_directory] [-m metrics_socket] [map_path]\n",
+                  program_name);
+  fprintf(stderr, "       %s -n number_games [-j number_workers] [-b] [-S] "
+                  "[-s seed] [-o results_path] [-c cache_directory] "
+                  "[-m metrics_socket] map_directory\n",
+                  program_name);
+  fprintf(stderr, "       %s -F a|d [-j number_threads] [-w milliseconds] "
+                  "[-H megabytes] [-c cache_directory] [map_path]\n",
+                  program_name);
+  fprintf(stderr, "       %s -P [-s seed] [map_path]\n", program_name);
+  fprintf(stderr, "       %s -B a|d\n", program_name);
+  fprintf(stderr, "       %s -t team_map_path\n", program_name);
+  fprintf(stderr, "       %s -r results_path\n", program_name);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool parse_number(const char* text, uint64_t* number) {
+  char* end = NULL;
+  *number = strtoull(text, &end, 10);
+  return end != text && *end == '\0';
+}
+
+/*----------------------------------------------------------------------------*/
+
+Game choose_game(int number_arguments, char** arguments) {
+  switch (number_arguments) {
+    case 0: return make_standard_game();
+    case 1: return make_game_from_map(arguments[0]);
     default:
-      // argc should not be any other number
+      // number_arguments should not be any other number
       assert(false);
   }
 }
@@ -85,3 +529,552 @@ Game make_game_from_map(const char* map_path) {
 }
 
 /*----------------------------------------------------------------------------*/
+
+int play_team_game_from_map(const char* map_path) {
+  Map map = new_map(map_path);
+
+  TeamGame game = new_team_game_from_map(
+      map,
+      execute_attackers_team_strategy,
+      execute_defenders_team_strategy);
+
+  delete_map(map);
+
+  if (game == NULL) return EXIT_FAILURE;
+
+  play_team_game(game, STANDARD_MAX_TURNS);
+  delete_team_game(game);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Sweeps of all modes, which read their map from map_path, if any
+int run_sweeps(struct options options, const char* map_path) {
+  if (options.evaluation_mode) return run_evaluation(options, map_path);
+  if (options.tuning_mode) return run_tuning(options, map_path);
+  if (options.rating_mode) return run_rating_sweeps(options, map_path);
+
+  if (map_path != NULL && is_directory(map_path)) {
+    return run_corpus_sweep(options, map_path);
+  }
+
+  return run_sweep(options, map_path);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int run_sweep(struct options options, const char* map_path) {
+  Map map = NULL;
+  if (map_path != NULL) {
+    map = new_map(map_path);
+    if (map == NULL) return EXIT_FAILURE;
+  }
+
+  ResultSink results = NULL;
+  if (options.results_path != NULL) {
+    results = new_result_sink(options.results_path);
+    if (results == NULL) {
+      delete_map(map);
+      return EXIT_FAILURE;
+    }
+  }
+
+  size_t number_attackers
+    = sizeof(attacker_strategies) / sizeof(*attacker_strategies);
+
+  runner_config_t config = {
+    .map = map,
+    .field_dimension = STANDARD_FIELD_DIMENSION,
+    .max_number_spies = STANDARD_MAX_NUMBER_SPIES,
+    .max_turns = STANDARD_MAX_TURNS,
+    .simultaneous_moves = options.simultaneous_moves,
+    .concurrent_decisions = options.concurrent_decisions,
+    .attacker_strategy = execute_attacker_strategy,
+    .defender_strategy = execute_defender_strategy,
+    .turn_budget = options.turn_budget * 1000,
+    .turn_fallback = options.turn_fallback,
+    .number_games = options.number_games,
+    .number_workers = options.number_workers,
+    .seed = options.seed,
+    .batched = options.batched,
+    .attacker_bot = options.attacker_bot,
+    .defender_bot = options.defender_bot,
+    .attacker_player = 0,
+    .defender_player = number_attackers,
+    .results = results,
+    .map_id = hash_map(map),
+    .checkpoint_path = options.checkpoint_path,
+    .checkpoint_period = CHECKPOINT_PERIOD,
+    .metrics = options.metrics,
+    .cache = options.cache,
+  };
+
+  uint32_t* expected_turns
+    = load_expected_turns(options.history_path, &config);
+  config.expected_turns = expected_turns;
+
+  printf("Seed: %lu\n\n", options.seed);
+  print_map_analysis(map, options.cache);
+
+  runner_summary_t summary = run_games(config);
+  print_runner_summary(summary);
+
+  free(expected_turns);
+  delete_result_sink(results);
+  delete_map(map);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int run_corpus_sweep(struct options options, const char* map_directory) {
+  ResultSink results = NULL;
+  if (options.results_path != NULL) {
+    results = new_result_sink(options.results_path);
+    if (results == NULL) return EXIT_FAILURE;
+  }
+
+  size_t number_attackers
+    = sizeof(attacker_strategies) / sizeof(*attacker_strategies);
+
+  corpus_config_t config = {
+    .directory = map_directory,
+    .runner = {
+      .max_number_spies = STANDARD_MAX_NUMBER_SPIES,
+      .max_turns = STANDARD_MAX_TURNS,
+      .simultaneous_moves = options.simultaneous_moves,
+      .concurrent_decisions = options.concurrent_decisions,
+      .attacker_strategy = execute_attacker_strategy,
+      .defender_strategy = execute_defender_strategy,
+      .turn_budget = options.turn_budget * 1000,
+      .turn_fallback = options.turn_fallback,
+      .number_games = options.number_games,
+      .number_workers = options.number_workers,
+      .seed = options.seed,
+      .batched = options.batched,
+      .attacker_bot = options.attacker_bot,
+      .defender_bot = options.defender_bot,
+      .attacker_player = 0,
+      .defender_player = number_attackers,
+      .results = results,
+      .metrics = options.metrics,
+      .cache = options.cache,
+    },
+    .number_parsers = (options.number_workers + CORPUS_WORKERS_PER_PARSER - 1)
+                      / CORPUS_WORKERS_PER_PARSER,
+    .queue_capacity = CORPUS_QUEUE_CAPACITY,
+  };
+
+  printf("Seed: %lu\n\n", options.seed);
+
+  corpus_summary_t summary = run_corpus(config);
+  print_corpus_summary(summary);
+
+  delete_result_sink(results);
+
+  return summary.number_maps > summary.number_failed_maps
+    ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int run_rating_sweeps(struct options options, const char* map_path) {
+  Map map = NULL;
+  if (map_path != NULL) {
+    map = new_map(map_path);
+    if (map == NULL) return EXIT_FAILURE;
+  }
+
+  ResultSink results = NULL;
+  if (options.results_path != NULL) {
+    results = new_result_sink(options.results_path);
+    if (results == NULL) {
+      delete_map(map);
+      return EXIT_FAILURE;
+    }
+  }
+
+  size_t number_attackers
+    = sizeof(attacker_strategies) / sizeof(*attacker_strategies);
+  size_t number_defenders
+    = sizeof(defender_strategies) / sizeof(*defender_strategies);
+
+  // Attackers are the first players, followed by the defenders
+  Ratings ratings = new_ratings(number_attackers + number_defenders,
+                                options.number_workers);
+  for (size_t a = 0; a < number_attackers; a++) {
+    set_rating_player_name(ratings, a, attacker_strategies[a].name);
+  }
+  for (size_t d = 0; d < number_defenders; d++) {
+    set_rating_player_name(ratings, number_attackers + d,
+                           defender_strategies[d].name);
+  }
+
+  printf("Seed: %lu\n\n", options.seed);
+
+  for (size_t a = 0; a < number_attackers; a++) {
+    for (size_t d = 0; d < number_defenders; d++) {
+      runner_config_t config = {
+        .map = map,
+        .field_dimension = STANDARD_FIELD_DIMENSION,
+        .max_number_spies = STANDARD_MAX_NUMBER_SPIES,
+        .max_turns = STANDARD_MAX_TURNS,
+        .simultaneous_moves = options.simultaneous_moves,
+        .concurrent_decisions = options.concurrent_decisions,
+        .attacker_strategy = attacker_strategies[a].strategy,
+        .defender_strategy = defender_strategies[d].strategy,
+        .turn_budget = options.turn_budget * 1000,
+        .turn_fallback = options.turn_fallback,
+        .number_games = options.number_games,
+        .number_workers = options.number_workers,
+        .seed = mix_seed(options.seed, a * number_defenders + d),
+        .batched = options.batched,
+        .ratings = ratings,
+        .attacker_player = a,
+        .defender_player = number_attackers + d,
+        .report_period = STANDINGS_REPORT_PERIOD,
+        .results = results,
+        .map_id = hash_map(map),
+        .metrics = options.metrics,
+        .cache = options.cache,
+      };
+
+      uint32_t* expected_turns
+        = load_expected_turns(options.history_path, &config);
+      config.expected_turns = expected_turns;
+
+      printf("%s vs. %s\n", attacker_strategies[a].name,
+             defender_strategies[d].name);
+      run_games(config);
+
+      free(expected_turns);
+    }
+  }
+
+  printf("\n");
+  print_rating_standings(ratings);
+
+  delete_ratings(ratings);
+  delete_result_sink(results);
+  delete_map(map);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The first strategy of the evaluated side is the baseline,
+// and the second one is the candidate
+int run_evaluation(struct options options, const char* map_path) {
+  Map map = NULL;
+  if (map_path != NULL) {
+    map = new_map(map_path);
+    if (map == NULL) return EXIT_FAILURE;
+  }
+
+  ResultSink results = NULL;
+  if (options.results_path != NULL) {
+    results = new_result_sink(options.results_path);
+    if (results == NULL) {
+      delete_map(map);
+      return EXIT_FAILURE;
+    }
+  }
+
+  size_t number_attackers
+    = sizeof(attacker_strategies) / sizeof(*attacker_strategies);
+
+  const struct named_strategy* strategies
+    = options.evaluated_side == ATTACKER_SIDE
+      ? attacker_strategies : defender_strategies;
+  size_t first_player
+    = options.evaluated_side == ATTACKER_SIDE ? 0 : number_attackers;
+
+  evaluation_config_t config = {
+    .runner = {
+      .map = map,
+      .field_dimension = STANDARD_FIELD_DIMENSION,
+      .max_number_spies = STANDARD_MAX_NUMBER_SPIES,
+      .max_turns = STANDARD_MAX_TURNS,
+      .simultaneous_moves = options.simultaneous_moves,
+      .concurrent_decisions = options.concurrent_decisions,
+      .attacker_strategy = attacker_strategies[0].strategy,
+      .defender_strategy = defender_strategies[0].strategy,
+      .turn_budget = options.turn_budget * 1000,
+      .turn_fallback = options.turn_fallback,
+      .number_workers = options.number_workers,
+      .seed = options.seed,
+      .batched = options.batched,
+      .attacker_player = 0,
+      .defender_player = number_attackers,
+      .results = results,
+      .map_id = hash_map(map),
+      .metrics = options.metrics,
+      .cache = options.cache,
+    },
+    .side = options.evaluated_side,
+    .baseline_strategy = strategies[0].strategy,
+    .candidate_strategy = strategies[1].strategy,
+    .baseline_player = first_player,
+    .candidate_player = first_player + 1,
+    .min_difference = EVALUATION_MIN_DIFFERENCE,
+    .alpha = EVALUATION_ERROR_RATE,
+    .beta = EVALUATION_ERROR_RATE,
+    .batch_size = EVALUATION_GAMES_PER_WORKER * options.number_workers,
+    .max_games = options.number_games,
+  };
+
+  printf("Seed: %lu\n\n", options.seed);
+  printf("Baseline: %s\nCandidate: %s\n\n",
+         strategies[0].name, strategies[1].name);
+
+  print_evaluation_result(evaluate_strategies(config));
+
+  delete_result_sink(results);
+  delete_map(map);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The scripted strategies are tuned against each other
+int run_tuning(struct options options, const char* map_path) {
+  Map map = NULL;
+  if (map_path != NULL) {
+    map = new_map(map_path);
+    if (map == NULL) return EXIT_FAILURE;
+  }
+
+  const parameter_space_t* space = options.tuned_side == ATTACKER_SIDE
+    ? &attacker_parameter_space : &defender_parameter_space;
+
+  tuner_config_t config = {
+    .runner = {
+      .map = map,
+      .field_dimension = STANDARD_FIELD_DIMENSION,
+      .max_number_spies = STANDARD_MAX_NUMBER_SPIES,
+      .max_turns = STANDARD_MAX_TURNS,
+      .simultaneous_moves = options.simultaneous_moves,
+      .concurrent_decisions = options.concurrent_decisions,
+      .attacker_strategy = execute_attacker_strategy,
+      .defender_strategy = execute_defender_strategy,
+      .number_games = options.number_games,
+      .number_workers = options.number_workers,
+      .seed = options.seed,
+      .batched = options.batched,
+      .metrics = options.metrics,
+      .cache = options.cache,
+    },
+    .side = options.tuned_side,
+    .space = space,
+    .number_generations = options.number_generations,
+    .initial_step = TUNER_INITIAL_STEP,
+  };
+
+  printf("Seed: %lu\n\n", options.seed);
+
+  tuner_result_t result = tune_strategy(config);
+  printf("\n");
+  print_tuner_result(result, space);
+
+  delete_map(map);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The defender searches as if the attacker stayed in its first turn
+int run_search(struct options options, int number_arguments,
+               char** arguments) {
+  Game game = choose_game(number_arguments, arguments);
+  if (game == NULL) return EXIT_FAILURE;
+
+  Search search = new_search(game, options.cache,
+                             options.search_table_size << 20);
+  if (search == NULL) {
+    delete_game(game);
+    return EXIT_FAILURE;
+  }
+
+  printf("Searching: %s, %zu threads, %lu ms, %zu MB table\n\n",
+         options.searching_player == SEARCH_ATTACKER
+           ? "attacker" : "defender",
+         options.number_workers, options.search_budget,
+         options.search_table_size);
+
+  search_result_t result = search_best_move(
+      search,
+      get_game_attacker_position(game),
+      get_game_defender_position(game),
+      options.searching_player,
+      STANDARD_MAX_TURNS,
+      options.number_workers,
+      options.search_budget * 1000000);
+
+  double seconds = result.nanoseconds / 1e9;
+
+  printf("Best move: %s\n", name_direction(result.direction));
+  printf("Score: %d\n", result.score);
+  printf("Depth: %zu plies\n", result.depth);
+  printf("Threads: %zu\n", result.number_threads);
+  printf("Nodes: %lu (%.0f nodes/s)\n", result.number_nodes,
+         seconds > 0 ? result.number_nodes / seconds : 0);
+  printf("Time: %.3f s\n", seconds);
+
+  delete_search(search);
+  delete_game(game);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int run_benchmark(struct options options, int number_arguments,
+                  char** arguments) {
+  Game game = choose_game(number_arguments, arguments);
+  if (game == NULL) return EXIT_FAILURE;
+
+  benchmark_config_t config = {
+    .game = game,
+    .number_samples = BENCHMARK_SAMPLES,
+    .calls_per_sample = BENCHMARK_CALLS_PER_SAMPLE,
+    .seed = options.is_seed_given ? options.seed : BENCHMARK_SEED,
+  };
+
+  printf("Seed: %lu\n", config.seed);
+  printf("Samples: %zu of %zu calls\n\n",
+         config.number_samples, config.calls_per_sample);
+
+  benchmark_result_t results[NUMBER_BENCHMARKS];
+  run_benchmarks(config, results);
+  print_benchmark_results(results);
+
+  delete_game(game);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int summarize_results(const char* results_path) {
+  struct results_totals totals = { 0 };
+
+  scan_result_file(results_path, add_results_block, &totals);
+
+  size_t n = totals.number_games;
+  double percentage = n > 0 ? 100.0 / n : 0.0;
+
+  printf("Games: %ld\n", n);
+  printf("Attacker wins: %ld (%.1f%%)\n", totals.winners[ATTACKER_WINNER],
+         totals.winners[ATTACKER_WINNER] * percentage);
+  printf("Defender wins: %ld (%.1f%%)\n", totals.winners[DEFENDER_WINNER],
+         totals.winners[DEFENDER_WINNER] * percentage);
+  printf("Draws: %ld (%.1f%%)\n", totals.winners[NO_WINNER],
+         totals.winners[NO_WINNER] * percentage);
+
+  if (totals.number_resolved_games > 0) {
+    printf("  resolved on a drawn map: %ld\n", totals.number_resolved_games);
+  }
+
+  // Averages are of the played games only
+  size_t played = n - totals.number_resolved_games;
+  printf("Average turns: %.2f\n",
+         played > 0 ? (double) totals.number_turns / played : 0.0);
+  printf("Average game time: %.2f us\n",
+         played > 0 ? totals.wall_nanoseconds / 1e3 / played : 0.0);
+
+  return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void add_results_block(size_t number_rows, uint64_t* const* columns,
+                       void* totals) {
+  struct results_totals* t = totals;
+  t->number_games += number_rows;
+
+  for (size_t r = 0; r < number_rows; r++) {
+    if (columns[RESULT_WINNER][r] < NUMBER_GAME_WINNERS) {
+      t->winners[columns[RESULT_WINNER][r]]++;
+    }
+    if (columns[RESULT_END_REASON][r] == MAP_DRAWN) {
+      t->number_resolved_games++;
+      continue;
+    }
+
+    t->number_turns += columns[RESULT_NUMBER_TURNS][r];
+    t->wall_nanoseconds += columns[RESULT_WALL_NANOSECONDS][r];
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Analyses come from the cache if it has them, and are added to it if not
+void print_map_analysis(Map map, MapCache cache) {
+  if (map == NULL) return;
+
+  CachedAnalysis analysis
+    = load_map_analysis(cache, map, &goal_distances_analysis);
+
+  dimension_t dimension = get_map_dimension(map);
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
+      if (get_map_symbol(map, position) != 'A') continue;
+
+      uint32_t distance = get_goal_distance(
+          get_cached_analysis_data(analysis), dimension, position);
+      if (distance == GOAL_UNREACHABLE) printf("Goal: unreachable\n\n");
+      else printf("Goal: %u moves away\n\n", distance);
+    }
+  }
+
+  delete_cached_analysis(analysis);
+
+  CachedAnalysis components = load_map_analysis(cache, map,
+                                                &components_analysis);
+  if (is_map_drawn(map, get_cached_analysis_data(components))) {
+    printf("Outcome: drawn, games are not played\n\n");
+  }
+
+  delete_cached_analysis(components);
+}
+
+/*----------------------------------------------------------------------------*/
+
+const char* name_direction(direction_t direction) {
+  static const char* names[3][3] = {
+    { "up left", "up", "up right" },
+    { "left", "stay", "right" },
+    { "down left", "down", "down right" },
+  };
+
+  return names[direction.i + 1][direction.j + 1];
+}
+
+/*----------------------------------------------------------------------------*/
+
+void print_turn_timings(const char* player, turn_timings_t timings) {
+  double mean = timings.number_decisions > 0
+    ? (double) timings.total_nanoseconds / timings.number_decisions
+    : 0;
+
+  printf("%s decisions: %zu, %.0f ns on average, %lu ns at most\n",
+         player, timings.number_decisions, mean, timings.max_nanoseconds);
+  printf("%s missed deadlines: %zu (%zu fallbacks)\n",
+         player, timings.number_missed_deadlines, timings.number_fallbacks);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_directory(const char* path) {
+  struct stat status;
+  return stat(path, &status) == 0 && S_ISDIR(status.st_mode);
+}
+
+/*----------------------------------------------------------------------------*/
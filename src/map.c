@@ -1,14 +1,24 @@
 // Standard headers
 #include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 // Internal headers
 #include "dimension.h"
+#include "profiler.h"
+#include "tracer.h"
 
 // Main header
 #include "map.h"
 
+// Macros
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325UL
+#define FNV_PRIME 0x100000001B3UL
+#define OBSTACLE_SYMBOL 'X'
+#define FREE_SYMBOL '.'
+
 /*----------------------------------------------------------------------------*/
 /*                        PRIVATE STRUCT IMPLEMENTATION                       */
 /*----------------------------------------------------------------------------*/
@@ -30,6 +40,8 @@ void read_map_grid_from_map_file(char** grid,
 char** allocate_map_grid(dimension_t dimension);
 void free_map_grid(char** grid, dimension_t dimension);
 
+uint64_t hash_bytes(uint64_t hash, const void* bytes, size_t size);
+
 /*----------------------------------------------------------------------------*/
 /*                              PUBLIC FUNCTIONS                              */
 /*----------------------------------------------------------------------------*/
@@ -42,6 +54,22 @@ Map new_map(const char* map_path) {
     return NULL;
   }
 
+  Map map = read_map(map_file);
+
+  fclose(map_file);
+
+  return map;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Reads from the current position of an open file, which is kept open
+Map read_map(FILE* map_file) {
+  if (map_file == NULL) return NULL;
+
+  PROFILE_BEGIN(PROFILE_NEW_MAP);
+  TRACE_BEGIN(new_map);
+
   Map map = malloc(sizeof(*map));
 
   map->dimension = read_map_dimension_from_map_file(map_file);
@@ -49,7 +77,28 @@ Map new_map(const char* map_path) {
 
   read_map_grid_from_map_file(map->grid, map->dimension, map_file);
 
-  fclose(map_file);
+  TRACE_END(new_map, "new_map");
+  PROFILE_END(PROFILE_NEW_MAP);
+  return map;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Cells are free or obstacles, as players are not part of a layout
+Map new_map_from_layout(dimension_t dimension, const bool* obstacles) {
+  if (obstacles == NULL) return NULL;
+
+  Map map = malloc(sizeof(*map));
+
+  map->dimension = dimension;
+  map->grid = allocate_map_grid(map->dimension);
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      map->grid[i][j] = obstacles[i * dimension.width + j]
+        ? OBSTACLE_SYMBOL : FREE_SYMBOL;
+    }
+  }
 
   return map;
 }
@@ -83,6 +132,26 @@ void print_map(Map map) {
 
 /*----------------------------------------------------------------------------*/
 
+// Hashes the dimension and the grid with 64-bit FNV-1a, so equal maps
+// have the same hash wherever they were read from
+uint64_t hash_map(Map map) {
+  if (map == NULL) return 0;
+
+  uint64_t hash = FNV_OFFSET_BASIS;
+  hash = hash_bytes(hash, &map->dimension.height,
+                    sizeof(map->dimension.height));
+  hash = hash_bytes(hash, &map->dimension.width,
+                    sizeof(map->dimension.width));
+
+  for (size_t i = 0; i < map->dimension.height; i++) {
+    hash = hash_bytes(hash, map->grid[i], map->dimension.width);
+  }
+
+  return hash;
+}
+
+/*----------------------------------------------------------------------------*/
+
 dimension_t get_map_dimension(Map map) {
   if (map == NULL) return (dimension_t){ 0, 0 };
   return map->dimension;
@@ -188,3 +257,13 @@ void free_map_grid(char** grid, dimension_t dimension) {
 }
 
 /*----------------------------------------------------------------------------*/
+
+uint64_t hash_bytes(uint64_t hash, const void* bytes, size_t size) {
+  const unsigned char* b = bytes;
+  for (size_t k = 0; k < size; k++) {
+    hash = (hash ^ b[k]) * FNV_PRIME;
+  }
+  return hash;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,337 @@
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Internal headers
+#include "coordinate.h"
+#include "dimension.h"
+#include "direction.h"
+#include "map.h"
+#include "map_cache.h"
+#include "position.h"
+
+// Main header
+#include "map_analysis.h"
+
+// Macros
+#define OBSTACLE_SYMBOL 'X'
+#define ATTACKER_SYMBOL 'A'
+#define DEFENDER_SYMBOL 'D'
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static size_t get_goal_distances_size(Map map);
+static void compute_goal_distances(Map map, void* data);
+
+static size_t get_components_size(Map map);
+static void compute_components(Map map, void* data);
+static bool is_free_cell(Map map, size_t i, size_t j);
+static size_t find_root(size_t* parents, size_t cell);
+static void join_cells(size_t* parents, size_t cell, size_t other_cell);
+
+static bool find_single_symbol(Map map, char symbol, position_t* position);
+static bool can_component_reach_goal(const uint32_t* components,
+                                     dimension_t dimension,
+                                     uint32_t component);
+static bool can_components_capture(const uint32_t* components,
+                                   dimension_t dimension,
+                                   uint32_t attacker_component,
+                                   uint32_t defender_component);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC VARIABLES                              */
+/*----------------------------------------------------------------------------*/
+
+const map_analysis_t goal_distances_analysis = {
+  .name = "goal_distances",
+  .version = 1,
+  .get_size = get_goal_distances_size,
+  .compute = compute_goal_distances,
+};
+
+const map_analysis_t components_analysis = {
+  .name = "components",
+  .version = 1,
+  .get_size = get_components_size,
+  .compute = compute_components,
+};
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE VARIABLES                              */
+/*----------------------------------------------------------------------------*/
+
+static const direction_t neighbor_directions[] = {
+  DIR_UP, DIR_UP_RIGHT, DIR_RIGHT, DIR_DOWN_RIGHT,
+  DIR_DOWN, DIR_DOWN_LEFT, DIR_LEFT, DIR_UP_LEFT,
+};
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+uint32_t get_goal_distance(const uint32_t* distances,
+                           dimension_t dimension,
+                           position_t position) {
+  if (distances == NULL
+      || position.i >= dimension.height || position.j >= dimension.width) {
+    return GOAL_UNREACHABLE;
+  }
+
+  return distances[position.i * dimension.width + position.j];
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t get_component_label(const uint32_t* components,
+                             dimension_t dimension,
+                             position_t position) {
+  if (components == NULL
+      || position.i >= dimension.height || position.j >= dimension.width) {
+    return NO_COMPONENT;
+  }
+
+  return components[position.i * dimension.width + position.j];
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_map_drawn(Map map, const uint32_t* components) {
+  if (map == NULL || components == NULL) return false;
+
+  position_t attacker, defender;
+  if (!find_single_symbol(map, ATTACKER_SYMBOL, &attacker)
+      || !find_single_symbol(map, DEFENDER_SYMBOL, &defender)) return false;
+
+  dimension_t dimension = get_map_dimension(map);
+  uint32_t attacker_component
+    = get_component_label(components, dimension, attacker);
+  uint32_t defender_component
+    = get_component_label(components, dimension, defender);
+
+  return !can_component_reach_goal(components, dimension, attacker_component)
+         && !can_components_capture(components, dimension,
+                                    attacker_component, defender_component);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+size_t get_goal_distances_size(Map map) {
+  dimension_t dimension = get_map_dimension(map);
+  return dimension.height * dimension.width * sizeof(uint32_t);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Breadth-first search from all free cells of the goal column at once
+void compute_goal_distances(Map map, void* data) {
+  dimension_t dimension = get_map_dimension(map);
+  size_t number_cells = dimension.height * dimension.width;
+
+  uint32_t* distances = data;
+  for (size_t c = 0; c < number_cells; c++) distances[c] = GOAL_UNREACHABLE;
+
+  // Positions could not hold every cell with narrow coordinates
+  if (dimension.width < 2
+      || dimension.height > COORDINATE_MAX
+      || dimension.width > COORDINATE_MAX) return;
+
+  size_t* queue = malloc(number_cells * sizeof(*queue));
+  size_t queue_front = 0;
+  size_t queue_end = 0;
+
+  size_t goal_column = dimension.width - 2;
+  for (size_t i = 0; i < dimension.height; i++) {
+    position_t goal = { i, goal_column };
+    if (get_map_symbol(map, goal) == OBSTACLE_SYMBOL) continue;
+
+    distances[i * dimension.width + goal_column] = 0;
+    queue[queue_end++] = i * dimension.width + goal_column;
+  }
+
+  size_t number_directions
+    = sizeof(neighbor_directions) / sizeof(*neighbor_directions);
+
+  while (queue_front < queue_end) {
+    size_t cell = queue[queue_front++];
+    position_t position = { cell / dimension.width, cell % dimension.width };
+
+    for (size_t d = 0; d < number_directions; d++) {
+      // Moving beyond the first line or column wraps to huge values
+      position_t next = move_position(position, neighbor_directions[d]);
+      if (next.i >= dimension.height || next.j >= dimension.width) continue;
+
+      size_t next_cell = next.i * dimension.width + next.j;
+      if (distances[next_cell] != GOAL_UNREACHABLE) continue;
+      if (get_map_symbol(map, next) == OBSTACLE_SYMBOL) continue;
+
+      distances[next_cell] = distances[cell] + 1;
+      queue[queue_end++] = next_cell;
+    }
+  }
+
+  free(queue);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_components_size(Map map) {
+  dimension_t dimension = get_map_dimension(map);
+  return dimension.height * dimension.width * sizeof(uint32_t);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Two-pass labeling: the first pass joins every free cell to its free
+// neighbors already visited (left, and the three above), the second one
+// labels every cell after its root, which is the first cell of its
+// component, so roots are labeled before the rest of their components
+void compute_components(Map map, void* data) {
+  dimension_t dimension = get_map_dimension(map);
+  size_t number_cells = dimension.height * dimension.width;
+
+  uint32_t* labels = data;
+  size_t* parents = malloc(number_cells * sizeof(*parents));
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      size_t cell = i * dimension.width + j;
+      parents[cell] = cell;
+      if (!is_free_cell(map, i, j)) continue;
+
+      if (j > 0 && is_free_cell(map, i, j - 1)) {
+        join_cells(parents, cell, cell - 1);
+      }
+      if (i == 0) continue;
+
+      size_t first_j = j > 0 ? j - 1 : j;
+      size_t last_j = j + 1 < dimension.width ? j + 1 : j;
+      for (size_t nj = first_j; nj <= last_j; nj++) {
+        if (is_free_cell(map, i - 1, nj)) {
+          join_cells(parents, cell, (i - 1) * dimension.width + nj);
+        }
+      }
+    }
+  }
+
+  uint32_t number_components = 0;
+  for (size_t cell = 0; cell < number_cells; cell++) {
+    labels[cell] = NO_COMPONENT;
+    if (!is_free_cell(map, cell / dimension.width, cell % dimension.width)) {
+      continue;
+    }
+
+    size_t root = find_root(parents, cell);
+    labels[cell] = root == cell ? ++number_components : labels[root];
+  }
+
+  free(parents);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_free_cell(Map map, size_t i, size_t j) {
+  position_t position = { i, j };
+  return get_map_symbol(map, position) != OBSTACLE_SYMBOL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Halves the path to the root on the way
+size_t find_root(size_t* parents, size_t cell) {
+  while (parents[cell] != cell) {
+    parents[cell] = parents[parents[cell]];
+    cell = parents[cell];
+  }
+  return cell;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The root with the lowest index wins
+void join_cells(size_t* parents, size_t cell, size_t other_cell) {
+  size_t root = find_root(parents, cell);
+  size_t other_root = find_root(parents, other_cell);
+
+  if (root < other_root) parents[other_root] = root;
+  else parents[root] = other_root;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool find_single_symbol(Map map, char symbol, position_t* position) {
+  dimension_t dimension = get_map_dimension(map);
+
+  size_t number_found = 0;
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t current = { i, j };
+      if (get_map_symbol(map, current) != symbol) continue;
+
+      *position = current;
+      number_found++;
+    }
+  }
+
+  return number_found == 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool can_component_reach_goal(const uint32_t* components,
+                              dimension_t dimension,
+                              uint32_t component) {
+  if (component == NO_COMPONENT || dimension.width < 2) return false;
+
+  size_t goal_column = dimension.width - 2;
+  for (size_t i = 0; i < dimension.height; i++) {
+    if (components[i * dimension.width + goal_column] == component) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Captures compare the column of the defender with the line of the
+// attacker (see neighbor_positions), so components that never touch may
+// still capture, and every pair of cells on neighboring lines is checked
+bool can_components_capture(const uint32_t* components,
+                            dimension_t dimension,
+                            uint32_t attacker_component,
+                            uint32_t defender_component) {
+  if (attacker_component == defender_component) return true;
+
+  for (size_t ai = 0; ai < dimension.height; ai++) {
+    for (size_t aj = 0; aj < dimension.width; aj++) {
+      if (components[ai * dimension.width + aj] != attacker_component) {
+        continue;
+      }
+
+      size_t first_i = ai > 0 ? ai - 1 : 0;
+      size_t last_i = ai + 1 < dimension.height ? ai + 1 : ai;
+      for (size_t di = first_i; di <= last_i; di++) {
+        for (size_t dj = 0; dj < dimension.width; dj++) {
+          if (components[di * dimension.width + dj] != defender_component) {
+            continue;
+          }
+
+          position_t attacker = { ai, aj };
+          position_t defender = { di, dj };
+          if (neighbor_positions(attacker, defender)) return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,272 @@
+// Standard headers
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Internal headers
+#include "file_io.h"
+#include "map.h"
+
+// Main header
+#include "map_cache.h"
+
+// Macros
+#define MAP_CACHE_MAGIC "RUGBYMAC"
+#define MAP_CACHE_FORMAT_VERSION 2
+#define MAP_CACHE_HEADER_SIZE 48
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct map_cache {
+  char* directory;
+};
+
+struct cached_analysis {
+  unsigned char* file; // Header, grid and payload, mapped or allocated
+  size_t file_size;
+  size_t payload_offset;
+  bool is_mapped;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static char* make_cache_path(MapCache cache,
+                             uint64_t map_hash,
+                             const map_analysis_t* analysis);
+
+static CachedAnalysis map_cached_analysis(const char* path,
+                                          const unsigned char* prefix,
+                                          size_t prefix_size);
+static CachedAnalysis compute_analysis(Map map,
+                                       const map_analysis_t* analysis,
+                                       const unsigned char* prefix,
+                                       size_t prefix_size);
+
+static unsigned char* make_cache_prefix(Map map,
+                                        uint64_t map_hash,
+                                        const map_analysis_t* analysis,
+                                        size_t* prefix_size);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Creates the directory if it does not exist yet
+MapCache new_map_cache(const char* directory) {
+  if (directory == NULL) return NULL;
+
+  if (mkdir(directory, 0777) != 0 && errno != EEXIST) {
+    fprintf(stderr, "ERROR: Could not create directory %s\n", directory);
+    return NULL;
+  }
+
+  MapCache cache = malloc(sizeof(*cache));
+  cache->directory = strdup(directory);
+
+  return cache;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_map_cache(MapCache cache) {
+  if (cache == NULL) return;
+
+  free(cache->directory);
+  cache->directory = NULL;
+
+  free(cache);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Maps the analysis of the map from the cache, or computes it and
+// publishes it for the next processes. Processes racing to publish the
+// same file all write the same bytes, so the last rename wins harmlessly.
+CachedAnalysis load_map_analysis(MapCache cache,
+                                 Map map,
+                                 const map_analysis_t* analysis) {
+  if (map == NULL || analysis == NULL) return NULL;
+
+  uint64_t map_hash = hash_map(map);
+
+  size_t prefix_size;
+  unsigned char* prefix
+    = make_cache_prefix(map, map_hash, analysis, &prefix_size);
+
+  CachedAnalysis cached = NULL;
+  if (cache == NULL) {
+    cached = compute_analysis(map, analysis, prefix, prefix_size);
+  }
+  else {
+    char* path = make_cache_path(cache, map_hash, analysis);
+
+    cached = map_cached_analysis(path, prefix, prefix_size);
+    if (cached == NULL) {
+      cached = compute_analysis(map, analysis, prefix, prefix_size);
+      publish_file(path, cached->file, cached->file_size);
+    }
+
+    free(path);
+  }
+
+  free(prefix);
+
+  return cached;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_cached_analysis(CachedAnalysis analysis) {
+  if (analysis == NULL) return;
+
+  if (analysis->is_mapped) munmap(analysis->file, analysis->file_size);
+  else free(analysis->file);
+  analysis->file = NULL;
+
+  free(analysis);
+}
+
+/*----------------------------------------------------------------------------*/
+
+const void* get_cached_analysis_data(CachedAnalysis analysis) {
+  if (analysis == NULL) return NULL;
+  return analysis->file + analysis->payload_offset;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_cached_analysis_size(CachedAnalysis analysis) {
+  if (analysis == NULL) return 0;
+  return analysis->file_size - analysis->payload_offset;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+char* make_cache_path(MapCache cache,
+                      uint64_t map_hash,
+                      const map_analysis_t* analysis) {
+  const char* format = "%s/%016" PRIx64 "-%s-v%" PRIu32 ".bin";
+
+  int length = snprintf(NULL, 0, format, cache->directory, map_hash,
+                        analysis->name, analysis->version);
+
+  char* path = malloc(length + 1);
+  snprintf(path, length + 1, format, cache->directory, map_hash,
+           analysis->name, analysis->version);
+
+  return path;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Fails if the file is missing, or if its header, which also holds the
+// size of the payload, or its grid differ from the expected ones, so a
+// file of another map with the same hash is never used
+CachedAnalysis map_cached_analysis(const char* path,
+                                   const unsigned char* prefix,
+                                   size_t prefix_size) {
+  int descriptor = open(path, O_RDONLY);
+  if (descriptor < 0) return NULL;
+
+  struct stat status;
+  if (fstat(descriptor, &status) != 0
+      || (size_t) status.st_size < prefix_size) {
+    close(descriptor);
+    return NULL;
+  }
+
+  size_t size = status.st_size;
+  unsigned char* file = mmap(NULL, size, PROT_READ, MAP_SHARED,
+                             descriptor, 0);
+  close(descriptor);
+
+  if (file == MAP_FAILED) return NULL;
+
+  if (memcmp(file, prefix, prefix_size) != 0
+      || size != prefix_size + read_u64(prefix + 40)) {
+    munmap(file, size);
+    return NULL;
+  }
+
+  CachedAnalysis cached = malloc(sizeof(*cached));
+  cached->file = file;
+  cached->file_size = size;
+  cached->payload_offset = prefix_size;
+  cached->is_mapped = true;
+
+  return cached;
+}
+
+/*----------------------------------------------------------------------------*/
+
+CachedAnalysis compute_analysis(Map map,
+                                const map_analysis_t* analysis,
+                                const unsigned char* prefix,
+                                size_t prefix_size) {
+  size_t size = prefix_size + read_u64(prefix + 40);
+
+  CachedAnalysis cached = malloc(sizeof(*cached));
+  cached->file = calloc(size, 1);
+  cached->file_size = size;
+  cached->payload_offset = prefix_size;
+  cached->is_mapped = false;
+
+  memcpy(cached->file, prefix, prefix_size);
+  analysis->compute(map, cached->file + prefix_size);
+
+  return cached;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The prefix of a file is its header and the grid of its map, which
+// files are checked against. The payload is stored in the byte order of
+// the host, as analyses fill it with native integers.
+unsigned char* make_cache_prefix(Map map,
+                                 uint64_t map_hash,
+                                 const map_analysis_t* analysis,
+                                 size_t* prefix_size) {
+  dimension_t dimension = get_map_dimension(map);
+  size_t payload_size = analysis->get_size(map);
+  size_t grid_size = dimension.height * dimension.width;
+
+  // Grids and payloads are padded to whole words
+  payload_size = (payload_size + 7) / 8 * 8;
+  *prefix_size = MAP_CACHE_HEADER_SIZE + (grid_size + 7) / 8 * 8;
+
+  unsigned char* header = calloc(*prefix_size, 1);
+
+  memcpy(header, MAP_CACHE_MAGIC, 8);
+  write_u32(header + 8, MAP_CACHE_FORMAT_VERSION);
+  write_u32(header + 12, analysis->version);
+  write_u64(header + 16, map_hash);
+  write_u64(header + 24, dimension.height);
+  write_u64(header + 32, dimension.width);
+  write_u64(header + 40, payload_size);
+
+  unsigned char* grid = header + MAP_CACHE_HEADER_SIZE;
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      grid[i * dimension.width + j] = get_map_symbol(map, (position_t){ i, j });
+    }
+  }
+
+  return header;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,475 @@
+// Standard headers
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Internal headers
+#include "clock.h"
+#include "game.h"
+
+// Main header
+#include "metrics.h"
+
+// Macros
+#define CACHE_LINE_SIZE 64
+#define LISTEN_BACKLOG 8
+#define REQUEST_TIMEOUT 100 // Milliseconds to wait for an HTTP request
+#define SEND_TIMEOUT 1 // Seconds, so a stuck client cannot stall the server
+
+// Latency buckets are powers of 4, from 1 us to 262 ms, then +Inf
+#define NUMBER_BUCKETS 11
+#define FIRST_BUCKET_BOUND 1000 // Nanoseconds
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct metrics_counters {
+  atomic_uint_fast64_t number_games;
+  atomic_uint_fast64_t number_failed_games;
+  atomic_uint_fast64_t number_turns;
+  atomic_uint_fast64_t winners[NUMBER_GAME_WINNERS];
+  atomic_uint_fast64_t end_reasons[NUMBER_GAME_END_REASONS];
+
+  // Not cumulative, unlike the exposition format
+  atomic_uint_fast64_t buckets[NUMBER_METRICS_PHASES][NUMBER_BUCKETS];
+  atomic_uint_fast64_t nanoseconds[NUMBER_METRICS_PHASES];
+};
+
+/**
+ * A slot starts on its own cache line, and its size is a whole number
+ * of them, so no two slots ever share one.
+ */
+struct metrics_slot {
+  _Alignas(CACHE_LINE_SIZE) struct metrics_counters counters;
+
+  struct metrics_slot* next;
+  atomic_bool is_in_use;
+};
+
+struct metrics {
+  char* socket_path;
+  int listener;
+  int wake_pipe[2]; // Written to stop the server
+  pthread_t server;
+  uint64_t start; // In monotonic nanoseconds
+
+  _Atomic(struct metrics_slot*) slots;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+static const char* winner_labels[NUMBER_GAME_WINNERS] = {
+  [NO_WINNER]       = "none",
+  [ATTACKER_WINNER] = "attacker",
+  [DEFENDER_WINNER] = "defender",
+};
+
+static const char* end_reason_labels[NUMBER_GAME_END_REASONS] = {
+  [GAME_CONTINUES]             = "unfinished",
+  [ATTACKER_CHEATED]           = "attacker_cheated",
+  [DEFENDER_CHEATED]           = "defender_cheated",
+  [ATTACKER_ARRIVED_END_FIELD] = "attacker_arrived",
+  [DEFENDER_CAPTURED_ATTACKER] = "defender_captured",
+  [MAX_TURNS_REACHED]          = "max_turns_reached",
+  [CYCLE_DETECTED]             = "cycle_detected",
+  [MAP_DRAWN]                  = "map_drawn",
+};
+
+static const char* phase_labels[NUMBER_METRICS_PHASES] = {
+  [METRICS_SETUP]  = "setup",
+  [METRICS_PLAY]   = "play",
+  [METRICS_RECORD] = "record",
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static int listen_on_socket(const char* socket_path);
+static void* serve_metrics(void* metrics);
+static void serve_client(Metrics metrics, int client);
+static bool send_all(int client, const char* bytes, size_t size);
+
+static void sum_slots(Metrics metrics,
+                      struct metrics_counters* total,
+                      size_t* number_in_use);
+static void write_snapshot(Metrics metrics, FILE* stream);
+static void write_header(FILE* stream,
+                         const char* name,
+                         const char* type,
+                         const char* help);
+
+static void add_counter(atomic_uint_fast64_t* counter, uint64_t value);
+static size_t bucket_of(uint64_t nanoseconds);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Metrics new_metrics(const char* socket_path) {
+  if (socket_path == NULL) return NULL;
+
+  int listener = listen_on_socket(socket_path);
+  if (listener < 0) return NULL;
+
+  Metrics metrics = malloc(sizeof(*metrics));
+
+  metrics->socket_path = strdup(socket_path);
+  metrics->listener = listener;
+  metrics->start = read_monotonic_nanoseconds();
+  atomic_init(&metrics->slots, NULL);
+
+  if (pipe(metrics->wake_pipe) != 0
+      || pthread_create(&metrics->server, NULL, serve_metrics, metrics) != 0) {
+    fprintf(stderr, "ERROR: Could not start metrics server\n");
+    close(listener);
+    unlink(socket_path);
+    free(metrics->socket_path);
+    free(metrics);
+    return NULL;
+  }
+
+  return metrics;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// All slots must have been released
+void delete_metrics(Metrics metrics) {
+  if (metrics == NULL) return;
+
+  char wake = 0;
+  while (write(metrics->wake_pipe[1], &wake, 1) < 0 && errno == EINTR);
+  pthread_join(metrics->server, NULL);
+
+  close(metrics->wake_pipe[0]);
+  close(metrics->wake_pipe[1]);
+  close(metrics->listener);
+  unlink(metrics->socket_path);
+  free(metrics->socket_path);
+
+  struct metrics_slot* slot = atomic_load(&metrics->slots);
+  while (slot != NULL) {
+    struct metrics_slot* next = slot->next;
+    free(slot);
+    slot = next;
+  }
+
+  free(metrics);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Reuses the slot of a thread that released it, if any
+MetricsSlot acquire_metrics_slot(Metrics metrics) {
+  if (metrics == NULL) return NULL;
+
+  for (struct metrics_slot* s = atomic_load(&metrics->slots);
+       s != NULL; s = s->next) {
+    bool is_free = false;
+    if (atomic_compare_exchange_strong(&s->is_in_use, &is_free, true)) {
+      return s;
+    }
+  }
+
+  struct metrics_slot* slot
+    = aligned_alloc(CACHE_LINE_SIZE, sizeof(struct metrics_slot));
+  memset(slot, 0, sizeof(*slot));
+  atomic_init(&slot->is_in_use, true);
+
+  slot->next = atomic_load(&metrics->slots);
+  while (!atomic_compare_exchange_weak(&metrics->slots, &slot->next, slot));
+
+  return slot;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void release_metrics_slot(MetricsSlot slot) {
+  if (slot == NULL) return;
+  atomic_store(&slot->is_in_use, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void count_metrics_game(MetricsSlot slot, game_result_t result) {
+  if (slot == NULL) return;
+
+  struct metrics_counters* c = &slot->counters;
+  add_counter(&c->number_games, 1);
+  add_counter(&c->number_turns, result.number_turns);
+  add_counter(&c->winners[result.winner], 1);
+  add_counter(&c->end_reasons[result.end_reason], 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void count_metrics_failures(MetricsSlot slot, size_t number_games) {
+  if (slot == NULL) return;
+
+  add_counter(&slot->counters.number_games, number_games);
+  add_counter(&slot->counters.number_failed_games, number_games);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Phases shared by several games, as in batches, are observed as an
+// equal share of their latency for every game
+void observe_metrics_phase(MetricsSlot slot,
+                           enum metrics_phase phase,
+                           uint64_t nanoseconds,
+                           size_t number_games) {
+  if (slot == NULL || number_games == 0) return;
+
+  struct metrics_counters* c = &slot->counters;
+  add_counter(&c->buckets[phase][bucket_of(nanoseconds / number_games)],
+              number_games);
+  add_counter(&c->nanoseconds[phase], nanoseconds);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Replaces a socket left behind by a previous run, but no other file
+int listen_on_socket(const char* socket_path) {
+  struct sockaddr_un address = { .sun_family = AF_UNIX };
+  if (strlen(socket_path) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "ERROR: Socket path %s is too long\n", socket_path);
+    return -1;
+  }
+  strcpy(address.sun_path, socket_path);
+
+  struct stat status;
+  if (stat(socket_path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+    unlink(socket_path);
+  }
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0
+      || bind(listener, (struct sockaddr*) &address, sizeof(address)) != 0
+      || listen(listener, LISTEN_BACKLOG) != 0) {
+    fprintf(stderr, "ERROR: Could not listen on socket %s\n", socket_path);
+    if (listener >= 0) close(listener);
+    return -1;
+  }
+
+  return listener;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Serves one client at a time, until woken up by delete_metrics
+void* serve_metrics(void* metrics) {
+  Metrics m = metrics;
+
+  struct pollfd descriptors[] = {
+    { .fd = m->listener, .events = POLLIN },
+    { .fd = m->wake_pipe[0], .events = POLLIN },
+  };
+
+  while (true) {
+    if (poll(descriptors, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    if (descriptors[1].revents != 0) break;
+    if (!(descriptors[0].revents & POLLIN)) continue;
+
+    int client = accept(m->listener, NULL, NULL);
+    if (client < 0) continue;
+
+    serve_client(m, client);
+    close(client);
+  }
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Clients that send nothing within REQUEST_TIMEOUT get plain text
+void serve_client(Metrics metrics, int client) {
+  struct timeval timeout = { .tv_sec = SEND_TIMEOUT };
+  setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  char request[256] = { 0 };
+  struct pollfd descriptor = { .fd = client, .events = POLLIN };
+  if (poll(&descriptor, 1, REQUEST_TIMEOUT) > 0) {
+    ssize_t result = recv(client, request, sizeof(request) - 1, 0);
+    if (result < 0) return;
+  }
+
+  char* body = NULL;
+  size_t body_size = 0;
+  FILE* stream = open_memstream(&body, &body_size);
+  if (stream == NULL) return;
+
+  write_snapshot(metrics, stream);
+  fclose(stream);
+
+  bool is_sent = true;
+  if (strncmp(request, "GET ", 4) == 0) {
+    char header[128];
+    int header_size = snprintf(header, sizeof(header),
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: %zu\r\n\r\n", body_size);
+    is_sent = send_all(client, header, header_size);
+  }
+
+  if (is_sent) send_all(client, body, body_size);
+  free(body);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool send_all(int client, const char* bytes, size_t size) {
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t result = send(client, bytes + sent, size - sent, MSG_NOSIGNAL);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) return false;
+    sent += result;
+  }
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Counters may advance while they are summed, but every one of them is
+// read whole, and never goes back between snapshots
+void sum_slots(Metrics metrics,
+               struct metrics_counters* total,
+               size_t* number_in_use) {
+  atomic_uint_fast64_t* sums = (atomic_uint_fast64_t*) total;
+  size_t number_counters = sizeof(*total) / sizeof(*sums);
+  for (size_t c = 0; c < number_counters; c++) atomic_init(&sums[c], 0);
+  *number_in_use = 0;
+
+  for (struct metrics_slot* s = atomic_load(&metrics->slots);
+       s != NULL; s = s->next) {
+    const atomic_uint_fast64_t* counters
+      = (const atomic_uint_fast64_t*) &s->counters;
+    for (size_t c = 0; c < number_counters; c++) {
+      add_counter(&sums[c],
+                  atomic_load_explicit(&counters[c], memory_order_relaxed));
+    }
+    *number_in_use += atomic_load(&s->is_in_use);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void write_snapshot(Metrics metrics, FILE* stream) {
+  struct metrics_counters total;
+  size_t number_in_use;
+  sum_slots(metrics, &total, &number_in_use);
+
+  write_header(stream, "rugby_games_total", "counter",
+               "Games played, failed ones included.");
+  fprintf(stream, "rugby_games_total %lu\n", total.number_games);
+
+  write_header(stream, "rugby_failed_games_total", "counter",
+               "Games that could not be played.");
+  fprintf(stream, "rugby_failed_games_total %lu\n",
+          total.number_failed_games);
+
+  write_header(stream, "rugby_turns_total", "counter",
+               "Turns of all played games.");
+  fprintf(stream, "rugby_turns_total %lu\n", total.number_turns);
+
+  write_header(stream, "rugby_winners_total", "counter",
+               "Played games, by winner.");
+  for (size_t w = 0; w < NUMBER_GAME_WINNERS; w++) {
+    fprintf(stream, "rugby_winners_total{winner=\"%s\"} %lu\n",
+            winner_labels[w], total.winners[w]);
+  }
+
+  write_header(stream, "rugby_end_reasons_total", "counter",
+               "Played games, by the reason they ended.");
+  for (size_t r = 0; r < NUMBER_GAME_END_REASONS; r++) {
+    fprintf(stream, "rugby_end_reasons_total{reason=\"%s\"} %lu\n",
+            end_reason_labels[r], total.end_reasons[r]);
+  }
+
+  write_header(stream, "rugby_phase_seconds", "histogram",
+               "Latency of every phase of a game.");
+  for (size_t p = 0; p < NUMBER_METRICS_PHASES; p++) {
+    uint64_t count = 0;
+    uint64_t bound = FIRST_BUCKET_BOUND;
+    for (size_t b = 0; b < NUMBER_BUCKETS; b++, bound *= 4) {
+      count += total.buckets[p][b];
+      if (b + 1 < NUMBER_BUCKETS) {
+        fprintf(stream,
+                "rugby_phase_seconds_bucket{phase=\"%s\",le=\"%g\"} %lu\n",
+                phase_labels[p], bound * 1e-9, count);
+      } else {
+        fprintf(stream,
+                "rugby_phase_seconds_bucket{phase=\"%s\",le=\"+Inf\"} %lu\n",
+                phase_labels[p], count);
+      }
+    }
+    fprintf(stream, "rugby_phase_seconds_sum{phase=\"%s\"} %.9f\n",
+            phase_labels[p], total.nanoseconds[p] * 1e-9);
+    fprintf(stream, "rugby_phase_seconds_count{phase=\"%s\"} %lu\n",
+            phase_labels[p], count);
+  }
+
+  write_header(stream, "rugby_threads", "gauge",
+               "Threads currently counting games.");
+  fprintf(stream, "rugby_threads %zu\n", number_in_use);
+
+  write_header(stream, "rugby_uptime_seconds", "gauge",
+               "Time since the metrics were created.");
+  fprintf(stream, "rugby_uptime_seconds %.3f\n",
+          (read_monotonic_nanoseconds() - metrics->start) * 1e-9);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void write_header(FILE* stream,
+                  const char* name,
+                  const char* type,
+                  const char* help) {
+  fprintf(stream, "# HELP %s %s\n", name, help);
+  fprintf(stream, "# TYPE %s %s\n", name, type);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Only the thread of the slot writes to it, so no atomic read-modify-write
+// (and no locked instruction) is needed, only whole stores for readers
+void add_counter(atomic_uint_fast64_t* counter, uint64_t value) {
+  uint64_t current = atomic_load_explicit(counter, memory_order_relaxed);
+  atomic_store_explicit(counter, current + value, memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t bucket_of(uint64_t nanoseconds) {
+  size_t bucket = 0;
+  uint64_t bound = FIRST_BUCKET_BOUND;
+  while (bucket + 1 < NUMBER_BUCKETS && nanoseconds > bound) {
+    bucket++;
+    bound *= 4;
+  }
+  return bucket;
+}
+
+/*----------------------------------------------------------------------------*/
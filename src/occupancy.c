@@ -0,0 +1,199 @@
+// Standard headers
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Main header
+#include "occupancy.h"
+
+// Macros
+#define TILE_SHIFT 2 // Tiles of 4x4 cells
+#define TILE_SIDE (1UL << TILE_SHIFT)
+#define TILE_MASK (TILE_SIDE - 1)
+#define TILE_CELLS (TILE_SIDE * TILE_SIDE)
+
+#define OCCUPANT_INDEX_BITS (32 - OCCUPANT_TEAM_BITS)
+#define OCCUPANT_INDEX_MASK ((1UL << OCCUPANT_INDEX_BITS) - 1)
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct occupancy {
+  dimension_t dimension;
+  size_t tiles_per_line;
+  occupant_t* cells; // Tile by tile, each tile line by line
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static bool is_position_inside(Occupancy occupancy, position_t position);
+static size_t cell_offset(Occupancy occupancy, position_t position);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Occupancy new_occupancy(dimension_t dimension) {
+  size_t tiles_per_line = (dimension.width + TILE_MASK) >> TILE_SHIFT;
+  size_t tiles_per_column = (dimension.height + TILE_MASK) >> TILE_SHIFT;
+  size_t number_tiles = tiles_per_line * tiles_per_column;
+  if (number_tiles == 0) number_tiles = 1; // A whole tile, even if empty
+
+  // Tiles fill exactly one cache line, so they are aligned to it, and
+  // sizes are whole tiles, as aligned_alloc requires
+  size_t tile_size = TILE_CELLS * sizeof(occupant_t);
+  occupant_t* cells = aligned_alloc(tile_size, number_tiles * tile_size);
+  Occupancy occupancy = malloc(sizeof(*occupancy));
+
+  if (cells == NULL || occupancy == NULL) {
+    fprintf(stderr, "ERROR: Occupancy of %ld x %ld cells could not be "
+                    "allocated\n", dimension.height, dimension.width);
+    free(cells);
+    free(occupancy);
+    return NULL;
+  }
+
+  memset(cells, 0, number_tiles * tile_size);
+
+  occupancy->dimension = dimension;
+  occupancy->tiles_per_line = tiles_per_line;
+  occupancy->cells = cells;
+
+  return occupancy;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_occupancy(Occupancy occupancy) {
+  if (occupancy == NULL) return;
+
+  free(occupancy->cells);
+  occupancy->cells = NULL;
+
+  occupancy->dimension = (dimension_t) NULL_DIMENSION;
+
+  free(occupancy);
+}
+
+/*----------------------------------------------------------------------------*/
+
+dimension_t get_occupancy_dimension(Occupancy occupancy) {
+  if (occupancy == NULL) return (dimension_t) NULL_DIMENSION;
+  return occupancy->dimension;
+}
+
+/*----------------------------------------------------------------------------*/
+
+occupant_t make_occupant(unsigned team, size_t index) {
+  assert(team < (1U << OCCUPANT_TEAM_BITS));
+  assert(index <= OCCUPANT_MAX_INDEX);
+
+  // Index is shifted by one, so that no occupant equals NO_OCCUPANT
+  return ((occupant_t) team << OCCUPANT_INDEX_BITS) | (occupant_t) (index + 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned get_occupant_team(occupant_t occupant) {
+  return occupant >> OCCUPANT_INDEX_BITS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_occupant_index(occupant_t occupant) {
+  return (size_t) (occupant & OCCUPANT_INDEX_MASK) - 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+occupant_t get_occupant(Occupancy occupancy, position_t position) {
+  if (occupancy == NULL || !is_position_inside(occupancy, position))
+    return NO_OCCUPANT;
+
+  return occupancy->cells[cell_offset(occupancy, position)];
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_position_free(Occupancy occupancy, position_t position) {
+  if (occupancy == NULL || !is_position_inside(occupancy, position))
+    return false;
+
+  return occupancy->cells[cell_offset(occupancy, position)] == NO_OCCUPANT;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_occupant(Occupancy occupancy,
+                  position_t position,
+                  occupant_t occupant) {
+  if (occupancy == NULL || !is_position_inside(occupancy, position)) return;
+
+  occupancy->cells[cell_offset(occupancy, position)] = occupant;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void move_occupant(Occupancy occupancy, position_t from, position_t to) {
+  if (occupancy == NULL) return;
+
+  // Moves are only valid between cells inside the grid
+  assert(is_position_inside(occupancy, from));
+  assert(is_position_inside(occupancy, to));
+
+  occupant_t* cells = occupancy->cells;
+  cells[cell_offset(occupancy, to)] = cells[cell_offset(occupancy, from)];
+  cells[cell_offset(occupancy, from)] = NO_OCCUPANT;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool has_neighbor_from_team(Occupancy occupancy,
+                            position_t center,
+                            unsigned team) {
+  if (occupancy == NULL) return false;
+
+  for (int di = -1; di <= 1; di++) {
+    for (int dj = -1; dj <= 1; dj++) {
+      if (di == 0 && dj == 0) continue;
+
+      position_t neighbor = { center.i + di, center.j + dj };
+      occupant_t occupant = get_occupant(occupancy, neighbor);
+
+      if (occupant != NO_OCCUPANT && get_occupant_team(occupant) == team)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+bool is_position_inside(Occupancy occupancy, position_t position) {
+  // Negative moves wrap around and are also caught by these checks
+  return position.i < occupancy->dimension.height
+      && position.j < occupancy->dimension.width;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t cell_offset(Occupancy occupancy, position_t position) {
+  size_t tile = (position.i >> TILE_SHIFT) * occupancy->tiles_per_line
+              + (position.j >> TILE_SHIFT);
+
+  return tile * TILE_CELLS
+       + ((position.i & TILE_MASK) << TILE_SHIFT)
+       + (position.j & TILE_MASK);
+}
+
+/*----------------------------------------------------------------------------*/
@@ -2,6 +2,9 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+// Internal headers
+#include "coordinate.h"
+
 // Main header
 #include "position.h"
 
@@ -15,13 +18,18 @@ bool equal_positions(position_t p1, position_t p2) {
 
 /*----------------------------------------------------------------------------*/
 
+// Casts keep the bounds in coordinates, which wrap on narrow widths
+// just as size_t does
 bool neighbor_positions(position_t center, position_t candidate) {
-  return candidate.i >= center.i-1 && candidate.i <= center.i+1
-    && candidate.j >= center.i-1 && candidate.j <= center.j+1;
+  return candidate.i >= (coordinate_t) (center.i-1)
+    && candidate.i <= (coordinate_t) (center.i+1)
+    && candidate.j >= (coordinate_t) (center.i-1)
+    && candidate.j <= (coordinate_t) (center.j+1);
 }
 
 /*----------------------------------------------------------------------------*/
 
+// Moving beyond the first line or column wraps to COORDINATE_MAX
 position_t move_position(position_t current_position, direction_t direction) {
   position_t new_position = {
     current_position.i + direction.i,
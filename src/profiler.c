@@ -0,0 +1,258 @@
+// Standard headers
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Main header
+#include "profiler.h"
+
+// Macros
+#define PROFILE_FILE_VARIABLE "RUGBY_PROFILE_FILE"
+#define PROFILE_DEFAULT_FILE  "profile.json"
+
+// Histograms are log-linear, like HDR histograms: every power of two
+// is split in 16 sub-buckets, which keeps the relative error under 6%
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1UL << SUB_BUCKET_BITS)
+#define NUMBER_BUCKETS ((64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS)
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct profile_histogram {
+  uint64_t count;
+  uint64_t total;
+  uint64_t min;
+  uint64_t max;
+  uint64_t buckets[NUMBER_BUCKETS];
+};
+
+/**
+ * A profile block holds the histograms of one thread, so samples are
+ * recorded without any locks or atomics. Blocks are never freed: when
+ * a thread exits, its block is released to be reused by a new thread.
+ */
+struct profile_block {
+  struct profile_block* next;
+  atomic_bool is_in_use;
+  struct profile_histogram histograms[NUMBER_PROFILE_PHASES];
+};
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+static const char* phase_names[NUMBER_PROFILE_PHASES] = {
+  [PROFILE_NEW_MAP]            = "new_map",
+  [PROFILE_NEW_GAME_FROM_MAP]  = "new_game_from_map",
+  [PROFILE_TURN]               = "turn",
+  [PROFILE_STRATEGY_DECISION]  = "strategy_decision",
+  [PROFILE_MOVE_ITEM_IN_FIELD] = "move_item_in_field",
+  [PROFILE_WIN_CHECKS]         = "win_checks",
+  [PROFILE_RENDERING]          = "rendering",
+};
+
+static const double reported_percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+
+static _Atomic(struct profile_block*) blocks = NULL;
+static _Thread_local struct profile_block* thread_block = NULL;
+
+static pthread_once_t profiler_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_block_key;
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void initialize_profiler();
+static struct profile_block* acquire_profile_block();
+static void release_profile_block(void* block);
+
+static size_t bucket_of(uint64_t value);
+static uint64_t bucket_middle_value(size_t bucket);
+
+static void merge_histogram(struct profile_histogram* into,
+                            const struct profile_histogram* from);
+static uint64_t histogram_percentile(const struct profile_histogram* h,
+                                     double percentile);
+static void dump_profile();
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+void record_profile_sample(enum profile_phase phase, uint64_t nanoseconds) {
+  if (thread_block == NULL) thread_block = acquire_profile_block();
+
+  struct profile_histogram* h = &thread_block->histograms[phase];
+
+  h->count++;
+  h->total += nanoseconds;
+  if (nanoseconds < h->min) h->min = nanoseconds;
+  if (nanoseconds > h->max) h->max = nanoseconds;
+  h->buckets[bucket_of(nanoseconds)]++;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+void initialize_profiler() {
+  pthread_key_create(&thread_block_key, release_profile_block);
+  atexit(dump_profile);
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct profile_block* acquire_profile_block() {
+  pthread_once(&profiler_once, initialize_profiler);
+
+  struct profile_block* block = NULL;
+
+  // Reuse the block of a thread that has already exited, if any
+  for (struct profile_block* b = atomic_load(&blocks); b != NULL; b = b->next) {
+    bool is_free = false;
+    if (atomic_compare_exchange_strong(&b->is_in_use, &is_free, true)) {
+      block = b;
+      break;
+    }
+  }
+
+  if (block == NULL) {
+    block = calloc(1, sizeof(*block));
+    atomic_init(&block->is_in_use, true);
+    for (size_t p = 0; p < NUMBER_PROFILE_PHASES; p++) {
+      block->histograms[p].min = UINT64_MAX;
+    }
+
+    block->next = atomic_load(&blocks);
+    while (!atomic_compare_exchange_weak(&blocks, &block->next, block));
+  }
+
+  pthread_setspecific(thread_block_key, block);
+  return block;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void release_profile_block(void* block) {
+  struct profile_block* b = block;
+  atomic_store(&b->is_in_use, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t bucket_of(uint64_t value) {
+  if (value < SUB_BUCKETS) return value;
+
+  size_t exponent = 63 - __builtin_clzll(value);
+  size_t sub_bucket = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS-1);
+
+  return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t bucket_middle_value(size_t bucket) {
+  if (bucket < SUB_BUCKETS) return bucket;
+
+  size_t exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+  size_t sub_bucket = bucket % SUB_BUCKETS;
+  size_t width_bits = exponent - SUB_BUCKET_BITS;
+
+  uint64_t lowest = (SUB_BUCKETS + sub_bucket) << width_bits;
+  return lowest + ((1UL << width_bits) >> 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void merge_histogram(struct profile_histogram* into,
+                     const struct profile_histogram* from) {
+  into->count += from->count;
+  into->total += from->total;
+  if (from->min < into->min) into->min = from->min;
+  if (from->max > into->max) into->max = from->max;
+
+  for (size_t b = 0; b < NUMBER_BUCKETS; b++) {
+    into->buckets[b] += from->buckets[b];
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t histogram_percentile(const struct profile_histogram* h,
+                              double percentile) {
+  if (h->count == 0) return 0;
+
+  uint64_t rank = (uint64_t) (percentile / 100.0 * h->count);
+  if (rank >= h->count) rank = h->count - 1;
+
+  uint64_t seen = 0;
+  for (size_t b = 0; b < NUMBER_BUCKETS; b++) {
+    seen += h->buckets[b];
+    if (seen > rank) {
+      uint64_t value = bucket_middle_value(b);
+      // Bucket approximations never go beyond the exact extremes
+      if (value < h->min) return h->min;
+      if (value > h->max) return h->max;
+      return value;
+    }
+  }
+
+  return h->max;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Runs at exit, when all threads other than the main one are joined
+void dump_profile() {
+  const char* path = getenv(PROFILE_FILE_VARIABLE);
+  if (path == NULL) path = PROFILE_DEFAULT_FILE;
+
+  FILE* file = fopen(path, "w");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: Could not open file %s\n", path);
+    return;
+  }
+
+  struct profile_histogram* merged = calloc(1, sizeof(*merged));
+
+  fprintf(file, "{\n  \"unit\": \"ns\",\n  \"phases\": {");
+
+  for (size_t p = 0; p < NUMBER_PROFILE_PHASES; p++) {
+    *merged = (struct profile_histogram) { .min = UINT64_MAX };
+
+    for (struct profile_block* b = atomic_load(&blocks); b != NULL; b = b->next) {
+      merge_histogram(merged, &b->histograms[p]);
+    }
+
+    fprintf(file, "%s\n    \"%s\": {", p == 0 ? "" : ",", phase_names[p]);
+    fprintf(file, " \"count\": %lu, \"total\": %lu",
+            merged->count, merged->total);
+
+    if (merged->count > 0) {
+      fprintf(file, ", \"min\": %lu, \"mean\": %lu, \"max\": %lu",
+              merged->min, merged->total / merged->count, merged->max);
+
+      size_t number_percentiles
+        = sizeof(reported_percentiles) / sizeof(*reported_percentiles);
+      for (size_t q = 0; q < number_percentiles; q++) {
+        fprintf(file, ", \"p%g\": %lu", reported_percentiles[q],
+                histogram_percentile(merged, reported_percentiles[q]));
+      }
+    }
+
+    fprintf(file, " }");
+  }
+
+  fprintf(file, "\n  }\n}\n");
+
+  free(merged);
+  fclose(file);
+}
+
+/*----------------------------------------------------------------------------*/
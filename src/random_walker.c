@@ -0,0 +1,39 @@
+// Standard headers
+#include <stdlib.h>
+
+// Internal headers
+#include "direction.h"
+#include "position.h"
+#include "rng.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Main header
+#include "random_walker.h"
+
+// Macros
+#define UNUSED(x) (void)(x) // Auxiliary to avoid error of unused parameter
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+static const direction_t directions[] = {
+  DIR_UP, DIR_UP_RIGHT, DIR_RIGHT, DIR_DOWN_RIGHT,
+  DIR_DOWN, DIR_DOWN_LEFT, DIR_LEFT, DIR_UP_LEFT
+};
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+direction_t execute_random_walker_strategy(
+    position_t position, Spy opponent_spy, StrategyContext context) {
+  UNUSED(position);
+  UNUSED(opponent_spy);
+
+  size_t number_directions = sizeof(directions) / sizeof(*directions);
+  return directions[random_below(get_strategy_rng(context), number_directions)];
+}
+
+/*----------------------------------------------------------------------------*/
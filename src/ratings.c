@@ -0,0 +1,272 @@
+// Standard headers
+#include <math.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include "game.h"
+
+// Main header
+#include "ratings.h"
+
+// Macros
+#define CACHE_LINE_SIZE 64
+#define NUMBER_OUTCOMES 3 // Attacker wins, draw, defender wins
+
+#define RATING_ITERATIONS 200
+#define ELO_PER_NATURAL_UNIT (400.0 / M_LN10)
+#define CONFIDENCE_95_Z 1.96
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct ratings {
+  size_t number_players;
+  size_t number_slots;
+  size_t slot_stride; // Counters per slot, padded to whole cache lines
+
+  // Outcomes of each matchup, by slot, attacker, defender and outcome
+  atomic_ulong* counters;
+
+  char** names;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static size_t outcome_of_winner(enum game_winner winner);
+static void sum_matchups(Ratings ratings, double* games, double* scores);
+static int compare_ratings(const void* r1, const void* r2);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Ratings new_ratings(size_t number_players, size_t number_slots) {
+  Ratings ratings = malloc(sizeof(*ratings));
+
+  size_t counters_per_slot = number_players * number_players * NUMBER_OUTCOMES;
+  size_t counters_per_line = CACHE_LINE_SIZE / sizeof(atomic_ulong);
+
+  ratings->number_players = number_players;
+  ratings->number_slots = number_slots > 0 ? number_slots : 1;
+  ratings->slot_stride = (counters_per_slot + counters_per_line - 1)
+                       / counters_per_line * counters_per_line;
+
+  // Slots never share a cache line, so workers never contend
+  size_t number_counters = ratings->number_slots * ratings->slot_stride;
+  ratings->counters = aligned_alloc(
+      CACHE_LINE_SIZE, number_counters * sizeof(*ratings->counters));
+  for (size_t c = 0; c < number_counters; c++) {
+    atomic_init(&ratings->counters[c], 0);
+  }
+
+  ratings->names = calloc(number_players, sizeof(*ratings->names));
+
+  return ratings;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_ratings(Ratings ratings) {
+  if (ratings == NULL) return;
+
+  for (size_t p = 0; p < ratings->number_players; p++) {
+    free(ratings->names[p]);
+  }
+  free(ratings->names);
+  ratings->names = NULL;
+
+  free(ratings->counters);
+  ratings->counters = NULL;
+
+  free(ratings);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_ratings_number_players(Ratings ratings) {
+  if (ratings == NULL) return 0;
+  return ratings->number_players;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_rating_player_name(Ratings ratings, size_t player, const char* name) {
+  if (ratings == NULL || player >= ratings->number_players) return;
+
+  free(ratings->names[player]);
+  ratings->names[player] = strdup(name);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Each slot must be written by a single thread at a time
+void record_rating_outcome(Ratings ratings,
+                           size_t slot,
+                           size_t attacker_player,
+                           size_t defender_player,
+                           enum game_winner winner) {
+  if (ratings == NULL) return;
+
+  size_t number_players = ratings->number_players;
+  if (attacker_player >= number_players) return;
+  if (defender_player >= number_players) return;
+
+  size_t counter = (slot % ratings->number_slots) * ratings->slot_stride
+                 + (attacker_player * number_players + defender_player)
+                   * NUMBER_OUTCOMES
+                 + outcome_of_winner(winner);
+
+  atomic_fetch_add_explicit(&ratings->counters[counter], 1,
+                            memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Fits a Bradley-Terry model (the model behind Elo) to all matchups,
+// counting draws as half a win. Every player also gets one virtual draw
+// against a player rated 0, which keeps ratings finite with few games.
+void compute_rating_standings(Ratings ratings, rating_t* standings) {
+  if (ratings == NULL || standings == NULL) return;
+
+  size_t n = ratings->number_players;
+  double* games = calloc(n * n, sizeof(*games));
+  double* scores = calloc(n * n, sizeof(*scores));
+  double* strengths = malloc(n * sizeof(*strengths));
+  double* next_strengths = malloc(n * sizeof(*next_strengths));
+
+  sum_matchups(ratings, games, scores);
+
+  for (size_t p = 0; p < n; p++) strengths[p] = 1.0;
+
+  // Minorization-maximization iterations (Hunter, 2004)
+  for (size_t iteration = 0; iteration < RATING_ITERATIONS; iteration++) {
+    for (size_t p = 0; p < n; p++) {
+      double total_score = 0.5;
+      double denominator = 1.0 / (strengths[p] + 1.0);
+
+      for (size_t q = 0; q < n; q++) {
+        if (games[p * n + q] == 0.0) continue;
+        total_score += scores[p * n + q];
+        denominator += games[p * n + q] / (strengths[p] + strengths[q]);
+      }
+
+      next_strengths[p] = total_score / denominator;
+    }
+
+    double* swap = strengths;
+    strengths = next_strengths;
+    next_strengths = swap;
+  }
+
+  for (size_t p = 0; p < n; p++) {
+    // Fisher information of the log-strength gives its standard error
+    double expected_virtual = strengths[p] / (strengths[p] + 1.0);
+    double information = expected_virtual * (1.0 - expected_virtual);
+    double number_games = 0.0;
+
+    for (size_t q = 0; q < n; q++) {
+      if (games[p * n + q] == 0.0) continue;
+      double expected = strengths[p] / (strengths[p] + strengths[q]);
+      information += games[p * n + q] * expected * (1.0 - expected);
+      number_games += games[p * n + q];
+    }
+
+    standings[p] = (rating_t) {
+      .player = p,
+      .elo = ELO_PER_NATURAL_UNIT * log(strengths[p]),
+      .confidence = CONFIDENCE_95_Z * ELO_PER_NATURAL_UNIT / sqrt(information),
+      .number_games = (size_t) number_games,
+    };
+  }
+
+  qsort(standings, n, sizeof(*standings), compare_ratings);
+
+  free(next_strengths);
+  free(strengths);
+  free(scores);
+  free(games);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void print_rating_standings(Ratings ratings) {
+  if (ratings == NULL) return;
+
+  size_t n = ratings->number_players;
+  rating_t* standings = malloc(n * sizeof(*standings));
+  compute_rating_standings(ratings, standings);
+
+  printf("%4s  %-24s %8s %8s %10s\n", "Rank", "Player", "Elo", "95% CI", "Games");
+  for (size_t r = 0; r < n; r++) {
+    const char* name = ratings->names[standings[r].player];
+    printf("%4ld  %-24s %8.1f %7.1f %10ld\n",
+           r + 1, name != NULL ? name : "?",
+           standings[r].elo, standings[r].confidence,
+           standings[r].number_games);
+  }
+  putchar('\n');
+
+  free(standings);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+size_t outcome_of_winner(enum game_winner winner) {
+  switch (winner) {
+    case ATTACKER_WINNER: return 0;
+    case DEFENDER_WINNER: return 2;
+    default: return 1;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Sums all slots into symmetric matrices of games and scores,
+// where scores[p][q] is the score of p against q
+void sum_matchups(Ratings ratings, double* games, double* scores) {
+  size_t n = ratings->number_players;
+
+  for (size_t slot = 0; slot < ratings->number_slots; slot++) {
+    atomic_ulong* counters = &ratings->counters[slot * ratings->slot_stride];
+
+    for (size_t a = 0; a < n; a++) {
+      for (size_t d = 0; d < n; d++) {
+        atomic_ulong* outcomes = &counters[(a * n + d) * NUMBER_OUTCOMES];
+        double attacker_wins = atomic_load_explicit(&outcomes[0],
+                                                    memory_order_relaxed);
+        double draws = atomic_load_explicit(&outcomes[1],
+                                            memory_order_relaxed);
+        double defender_wins = atomic_load_explicit(&outcomes[2],
+                                                    memory_order_relaxed);
+
+        // A player against itself tells nothing about its strength
+        if (a == d) continue;
+
+        double total = attacker_wins + draws + defender_wins;
+        games[a * n + d] += total;
+        games[d * n + a] += total;
+        scores[a * n + d] += attacker_wins + draws / 2;
+        scores[d * n + a] += defender_wins + draws / 2;
+      }
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+int compare_ratings(const void* r1, const void* r2) {
+  double elo1 = ((const rating_t*) r1)->elo;
+  double elo2 = ((const rating_t*) r2)->elo;
+  return (elo1 < elo2) - (elo1 > elo2);
+}
+
+/*----------------------------------------------------------------------------*/
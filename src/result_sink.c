@@ -0,0 +1,491 @@
+// Standard headers
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Internal headers
+#include "file_io.h"
+
+// Main header
+#include "result_sink.h"
+
+// Macros
+#define RESULT_FILE_MAGIC "RUGBYRES"
+#define RESULT_FILE_VERSION 1
+#define RESULT_BLOCK_MAGIC 0x4B434C42U // "BLCK", read little-endian
+
+#define FILE_HEADER_SIZE 16
+#define BLOCK_HEADER_SIZE 8
+#define COLUMN_HEADER_SIZE 8
+
+#define MAX_VARINT_SIZE 10
+#define MAX_COLUMN_SIZE (2 * MAX_VARINT_SIZE * RESULT_BLOCK_ROWS)
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+enum column_encoding {
+  PLAIN_ENCODING, // 8 bytes per value
+  DELTA_ENCODING, // Zigzag varint of the difference to the previous value
+  RUN_ENCODING,   // Varint value and varint length of every run
+  NUMBER_ENCODINGS
+};
+
+struct result_sink {
+  FILE* file;
+  pthread_mutex_t file_mutex;
+};
+
+struct result_buffer {
+  ResultSink sink;
+  size_t number_rows;
+  uint64_t columns[NUMBER_RESULT_COLUMNS][RESULT_BLOCK_ROWS];
+
+  // Scratch space to compress a block outside of the file lock
+  unsigned char* block;
+  unsigned char* scratch;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static size_t encode_column(enum column_encoding encoding,
+                            const uint64_t* values,
+                            size_t number_values,
+                            unsigned char* out);
+static bool decode_column(enum column_encoding encoding,
+                          const unsigned char* in,
+                          size_t size,
+                          uint64_t* values,
+                          size_t number_values);
+
+static size_t write_varint(unsigned char* out, uint64_t value);
+static size_t read_varint(const unsigned char* in, size_t size,
+                          uint64_t* value);
+
+static bool is_result_file_header(const unsigned char* header);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Appends to an existing result file of the same version and columns,
+// or creates it with a header
+ResultSink new_result_sink(const char* path) {
+  FILE* file = fopen(path, "a+b");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: Could not open file %s\n", path);
+    return NULL;
+  }
+
+  fseek(file, 0, SEEK_END);
+  if (ftell(file) > 0) {
+    unsigned char header[FILE_HEADER_SIZE];
+
+    rewind(file);
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)
+        || !is_result_file_header(header)) {
+      fprintf(stderr, "ERROR: File %s is not a result file of version %d "
+                      "with %d columns\n",
+              path, RESULT_FILE_VERSION, NUMBER_RESULT_COLUMNS);
+      fclose(file);
+      return NULL;
+    }
+
+    // Writes always append, but a read must be followed by a seek
+    fseek(file, 0, SEEK_END);
+  }
+  else {
+    unsigned char header[FILE_HEADER_SIZE];
+    memcpy(header, RESULT_FILE_MAGIC, 8);
+    write_u32(header + 8, RESULT_FILE_VERSION);
+    write_u32(header + 12, NUMBER_RESULT_COLUMNS);
+    fwrite(header, 1, sizeof(header), file);
+  }
+
+  ResultSink sink = malloc(sizeof(*sink));
+  sink->file = file;
+  pthread_mutex_init(&sink->file_mutex, NULL);
+
+  return sink;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// All buffers of the sink must be deleted before it
+void delete_result_sink(ResultSink sink) {
+  if (sink == NULL) return;
+
+  fclose(sink->file);
+  sink->file = NULL;
+
+  pthread_mutex_destroy(&sink->file_mutex);
+
+  free(sink);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Makes every block written so far durable, and returns the file size
+uint64_t sync_result_sink(ResultSink sink) {
+  if (sink == NULL) return 0;
+
+  pthread_mutex_lock(&sink->file_mutex);
+  fflush(sink->file);
+  fsync(fileno(sink->file));
+  long size = ftell(sink->file);
+  pthread_mutex_unlock(&sink->file_mutex);
+
+  return size > 0 ? (uint64_t) size : 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Drops the blocks written after the file had the given size, such as
+// those of games replayed from a checkpoint (see checkpoint.h)
+void truncate_result_sink(ResultSink sink, uint64_t size) {
+  if (sink == NULL) return;
+
+  pthread_mutex_lock(&sink->file_mutex);
+  fflush(sink->file);
+
+  long current_size = ftell(sink->file);
+  if (current_size > 0 && (uint64_t) current_size > size
+      && size >= FILE_HEADER_SIZE) {
+    if (ftruncate(fileno(sink->file), size) != 0) {
+      fprintf(stderr, "ERROR: Could not truncate result file\n");
+    }
+    fseek(sink->file, 0, SEEK_END);
+  }
+
+  pthread_mutex_unlock(&sink->file_mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+ResultBuffer new_result_buffer(ResultSink sink) {
+  if (sink == NULL) return NULL;
+
+  ResultBuffer buffer = malloc(sizeof(*buffer));
+  buffer->sink = sink;
+  buffer->number_rows = 0;
+  buffer->block = malloc(BLOCK_HEADER_SIZE
+                         + NUMBER_RESULT_COLUMNS
+                           * (COLUMN_HEADER_SIZE + MAX_COLUMN_SIZE));
+  buffer->scratch = malloc(MAX_COLUMN_SIZE);
+
+  return buffer;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_result_buffer(ResultBuffer buffer) {
+  if (buffer == NULL) return;
+
+  flush_result_buffer(buffer);
+
+  free(buffer->scratch);
+  buffer->scratch = NULL;
+
+  free(buffer->block);
+  buffer->block = NULL;
+
+  free(buffer);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void append_game_record(ResultBuffer buffer, const game_record_t* record) {
+  if (buffer == NULL) return;
+
+  for (size_t c = 0; c < NUMBER_RESULT_COLUMNS; c++) {
+    buffer->columns[c][buffer->number_rows] = record->values[c];
+  }
+
+  if (++buffer->number_rows == RESULT_BLOCK_ROWS) {
+    flush_result_buffer(buffer);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Compresses the buffered rows as a block, and only takes the lock
+// of the sink to append it to the file
+void flush_result_buffer(ResultBuffer buffer) {
+  if (buffer == NULL || buffer->number_rows == 0) return;
+
+  unsigned char* header = buffer->block;
+  unsigned char* payload = header + BLOCK_HEADER_SIZE
+                         + NUMBER_RESULT_COLUMNS * COLUMN_HEADER_SIZE;
+
+  write_u32(header, RESULT_BLOCK_MAGIC);
+  write_u32(header + 4, buffer->number_rows);
+
+  for (size_t c = 0; c < NUMBER_RESULT_COLUMNS; c++) {
+    enum column_encoding best = PLAIN_ENCODING;
+    size_t best_size = encode_column(PLAIN_ENCODING, buffer->columns[c],
+                                     buffer->number_rows, payload);
+
+    for (enum column_encoding e = DELTA_ENCODING; e < NUMBER_ENCODINGS; e++) {
+      size_t size = encode_column(e, buffer->columns[c],
+                                  buffer->number_rows, buffer->scratch);
+      if (size < best_size) {
+        best = e;
+        best_size = size;
+        memcpy(payload, buffer->scratch, size);
+      }
+    }
+
+    unsigned char* column_header = header + BLOCK_HEADER_SIZE
+                                 + c * COLUMN_HEADER_SIZE;
+    memset(column_header, 0, COLUMN_HEADER_SIZE);
+    column_header[0] = best;
+    write_u32(column_header + 4, best_size);
+
+    payload += best_size;
+  }
+
+  ResultSink sink = buffer->sink;
+  pthread_mutex_lock(&sink->file_mutex);
+  fwrite(buffer->block, 1, payload - buffer->block, sink->file);
+  fflush(sink->file);
+  pthread_mutex_unlock(&sink->file_mutex);
+
+  buffer->number_rows = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Maps the whole file and decodes it block by block, so scanning
+// takes memory for a single block whatever the size of the file.
+// Returns the number of rows read, stopping at the first corrupt block.
+size_t scan_result_file(const char* path,
+                        ResultBlockVisitor visit_block,
+                        void* data) {
+  int descriptor = open(path, O_RDONLY);
+  if (descriptor < 0) {
+    fprintf(stderr, "ERROR: Could not open file %s\n", path);
+    return 0;
+  }
+
+  struct stat status;
+  if (fstat(descriptor, &status) != 0
+      || (size_t) status.st_size < FILE_HEADER_SIZE) {
+    fprintf(stderr, "ERROR: File %s is not a result file\n", path);
+    close(descriptor);
+    return 0;
+  }
+
+  size_t size = status.st_size;
+  const unsigned char* file = mmap(NULL, size, PROT_READ, MAP_PRIVATE,
+                                   descriptor, 0);
+  close(descriptor);
+
+  if (file == MAP_FAILED) {
+    fprintf(stderr, "ERROR: Could not map file %s\n", path);
+    return 0;
+  }
+
+  madvise((void*) file, size, MADV_SEQUENTIAL);
+
+  if (size < FILE_HEADER_SIZE || !is_result_file_header(file)) {
+    fprintf(stderr, "ERROR: File %s is not a result file\n", path);
+    munmap((void*) file, size);
+    return 0;
+  }
+
+  uint64_t* values = malloc(NUMBER_RESULT_COLUMNS * RESULT_BLOCK_ROWS
+                            * sizeof(*values));
+  uint64_t* columns[NUMBER_RESULT_COLUMNS];
+  for (size_t c = 0; c < NUMBER_RESULT_COLUMNS; c++) {
+    columns[c] = values + c * RESULT_BLOCK_ROWS;
+  }
+
+  size_t number_rows = 0;
+  size_t offset = FILE_HEADER_SIZE;
+  size_t headers_size = BLOCK_HEADER_SIZE
+                      + NUMBER_RESULT_COLUMNS * COLUMN_HEADER_SIZE;
+
+  while (offset + headers_size <= size) {
+    const unsigned char* header = file + offset;
+    size_t block_rows = read_u32(header + 4);
+
+    if (read_u32(header) != RESULT_BLOCK_MAGIC
+        || block_rows == 0 || block_rows > RESULT_BLOCK_ROWS) break;
+
+    const unsigned char* payload = header + headers_size;
+    size_t payload_offset = offset + headers_size;
+    bool is_valid = true;
+
+    for (size_t c = 0; c < NUMBER_RESULT_COLUMNS && is_valid; c++) {
+      const unsigned char* column_header = header + BLOCK_HEADER_SIZE
+                                         + c * COLUMN_HEADER_SIZE;
+      size_t column_size = read_u32(column_header + 4);
+
+      is_valid = column_header[0] < NUMBER_ENCODINGS
+                 && payload_offset + column_size <= size
+                 && decode_column(column_header[0], payload, column_size,
+                                  columns[c], block_rows);
+
+      payload += column_size;
+      payload_offset += column_size;
+    }
+
+    if (!is_valid) break;
+
+    visit_block(block_rows, columns, data);
+
+    number_rows += block_rows;
+    offset = payload_offset;
+  }
+
+  if (offset != size) {
+    fprintf(stderr, "WARNING: File %s has a corrupt block at byte %ld\n",
+            path, offset);
+  }
+
+  free(values);
+  munmap((void*) file, size);
+
+  return number_rows;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+size_t encode_column(enum column_encoding encoding,
+                     const uint64_t* values,
+                     size_t number_values,
+                     unsigned char* out) {
+  size_t size = 0;
+  uint64_t previous = 0;
+
+  switch (encoding) {
+    case PLAIN_ENCODING:
+      for (size_t v = 0; v < number_values; v++, size += 8) {
+        write_u64(out + size, values[v]);
+      }
+      break;
+
+    case DELTA_ENCODING:
+      for (size_t v = 0; v < number_values; v++) {
+        int64_t delta = (int64_t) (values[v] - previous);
+        uint64_t zigzag = ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63);
+        size += write_varint(out + size, zigzag);
+        previous = values[v];
+      }
+      break;
+
+    case RUN_ENCODING:
+      for (size_t v = 0; v < number_values; ) {
+        size_t length = 1;
+        while (v + length < number_values && values[v + length] == values[v]) {
+          length++;
+        }
+        size += write_varint(out + size, values[v]);
+        size += write_varint(out + size, length);
+        v += length;
+      }
+      break;
+
+    default: break;
+  }
+
+  return size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool decode_column(enum column_encoding encoding,
+                   const unsigned char* in,
+                   size_t size,
+                   uint64_t* values,
+                   size_t number_values) {
+  size_t offset = 0;
+  uint64_t previous = 0;
+
+  switch (encoding) {
+    case PLAIN_ENCODING:
+      if (size != 8 * number_values) return false;
+      for (size_t v = 0; v < number_values; v++) {
+        values[v] = read_u64(in + 8 * v);
+      }
+      return true;
+
+    case DELTA_ENCODING:
+      for (size_t v = 0; v < number_values; v++) {
+        uint64_t zigzag;
+        size_t read = read_varint(in + offset, size - offset, &zigzag);
+        if (read == 0) return false;
+        offset += read;
+
+        previous += (zigzag >> 1) ^ -(zigzag & 1);
+        values[v] = previous;
+      }
+      return offset == size;
+
+    case RUN_ENCODING:
+      for (size_t v = 0; v < number_values; ) {
+        uint64_t value, length;
+        size_t read = read_varint(in + offset, size - offset, &value);
+        if (read == 0) return false;
+        offset += read;
+
+        read = read_varint(in + offset, size - offset, &length);
+        if (read == 0 || length == 0 || length > number_values - v) {
+          return false;
+        }
+        offset += read;
+
+        for (size_t end = v + length; v < end; v++) values[v] = value;
+      }
+      return offset == size;
+
+    default: return false;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t write_varint(unsigned char* out, uint64_t value) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    out[size++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  out[size++] = value;
+  return size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Returns the number of bytes read, or 0 if the varint is truncated
+size_t read_varint(const unsigned char* in, size_t size, uint64_t* value) {
+  *value = 0;
+  for (size_t k = 0; k < size && k < MAX_VARINT_SIZE; k++) {
+    *value |= (uint64_t) (in[k] & 0x7F) << (7 * k);
+    if ((in[k] & 0x80) == 0) return k + 1;
+  }
+  return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_result_file_header(const unsigned char* header) {
+  return memcmp(header, RESULT_FILE_MAGIC, 8) == 0
+         && read_u32(header + 8) == RESULT_FILE_VERSION
+         && read_u32(header + 12) == NUMBER_RESULT_COLUMNS;
+}
+
+/*----------------------------------------------------------------------------*/
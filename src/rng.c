@@ -0,0 +1,130 @@
+// Standard headers
+#include <stdbool.h>
+#include <stdint.h>
+
+// Main header
+#include "rng.h"
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static uint64_t rotate_left(uint64_t x, int k);
+static uint64_t next_splitmix(uint64_t* state);
+static void jump_rng(rng_t* rng);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+rng_t seed_rng(uint64_t seed) {
+  // The state of xoshiro must not be all zeros, which splitmix avoids
+  rng_t rng;
+  for (int w = 0; w < 4; w++) {
+    rng.state[w] = next_splitmix(&seed);
+  }
+
+  return rng;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Returns a copy of the generator, and jumps it 2^128 steps ahead,
+// so the copy and the generator never overlap
+rng_t split_rng(rng_t* rng) {
+  rng_t stream = *rng;
+  jump_rng(rng);
+  return stream;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t next_random(rng_t* rng) {
+  uint64_t* s = rng->state;
+  uint64_t result = rotate_left(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+
+  s[2] ^= t;
+  s[3] = rotate_left(s[3], 45);
+
+  return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Rejects the lowest values, so that every remainder is equally likely
+uint64_t random_below(rng_t* rng, uint64_t bound) {
+  if (bound == 0) return 0;
+
+  uint64_t threshold = -bound % bound;
+  uint64_t value = next_random(rng);
+  while (value < threshold) value = next_random(rng);
+
+  return value % bound;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool random_bool(rng_t* rng) {
+  return next_random(rng) >> 63;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Uniform in [0, 1), from the 53 high bits, as many as a double holds
+double random_unit(rng_t* rng) {
+  return (next_random(rng) >> 11) * 0x1.0p-53;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Derives the seed of an independent stream, such as one per game
+uint64_t mix_seed(uint64_t seed, uint64_t stream) {
+  uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03UL);
+  return next_splitmix(&state);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+uint64_t rotate_left(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t next_splitmix(uint64_t* state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15UL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+  return z ^ (z >> 31);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void jump_rng(rng_t* rng) {
+  static const uint64_t jump[] = {
+    0x180EC6D33CFD0ABAUL, 0xD5A61266F0C9392CUL,
+    0xA9582618E03FC9AAUL, 0x39ABDC4529B1661CUL
+  };
+
+  uint64_t s[4] = { 0, 0, 0, 0 };
+  for (int j = 0; j < 4; j++) {
+    for (int b = 0; b < 64; b++) {
+      if (jump[j] & (1UL << b)) {
+        for (int w = 0; w < 4; w++) s[w] ^= rng->state[w];
+      }
+      next_random(rng);
+    }
+  }
+
+  for (int w = 0; w < 4; w++) rng->state[w] = s[w];
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,922 @@
+// Standard headers
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include "batch.h"
+#include "bot.h"
+#include "checkpoint.h"
+#include "clock.h"
+#include "game.h"
+#include "map.h"
+#include "map_analysis.h"
+#include "map_cache.h"
+#include "metrics.h"
+#include "ratings.h"
+#include "result_sink.h"
+#include "rng.h"
+#include "scheduler.h"
+#include "strategy.h"
+#include "tracer.h"
+
+// Main header
+#include "runner.h"
+
+// Macros
+#define MAX_PENDING_GAMES RESULT_BLOCK_ROWS // At least BATCH_LANES
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325UL
+#define FNV_PRIME 0x100000001B3UL
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A sweep is the state shared by all workers of a run.
+ */
+struct sweep {
+  const runner_config_t* config;
+  Scheduler scheduler;
+  size_t* game_indices; // Of scheduled tasks, if resumed from a checkpoint
+  bool is_drawn; // Games are resolved without playing them
+  enum game_winner* winners; // If given, of every game
+
+  pthread_mutex_t summary_mutex;
+  runner_summary_t summary;
+
+  // Games published by workers. A checkpoint is saved once every worker
+  // still playing has published in the current round
+  Checkpoint checkpoint;
+  pthread_mutex_t checkpoint_mutex;
+  atomic_uint_fast64_t checkpoint_round;
+  atomic_uint_fast64_t next_checkpoint; // In wall nanoseconds
+  size_t number_active_workers;
+  size_t number_published_workers;
+};
+
+/**
+ * A worker plays games of the sweeps of a runner. Its index is its deque
+ * in the scheduler, and the slot in which it records outcomes in the
+ * ratings.
+ */
+struct worker {
+  struct runner* runner;
+  struct sweep* sweep;
+  size_t index;
+
+  runner_summary_t summary;
+  ResultBuffer results;
+
+  bool is_reporter;
+  double next_report;
+
+  MetricsSlot metrics;
+
+  // Games completed since the worker last published to the checkpoint
+  size_t* pending_games;
+  size_t number_pending_games;
+  runner_summary_t published_summary;
+  uint64_t checkpoint_round;
+};
+
+/**
+ * A runner plays its sweeps on the calling thread, as its first worker,
+ * and on threads of the other workers, which wait for the next sweep
+ * between two of them.
+ */
+struct runner {
+  runner_config_t config;
+  bool is_drawn; // Games on the map are resolved without playing them
+
+  struct worker* workers;
+  pthread_t* threads;
+  size_t number_threads; // Started
+
+  pthread_mutex_t mutex;
+  pthread_cond_t sweep_started;
+  pthread_cond_t sweep_finished;
+  uint64_t number_sweeps; // Started, so that threads play each one once
+  size_t number_playing_threads;
+  bool is_stopping;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+static const char* end_reason_names[NUMBER_GAME_END_REASONS] = {
+  [GAME_CONTINUES]             = "unfinished",
+  [ATTACKER_CHEATED]           = "attacker cheated",
+  [DEFENDER_CHEATED]           = "defender cheated",
+  [ATTACKER_ARRIVED_END_FIELD] = "attacker arrived",
+  [DEFENDER_CAPTURED_ATTACKER] = "defender captured",
+  [MAX_TURNS_REACHED]          = "max turns reached",
+  [CYCLE_DETECTED]             = "cycle detected",
+  [MAP_DRAWN]                  = "map drawn",
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void* wait_for_sweeps(void* worker);
+static Game make_sweep_game(const runner_config_t* config, size_t index);
+static bool is_sweep_drawn(const runner_config_t* config);
+static game_result_t resolve_drawn_game();
+static bool resume_sweep(struct sweep* sweep, const uint32_t** costs);
+static uint64_t fingerprint_config(const runner_config_t* config);
+static size_t get_game_index(struct sweep* sweep, size_t task);
+static void* execute_worker(void* worker);
+static void play_games(struct worker* worker);
+static void play_batches(struct worker* worker);
+static void record_game(struct worker* worker,
+                        size_t index,
+                        game_result_t result,
+                        uint64_t wall_nanoseconds);
+static void fail_games(struct worker* worker, size_t number_games);
+static uint64_t observe_phase(struct worker* worker,
+                              enum metrics_phase phase,
+                              uint64_t start,
+                              size_t number_games);
+static void track_games(struct worker* worker,
+                        const size_t* indices,
+                        size_t number_games);
+static void publish_games(struct worker* worker, bool is_due);
+static void leave_checkpoint(struct worker* worker);
+static void save_sweep_checkpoint(struct sweep* sweep);
+static uint64_t hash_bytes(uint64_t hash, const void* bytes, size_t size);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Runner new_runner(runner_config_t config) {
+  if (config.number_workers == 0) config.number_workers = 1;
+
+  Runner runner = malloc(sizeof(*runner));
+
+  runner->config = config;
+  runner->is_drawn = is_sweep_drawn(&runner->config);
+
+  pthread_mutex_init(&runner->mutex, NULL);
+  pthread_cond_init(&runner->sweep_started, NULL);
+  pthread_cond_init(&runner->sweep_finished, NULL);
+  runner->number_sweeps = 0;
+  runner->number_playing_threads = 0;
+  runner->is_stopping = false;
+
+  runner->workers = malloc(config.number_workers * sizeof(*runner->workers));
+  for (size_t w = 0; w < config.number_workers; w++) {
+    runner->workers[w] = (struct worker) { .runner = runner, .index = w };
+  }
+
+  // The calling thread is the first worker
+  size_t number_threads = config.number_workers - 1;
+  runner->threads = malloc((number_threads + 1) * sizeof(*runner->threads));
+
+  runner->number_threads = 0;
+  while (runner->number_threads < number_threads
+         && pthread_create(&runner->threads[runner->number_threads], NULL,
+                           wait_for_sweeps,
+                           &runner->workers[runner->number_threads + 1])
+            == 0) {
+    runner->number_threads++;
+  }
+
+  return runner;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_runner(Runner runner) {
+  if (runner == NULL) return;
+
+  pthread_mutex_lock(&runner->mutex);
+  runner->is_stopping = true;
+  pthread_cond_broadcast(&runner->sweep_started);
+  pthread_mutex_unlock(&runner->mutex);
+
+  for (size_t t = 0; t < runner->number_threads; t++) {
+    pthread_join(runner->threads[t], NULL);
+  }
+
+  free(runner->threads);
+  free(runner->workers);
+  pthread_cond_destroy(&runner->sweep_finished);
+  pthread_cond_destroy(&runner->sweep_started);
+  pthread_mutex_destroy(&runner->mutex);
+
+  free(runner);
+}
+
+/*----------------------------------------------------------------------------*/
+
+runner_summary_t run_runner_sweep(Runner runner, runner_sweep_t overrides) {
+  double start = read_monotonic_seconds();
+
+  runner_config_t config = runner->config;
+  config.number_games = overrides.number_games;
+  config.seed = overrides.seed;
+  config.attacker_strategy = overrides.attacker_strategy;
+  config.defender_strategy = overrides.defender_strategy;
+  config.attacker_player = overrides.attacker_player;
+  config.defender_player = overrides.defender_player;
+
+  struct sweep sweep = {
+    .config = &config,
+    .is_drawn = runner->is_drawn,
+    .winners = overrides.winners,
+  };
+
+  if (sweep.winners != NULL) {
+    for (size_t index = 0; index < config.number_games; index++) {
+      sweep.winners[index] = NUMBER_GAME_WINNERS;
+    }
+  }
+
+  const uint32_t* costs = config.expected_turns;
+  bool is_ready = resume_sweep(&sweep, &costs);
+  size_t number_tasks = config.number_games
+                        - get_checkpoint_number_completed(sweep.checkpoint);
+
+  if (is_ready) {
+    sweep.scheduler = new_scheduler(number_tasks, config.number_workers,
+                                    costs);
+  }
+
+  if (costs != config.expected_turns) free((uint32_t*) costs);
+
+  if (sweep.scheduler == NULL) {
+    delete_checkpoint(sweep.checkpoint);
+    free(sweep.game_indices);
+    sweep.summary = (runner_summary_t) { 0 };
+    sweep.summary.number_games = config.number_games;
+    sweep.summary.number_failed_games = config.number_games;
+    sweep.summary.wall_seconds = read_monotonic_seconds() - start;
+    return sweep.summary;
+  }
+
+  pthread_mutex_init(&sweep.summary_mutex, NULL);
+  pthread_mutex_init(&sweep.checkpoint_mutex, NULL);
+  atomic_init(&sweep.checkpoint_round, 1);
+  atomic_init(&sweep.next_checkpoint,
+              read_monotonic_nanoseconds() + config.checkpoint_period * 1e9);
+
+  // Workers that could not start never publish to the checkpoint
+  sweep.number_active_workers = runner->number_threads + 1;
+
+  for (size_t w = 0; w < config.number_workers; w++) {
+    runner->workers[w] = (struct worker) {
+      .runner = runner, .sweep = &sweep, .index = w
+    };
+  }
+
+  pthread_mutex_lock(&runner->mutex);
+  runner->number_playing_threads = runner->number_threads;
+  runner->number_sweeps++;
+  pthread_cond_broadcast(&runner->sweep_started);
+  pthread_mutex_unlock(&runner->mutex);
+
+  execute_worker(&runner->workers[0]);
+
+  pthread_mutex_lock(&runner->mutex);
+  while (runner->number_playing_threads > 0) {
+    pthread_cond_wait(&runner->sweep_finished, &runner->mutex);
+  }
+  pthread_mutex_unlock(&runner->mutex);
+
+  if (sweep.checkpoint != NULL) save_sweep_checkpoint(&sweep);
+
+  pthread_mutex_destroy(&sweep.checkpoint_mutex);
+  pthread_mutex_destroy(&sweep.summary_mutex);
+  delete_scheduler(sweep.scheduler);
+  delete_checkpoint(sweep.checkpoint);
+  free(sweep.game_indices);
+
+  sweep.summary.wall_seconds = read_monotonic_seconds() - start;
+  return sweep.summary;
+}
+
+/*----------------------------------------------------------------------------*/
+
+runner_summary_t run_games(runner_config_t config) {
+  double start = read_monotonic_seconds();
+
+  Runner runner = new_runner(config);
+
+  runner_sweep_t sweep = {
+    .number_games = config.number_games,
+    .seed = config.seed,
+    .attacker_strategy = config.attacker_strategy,
+    .defender_strategy = config.defender_strategy,
+    .attacker_player = config.attacker_player,
+    .defender_player = config.defender_player,
+    .winners = NULL,
+  };
+  runner_summary_t summary = run_runner_sweep(runner, sweep);
+
+  delete_runner(runner);
+
+  summary.wall_seconds = read_monotonic_seconds() - start;
+  return summary;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void print_runner_summary(runner_summary_t summary) {
+  printf("Games: %ld (%ld failed) in %.3f s, %.0f games/s\n",
+         summary.number_games, summary.number_failed_games,
+         summary.wall_seconds,
+         summary.wall_seconds > 0.0
+           ? summary.number_games / summary.wall_seconds : 0.0);
+
+  size_t finished = summary.number_games - summary.number_failed_games;
+  double percentage = finished > 0 ? 100.0 / finished : 0.0;
+
+  printf("Attacker wins: %ld (%.1f%%)\n",
+         summary.winners[ATTACKER_WINNER],
+         summary.winners[ATTACKER_WINNER] * percentage);
+  printf("Defender wins: %ld (%.1f%%)\n",
+         summary.winners[DEFENDER_WINNER],
+         summary.winners[DEFENDER_WINNER] * percentage);
+  printf("Draws: %ld (%.1f%%)\n",
+         summary.winners[NO_WINNER],
+         summary.winners[NO_WINNER] * percentage);
+
+  for (size_t r = ATTACKER_CHEATED; r < NUMBER_GAME_END_REASONS; r++) {
+    printf("  %s: %ld\n", end_reason_names[r], summary.end_reasons[r]);
+  }
+
+  // Games resolved on a drawn map have no turn
+  size_t played = finished - summary.end_reasons[MAP_DRAWN];
+  printf("Average turns: %.2f\n",
+         played > 0 ? (double) summary.number_turns / played : 0.0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Adds the games of a summary, but not its wall time
+void merge_runner_summaries(runner_summary_t* into,
+                            const runner_summary_t* from) {
+  into->number_games += from->number_games;
+  into->number_failed_games += from->number_failed_games;
+  into->number_turns += from->number_turns;
+
+  for (size_t w = 0; w < NUMBER_GAME_WINNERS; w++) {
+    into->winners[w] += from->winners[w];
+  }
+
+  for (size_t r = 0; r < NUMBER_GAME_END_REASONS; r++) {
+    into->end_reasons[r] += from->end_reasons[r];
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Plays every sweep of the runner, until the runner is deleted
+void* wait_for_sweeps(void* worker) {
+  struct worker* w = worker;
+  struct runner* r = w->runner;
+  uint64_t number_sweeps = 0;
+
+  pthread_mutex_lock(&r->mutex);
+  for (;;) {
+    while (r->number_sweeps == number_sweeps && !r->is_stopping) {
+      pthread_cond_wait(&r->sweep_started, &r->mutex);
+    }
+    if (r->is_stopping) break;
+    number_sweeps = r->number_sweeps;
+
+    pthread_mutex_unlock(&r->mutex);
+    execute_worker(w);
+    pthread_mutex_lock(&r->mutex);
+
+    if (--r->number_playing_threads == 0) {
+      pthread_cond_signal(&r->sweep_finished);
+    }
+  }
+  pthread_mutex_unlock(&r->mutex);
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+Game make_sweep_game(const runner_config_t* config, size_t index) {
+  Game game = config->map != NULL
+    ? new_game_from_map(config->map,
+                        config->max_number_spies,
+                        config->attacker_strategy,
+                        config->defender_strategy)
+    : new_game(config->field_dimension,
+               config->max_number_spies,
+               config->attacker_strategy,
+               config->defender_strategy);
+
+  if (game == NULL) return NULL;
+
+  set_game_seed(game, mix_seed(config->seed, index));
+  set_game_simultaneous_moves(game, config->simultaneous_moves);
+  set_game_concurrent_decisions(game, config->concurrent_decisions);
+  set_game_strategy_parameters(game, config->attacker_parameters,
+                               config->defender_parameters);
+  set_game_turn_budget(game, config->turn_budget, config->turn_fallback);
+
+  return game;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Bots may break any rule, so only games of built-in strategies, which
+// never spy more than allowed, are resolved
+bool is_sweep_drawn(const runner_config_t* config) {
+  if (config->map == NULL
+      || config->attacker_bot != NULL || config->defender_bot != NULL) {
+    return false;
+  }
+
+  // Maps on which games cannot be made have failed games instead
+  Game game = make_sweep_game(config, 0);
+  if (game == NULL) return false;
+  delete_game(game);
+
+  CachedAnalysis components
+    = load_map_analysis(config->cache, config->map, &components_analysis);
+  bool is_drawn = is_map_drawn(config->map,
+                               get_cached_analysis_data(components));
+  delete_cached_analysis(components);
+
+  return is_drawn;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The game is not played, so it has no turn and no spy use
+game_result_t resolve_drawn_game() {
+  game_result_t result = { MAP_DRAWN, NO_WINNER, 0, 0, 0 };
+  return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Loads the checkpoint of the sweep, if it has one, so that the sweep
+// only plays the games it did not complete. Returns false when the
+// checkpoint cannot be used
+bool resume_sweep(struct sweep* s, const uint32_t** costs) {
+  const runner_config_t* config = s->config;
+  if (config->checkpoint_path == NULL) return true;
+
+  // Such games depend on timings, so a resumed sweep would not be the
+  // one the checkpoint was saved from
+  if (config->turn_budget != NO_TURN_BUDGET) {
+    fprintf(stderr, "ERROR: Sweeps with a turn budget have no checkpoint\n");
+    return false;
+  }
+
+  s->checkpoint = load_checkpoint(config->checkpoint_path,
+                                  fingerprint_config(config),
+                                  config->number_games);
+  if (s->checkpoint == NULL) return false;
+
+  // Records after the checkpoint are of games that will be replayed
+  truncate_result_sink(config->results,
+                       get_checkpoint_results_size(s->checkpoint));
+
+  size_t number_completed = get_checkpoint_number_completed(s->checkpoint);
+  if (number_completed == 0) return true;
+
+  // Completed games count in the summary and ratings as if just played
+  s->summary = *get_checkpoint_summary(s->checkpoint);
+  for (size_t winner = 0; winner < NUMBER_GAME_WINNERS; winner++) {
+    for (size_t g = 0; g < s->summary.winners[winner]; g++) {
+      record_rating_outcome(config->ratings, 0,
+                            config->attacker_player, config->defender_player,
+                            winner);
+    }
+  }
+
+  size_t number_tasks = config->number_games - number_completed;
+  s->game_indices = malloc(number_tasks * sizeof(*s->game_indices));
+
+  uint32_t* task_costs = NULL;
+  if (config->expected_turns != NULL) {
+    task_costs = malloc(number_tasks * sizeof(*task_costs));
+    *costs = task_costs;
+  }
+
+  size_t task = 0;
+  for (size_t index = 0; index < config->number_games; index++) {
+    if (is_checkpoint_game_completed(s->checkpoint, index)) continue;
+
+    if (task_costs != NULL) task_costs[task] = config->expected_turns[index];
+    s->game_indices[task++] = index;
+  }
+
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Hashes everything that changes the games of a sweep with 64-bit
+// FNV-1a, except the strategies, which only the players identify. The
+// map is hashed from its contents, and parameters by value, so that a
+// map edited in place or tuned parameters do not resume the sweep.
+uint64_t fingerprint_config(const runner_config_t* config) {
+  uint64_t values[] = {
+    config->map_id,
+    hash_map(config->map),
+    config->field_dimension.height,
+    config->field_dimension.width,
+    config->max_number_spies,
+    config->max_turns,
+    config->simultaneous_moves,
+    config->number_games,
+    config->seed,
+    config->attacker_player,
+    config->defender_player,
+    config->attacker_parameters != NULL,
+    config->defender_parameters != NULL,
+  };
+
+  uint64_t hash = hash_bytes(FNV_OFFSET_BASIS, values, sizeof(values));
+
+  const double* parameters[] = {
+    config->attacker_parameters, config->defender_parameters
+  };
+  for (size_t p = 0; p < sizeof(parameters) / sizeof(*parameters); p++) {
+    if (parameters[p] == NULL) continue;
+    hash = hash_bytes(hash, parameters[p],
+                      STRATEGY_MAX_PARAMETERS * sizeof(*parameters[p]));
+  }
+
+  const char* bots[] = { config->attacker_bot, config->defender_bot };
+  for (size_t b = 0; b < sizeof(bots) / sizeof(*bots); b++) {
+    if (bots[b] != NULL) hash = hash_bytes(hash, bots[b], strlen(bots[b]));
+    hash = hash_bytes(hash, "", 1);
+  }
+
+  return hash;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_game_index(struct sweep* s, size_t task) {
+  return s->game_indices != NULL ? s->game_indices[task] : task;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Workers only merge their own summary into the sweep one
+// when there are no more games to play
+void* execute_worker(void* worker) {
+  struct worker* w = worker;
+  struct sweep* s = w->sweep;
+  const runner_config_t* config = s->config;
+
+  TRACE_BEGIN(worker);
+
+  // Only the first worker reports standings, between two games
+  w->is_reporter = w->index == 0
+                   && config->ratings != NULL && config->report_period > 0;
+  w->next_report = read_monotonic_seconds() + config->report_period;
+
+  w->results = new_result_buffer(config->results);
+  w->metrics = acquire_metrics_slot(config->metrics);
+
+  if (s->checkpoint != NULL) {
+    w->pending_games = malloc(MAX_PENDING_GAMES * sizeof(*w->pending_games));
+  }
+
+  bool has_bots = config->attacker_bot != NULL || config->defender_bot != NULL;
+  if (config->batched || has_bots) play_batches(w);
+  else play_games(w);
+
+  leave_checkpoint(w);
+  free(w->pending_games);
+  w->pending_games = NULL;
+
+  release_metrics_slot(w->metrics);
+  w->metrics = NULL;
+
+  delete_result_buffer(w->results);
+  w->results = NULL;
+
+  pthread_mutex_lock(&s->summary_mutex);
+  merge_runner_summaries(&s->summary, &w->published_summary);
+  merge_runner_summaries(&s->summary, &w->summary);
+  pthread_mutex_unlock(&s->summary_mutex);
+
+  TRACE_END(worker, "worker");
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Takes games one by one
+void play_games(struct worker* w) {
+  struct sweep* s = w->sweep;
+  const runner_config_t* config = s->config;
+
+  size_t task;
+  while (take_scheduled_tasks(s->scheduler, w->index, &task, 1) > 0) {
+    size_t index = get_game_index(s, task);
+
+    TRACE_BEGIN(game);
+
+    uint64_t start = read_monotonic_nanoseconds();
+
+    Game game = s->is_drawn ? NULL : make_sweep_game(config, index);
+    uint64_t end = observe_phase(w, METRICS_SETUP, start, 1);
+
+    if (game != NULL || s->is_drawn) {
+      game_result_t result = s->is_drawn
+        ? resolve_drawn_game() : run_game(game, config->max_turns);
+      delete_game(game);
+
+      uint64_t played = read_monotonic_nanoseconds();
+      observe_metrics_phase(w->metrics, METRICS_PLAY, played - end, 1);
+      end = played;
+
+      record_game(w, index, result, end - start);
+    }
+    else {
+      fail_games(w, 1);
+    }
+
+    track_games(w, &index, 1);
+    observe_phase(w, METRICS_RECORD, end, 1);
+
+    TRACE_END(game, "game");
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Takes games BATCH_LANES at a time, with the same seeds as play_games,
+// so both give the same results. Each game is timed as an equal share
+// of its batch. Games of a batch in which a bot failed are failed games.
+void play_batches(struct worker* w) {
+  struct sweep* s = w->sweep;
+  const runner_config_t* config = s->config;
+
+  Batch batch = new_batch(config->map,
+                          config->field_dimension,
+                          config->max_number_spies,
+                          config->simultaneous_moves,
+                          config->attacker_strategy,
+                          config->defender_strategy);
+  set_batch_strategy_parameters(batch, config->attacker_parameters,
+                                config->defender_parameters);
+
+  Bot attacker_bot = NULL;
+  if (config->attacker_bot != NULL) {
+    attacker_bot = new_bot(config->attacker_bot, ATTACKER_BOT);
+  }
+
+  Bot defender_bot = NULL;
+  if (config->defender_bot != NULL) {
+    defender_bot = new_bot(config->defender_bot, DEFENDER_BOT);
+  }
+
+  if ((config->attacker_bot != NULL && attacker_bot == NULL)
+      || (config->defender_bot != NULL && defender_bot == NULL)
+      || !set_batch_bots(batch, attacker_bot, defender_bot)) {
+    delete_batch(batch);
+    batch = NULL;
+  }
+
+  size_t indices[BATCH_LANES];
+  uint64_t seeds[BATCH_LANES];
+  game_result_t results[BATCH_LANES];
+
+  size_t number_games;
+  while ((number_games = take_scheduled_tasks(
+              s->scheduler, w->index, indices, BATCH_LANES)) > 0) {
+    for (size_t g = 0; g < number_games; g++) {
+      indices[g] = get_game_index(s, indices[g]);
+    }
+
+    if (batch == NULL) {
+      fail_games(w, number_games);
+      track_games(w, indices, number_games);
+      continue;
+    }
+
+    TRACE_BEGIN(batch);
+
+    uint64_t start = read_monotonic_nanoseconds();
+
+    for (size_t g = 0; g < number_games; g++) {
+      seeds[g] = mix_seed(config->seed, indices[g]);
+    }
+    uint64_t end = observe_phase(w, METRICS_SETUP, start, number_games);
+
+    bool is_played = true;
+    if (s->is_drawn) {
+      for (size_t g = 0; g < number_games; g++) {
+        results[g] = resolve_drawn_game();
+      }
+    }
+    else {
+      is_played
+        = run_batch(batch, seeds, number_games, config->max_turns, results);
+    }
+
+    uint64_t played = read_monotonic_nanoseconds();
+    observe_metrics_phase(w->metrics, METRICS_PLAY, played - end,
+                          number_games);
+    end = played;
+
+    uint64_t wall_nanoseconds = (end - start) / number_games;
+    for (size_t g = 0; g < number_games && is_played; g++) {
+      record_game(w, indices[g], results[g], wall_nanoseconds);
+    }
+
+    if (!is_played) fail_games(w, number_games);
+
+    track_games(w, indices, number_games);
+    observe_phase(w, METRICS_RECORD, end, number_games);
+
+    TRACE_END(batch, "batch");
+  }
+
+  delete_batch(batch);
+  delete_bot(attacker_bot);
+  delete_bot(defender_bot);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void record_game(struct worker* w,
+                 size_t index,
+                 game_result_t result,
+                 uint64_t wall_nanoseconds) {
+  const runner_config_t* config = w->sweep->config;
+
+  w->summary.number_games++;
+  w->summary.number_turns += result.number_turns;
+  w->summary.winners[result.winner]++;
+  w->summary.end_reasons[result.end_reason]++;
+  count_metrics_game(w->metrics, result);
+
+  if (w->sweep->winners != NULL) w->sweep->winners[index] = result.winner;
+
+  record_rating_outcome(config->ratings, w->index,
+                        config->attacker_player, config->defender_player,
+                        result.winner);
+
+  if (w->results != NULL) {
+    game_record_t record = { .values = {
+      [RESULT_MAP_ID]            = config->map_id,
+      [RESULT_SEED]              = mix_seed(config->seed, index),
+      [RESULT_ATTACKER_STRATEGY] = config->attacker_player,
+      [RESULT_DEFENDER_STRATEGY] = config->defender_player,
+      [RESULT_WINNER]            = result.winner,
+      [RESULT_END_REASON]        = result.end_reason,
+      [RESULT_NUMBER_TURNS]      = result.number_turns,
+      [RESULT_ATTACKER_SPY_USES] = result.attacker_spy_uses,
+      [RESULT_DEFENDER_SPY_USES] = result.defender_spy_uses,
+      [RESULT_WALL_NANOSECONDS]  = wall_nanoseconds,
+    } };
+    append_game_record(w->results, &record);
+  }
+
+  if (w->is_reporter && read_monotonic_seconds() >= w->next_report) {
+    print_rating_standings(config->ratings);
+    w->next_report += config->report_period;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void fail_games(struct worker* w, size_t number_games) {
+  w->summary.number_games += number_games;
+  w->summary.number_failed_games += number_games;
+  count_metrics_failures(w->metrics, number_games);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Returns the end of the phase, which starts the next one. Without
+// metrics, the clock is not read, and phases take no time
+uint64_t observe_phase(struct worker* w,
+                       enum metrics_phase phase,
+                       uint64_t start,
+                       size_t number_games) {
+  if (w->metrics == NULL) return start;
+
+  uint64_t end = read_monotonic_nanoseconds();
+  observe_metrics_phase(w->metrics, phase, end - start, number_games);
+  return end;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Publishes the completed games to the checkpoint when it is due, and
+// before the result buffer fills up, so that a block reaches the file
+// only along with the games it records
+void track_games(struct worker* w, const size_t* indices, size_t number_games) {
+  struct sweep* s = w->sweep;
+  if (s->checkpoint == NULL) return;
+
+  memcpy(w->pending_games + w->number_pending_games, indices,
+         number_games * sizeof(*indices));
+  w->number_pending_games += number_games;
+
+  bool is_due
+    = w->checkpoint_round != atomic_load(&s->checkpoint_round)
+      && read_monotonic_nanoseconds() >= atomic_load(&s->next_checkpoint);
+
+  if (is_due
+      || w->number_pending_games + BATCH_LANES >= MAX_PENDING_GAMES) {
+    publish_games(w, is_due);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void publish_games(struct worker* w, bool is_due) {
+  struct sweep* s = w->sweep;
+
+  pthread_mutex_lock(&s->checkpoint_mutex);
+
+  flush_result_buffer(w->results);
+
+  for (size_t g = 0; g < w->number_pending_games; g++) {
+    complete_checkpoint_game(s->checkpoint, w->pending_games[g]);
+  }
+  w->number_pending_games = 0;
+
+  merge_runner_summaries(get_checkpoint_summary(s->checkpoint), &w->summary);
+  merge_runner_summaries(&w->published_summary, &w->summary);
+  w->summary = (runner_summary_t) { 0 };
+
+  uint64_t round = atomic_load(&s->checkpoint_round);
+  if (is_due && w->checkpoint_round != round) {
+    w->checkpoint_round = round;
+    s->number_published_workers++;
+  }
+
+  if (s->number_published_workers > 0
+      && s->number_published_workers >= s->number_active_workers) {
+    save_sweep_checkpoint(s);
+  }
+
+  pthread_mutex_unlock(&s->checkpoint_mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Workers with no more games publish the last ones, and no longer hold
+// back the rounds of the others
+void leave_checkpoint(struct worker* w) {
+  struct sweep* s = w->sweep;
+  if (s->checkpoint == NULL) return;
+
+  publish_games(w, false);
+
+  pthread_mutex_lock(&s->checkpoint_mutex);
+
+  s->number_active_workers--;
+  if (s->number_published_workers > 0
+      && s->number_published_workers >= s->number_active_workers) {
+    save_sweep_checkpoint(s);
+  }
+
+  pthread_mutex_unlock(&s->checkpoint_mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Called with the checkpoint mutex held, or once all workers are done
+void save_sweep_checkpoint(struct sweep* s) {
+  const runner_config_t* config = s->config;
+
+  set_checkpoint_results_size(s->checkpoint, sync_result_sink(config->results));
+  save_checkpoint(s->checkpoint, config->checkpoint_path);
+
+  s->number_published_workers = 0;
+  atomic_fetch_add(&s->checkpoint_round, 1);
+  atomic_store(&s->next_checkpoint,
+               read_monotonic_nanoseconds() + config->checkpoint_period * 1e9);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t hash_bytes(uint64_t hash, const void* bytes, size_t size) {
+  const unsigned char* b = bytes;
+  for (size_t k = 0; k < size; k++) {
+    hash = (hash ^ b[k]) * FNV_PRIME;
+  }
+  return hash;
+}
+
+/*----------------------------------------------------------------------------*/
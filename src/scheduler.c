@@ -0,0 +1,245 @@
+// Standard headers
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Main header
+#include "scheduler.h"
+
+// Macros
+#define CACHE_LINE_SIZE 64
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A deque holds the positions [front, end) of the schedule, packed as
+ * end << 32 | front. Deques never share a cache line.
+ */
+struct deque {
+  alignas(CACHE_LINE_SIZE) atomic_uint_least64_t range;
+};
+
+struct scheduler {
+  size_t number_workers;
+  struct deque* deques;
+
+  uint32_t* order; // Task at each position, or NULL if tasks are in order
+};
+
+/**
+ * A ranked task is used to sort tasks by decreasing cost.
+ */
+struct ranked_task {
+  uint32_t cost;
+  uint32_t task;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static uint64_t pack_range(uint32_t front, uint32_t end);
+static uint32_t get_range_front(uint64_t range);
+static uint32_t get_range_end(uint64_t range);
+
+static void deal_tasks(Scheduler scheduler,
+                       size_t number_tasks,
+                       const uint32_t* costs);
+static bool steal_tasks(Scheduler scheduler, size_t worker);
+static int compare_ranked_tasks(const void* t1, const void* t2);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Scheduler new_scheduler(size_t number_tasks,
+                        size_t number_workers,
+                        const uint32_t* costs) {
+  if (number_tasks > SCHEDULER_MAX_TASKS) {
+    fprintf(stderr, "ERROR: Too many tasks to schedule\n");
+    return NULL;
+  }
+
+  Scheduler scheduler = malloc(sizeof(*scheduler));
+
+  scheduler->number_workers = number_workers > 0 ? number_workers : 1;
+  scheduler->deques = aligned_alloc(
+      CACHE_LINE_SIZE, scheduler->number_workers * sizeof(struct deque));
+  scheduler->order = NULL;
+
+  deal_tasks(scheduler, number_tasks, costs);
+
+  return scheduler;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_scheduler(Scheduler scheduler) {
+  if (scheduler == NULL) return;
+
+  free(scheduler->deques);
+  scheduler->deques = NULL;
+
+  free(scheduler->order);
+  scheduler->order = NULL;
+
+  free(scheduler);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Takes the next tasks of the worker, stealing them if its deque is
+// empty. Returns the number of tasks taken, which is zero only when no
+// deque has tasks left, so the worker is done.
+size_t take_scheduled_tasks(Scheduler scheduler,
+                            size_t worker,
+                            size_t* tasks,
+                            size_t max_number_tasks) {
+  if (scheduler == NULL || worker >= scheduler->number_workers) return 0;
+  if (max_number_tasks == 0) return 0;
+
+  atomic_uint_least64_t* own = &scheduler->deques[worker].range;
+  uint64_t range = atomic_load(own);
+
+  uint32_t front, chunk_end;
+  for (;;) {
+    front = get_range_front(range);
+    uint32_t end = get_range_end(range);
+
+    if (front == end) {
+      if (!steal_tasks(scheduler, worker)) return 0;
+      range = atomic_load(own);
+      continue;
+    }
+
+    chunk_end = end - front > max_number_tasks
+              ? front + max_number_tasks : end;
+    if (atomic_compare_exchange_weak(own, &range,
+                                     pack_range(chunk_end, end))) {
+      break;
+    }
+  }
+
+  size_t number_tasks = chunk_end - front;
+  for (size_t t = 0; t < number_tasks; t++) {
+    uint32_t position = front + t;
+    tasks[t] = scheduler->order != NULL ? scheduler->order[position] : position;
+  }
+
+  return number_tasks;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+uint64_t pack_range(uint32_t front, uint32_t end) {
+  return (uint64_t) end << 32 | front;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t get_range_front(uint64_t range) {
+  return (uint32_t) range;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint32_t get_range_end(uint64_t range) {
+  return (uint32_t) (range >> 32);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Without costs, every worker gets a contiguous block of tasks. With
+// costs, tasks are sorted from the most expensive and dealt round-robin,
+// so every block starts with its longest tasks and thieves, which take
+// the back of blocks, get the shortest ones.
+void deal_tasks(Scheduler scheduler,
+                size_t number_tasks,
+                const uint32_t* costs) {
+  size_t number_workers = scheduler->number_workers;
+
+  struct ranked_task* ranked = NULL;
+  if (costs != NULL && number_tasks > 0) {
+    ranked = malloc(number_tasks * sizeof(*ranked));
+    for (size_t t = 0; t < number_tasks; t++) {
+      ranked[t] = (struct ranked_task) { costs[t], t };
+    }
+    qsort(ranked, number_tasks, sizeof(*ranked), compare_ranked_tasks);
+
+    scheduler->order = malloc(number_tasks * sizeof(*scheduler->order));
+  }
+
+  size_t front = 0;
+  for (size_t w = 0; w < number_workers; w++) {
+    size_t size = number_tasks / number_workers
+                + (w < number_tasks % number_workers ? 1 : 0);
+
+    for (size_t p = 0; p < size && ranked != NULL; p++) {
+      scheduler->order[front + p] = ranked[w + p * number_workers].task;
+    }
+
+    atomic_init(&scheduler->deques[w].range,
+                pack_range(front, front + size));
+    front += size;
+  }
+
+  free(ranked);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Steals the back half of the fullest deque into the deque of the thief.
+// Only the thief fills its own deque, and only while it is empty.
+bool steal_tasks(Scheduler scheduler, size_t worker) {
+  for (;;) {
+    atomic_uint_least64_t* victim = NULL;
+    uint64_t victim_range = 0;
+    uint32_t victim_size = 0;
+
+    for (size_t w = 0; w < scheduler->number_workers; w++) {
+      if (w == worker) continue;
+
+      uint64_t range = atomic_load(&scheduler->deques[w].range);
+      uint32_t size = get_range_end(range) - get_range_front(range);
+      if (size > victim_size) {
+        victim = &scheduler->deques[w].range;
+        victim_range = range;
+        victim_size = size;
+      }
+    }
+
+    if (victim == NULL) return false;
+
+    uint32_t front = get_range_front(victim_range);
+    uint32_t end = get_range_end(victim_range);
+    uint32_t stolen_front = end - (victim_size + 1) / 2;
+
+    if (atomic_compare_exchange_strong(victim, &victim_range,
+                                       pack_range(front, stolen_front))) {
+      atomic_store(&scheduler->deques[worker].range,
+                   pack_range(stolen_front, end));
+      return true;
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Decreasing costs, then increasing tasks, so the order is deterministic
+int compare_ranked_tasks(const void* t1, const void* t2) {
+  const struct ranked_task* task1 = t1;
+  const struct ranked_task* task2 = t2;
+
+  if (task1->cost != task2->cost) return task1->cost < task2->cost ? 1 : -1;
+  return (task1->task > task2->task) - (task1->task < task2->task);
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,620 @@
+// Standard headers
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Internal headers
+#include "clock.h"
+#include "dimension.h"
+#include "direction.h"
+#include "game.h"
+#include "map.h"
+#include "map_analysis.h"
+#include "map_cache.h"
+#include "position.h"
+#include "rng.h"
+
+// Main header
+#include "search.h"
+
+// Macros
+#define INFINITE_SCORE (2 * SEARCH_WIN_SCORE)
+#define GOAL_WEIGHT 16 // Score of a move closer to the goal...
+#define MAX_APART 4 // ...and of a cell away from the other player, up to this
+#define STOP_CHECK_PERIOD 1024 // Nodes between two reads of the clock
+#define NUMBER_MOVES 9
+#define NO_MOVE 15
+
+// Bounds of the scores of table entries, never 0 so no data is 0
+#define EXACT_BOUND 1
+#define LOWER_BOUND 2
+#define UPPER_BOUND 3
+
+// Entries of other generations than that of their table are ignored,
+// so a table is cleared by starting a new generation
+#define GENERATION_SHIFT 22
+#define MAX_GENERATION 0x3FF
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * An entry is written and read as two independent words, so a reader
+ * may see the halves of two writes; the check word then does not match.
+ */
+struct table_entry {
+  atomic_uint_fast64_t check; // Key xor data
+  atomic_uint_fast64_t data; // Score, depth, move and bound
+};
+
+struct search {
+  int32_t height;
+  int32_t width;
+  unsigned char* obstacles; // Not 0 on obstacles, by line
+  CachedAnalysis distances;
+  const uint32_t* goal_distances; // In moves, by line (see map_analysis.h)
+
+  struct table_entry* table;
+  size_t table_mask;
+  uint64_t generation; // From 1 to MAX_GENERATION
+
+  SearchProgress progress; // If not NULL, called with progress_data
+  void* progress_data;
+};
+
+/**
+ * A node is a state of the tree: the positions of the players, and the
+ * plies left. The attacker moves when the plies left are even.
+ */
+struct node {
+  int32_t attacker_i;
+  int32_t attacker_j;
+  int32_t defender_i;
+  int32_t defender_j;
+  uint32_t plies;
+};
+
+/**
+ * A root search is shared by the threads of a search: its root, when
+ * it ends, and the deepest depth completed by any of them.
+ */
+struct root_search {
+  Search search;
+  struct node root;
+  uint64_t deadline; // In monotonic nanoseconds
+
+  atomic_bool is_stopped;
+  atomic_size_t completed_depth;
+};
+
+struct thread_search {
+  struct root_search* root_search;
+  size_t index;
+
+  uint64_t number_nodes;
+  bool is_stopped;
+
+  size_t completed_depth;
+  size_t best_move;
+  int32_t best_score;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+// Forward moves first, as they usually end games sooner
+static const direction_t moves[NUMBER_MOVES] = {
+  DIR_RIGHT, DIR_UP_RIGHT, DIR_DOWN_RIGHT, DIR_UP, DIR_DOWN,
+  DIR_STAY, DIR_UP_LEFT, DIR_DOWN_LEFT, DIR_LEFT
+};
+
+#define STAY_MOVE 5
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void* execute_thread_search(void* thread);
+static int32_t search_node(struct thread_search* thread,
+                           struct node node,
+                           size_t depth,
+                           int32_t alpha,
+                           int32_t beta,
+                           size_t* best_move);
+static bool is_search_stopped(struct thread_search* thread);
+
+static bool play_move(const Search search, struct node* node, size_t move);
+static bool is_turn_over(const Search search,
+                         const struct node* node,
+                         int32_t* score);
+static int32_t evaluate_node(const Search search, const struct node* node);
+
+static uint64_t hash_node(const struct node* node);
+static bool probe_table(const Search search, uint64_t key, uint64_t* data);
+static void store_table(const Search search, uint64_t key, uint64_t data);
+static uint64_t pack_entry(int32_t score, size_t depth,
+                           size_t move, uint64_t bound);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Search new_search(Game game, MapCache cache, size_t table_bytes) {
+  if (game == NULL) return NULL;
+
+  dimension_t dimension = get_game_dimension(game);
+  bool* obstacles
+    = malloc(dimension.height * dimension.width * sizeof(*obstacles));
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
+      obstacles[i * dimension.width + j] = is_game_obstacle(game, position);
+    }
+  }
+
+  Search search = new_layout_search(dimension, obstacles, cache,
+                                    table_bytes);
+  free(obstacles);
+
+  return search;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The table takes the largest power of two of entries within the budget
+Search new_layout_search(dimension_t dimension,
+                         const bool* obstacles,
+                         MapCache cache,
+                         size_t table_bytes) {
+  if (obstacles == NULL) return NULL;
+
+  // The goal distances are those of the analysis of the map of the layout
+  Map map = new_map_from_layout(dimension, obstacles);
+  CachedAnalysis distances
+    = load_map_analysis(cache, map, &goal_distances_analysis);
+  delete_map(map);
+  if (distances == NULL) return NULL;
+
+  Search search = malloc(sizeof(*search));
+  search->distances = distances;
+  search->goal_distances = get_cached_analysis_data(distances);
+
+  search->height = dimension.height;
+  search->width = dimension.width;
+
+  size_t number_cells = dimension.height * dimension.width;
+  search->obstacles = malloc(number_cells * sizeof(*search->obstacles));
+  for (size_t c = 0; c < number_cells; c++) {
+    search->obstacles[c] = obstacles[c];
+  }
+
+  size_t number_entries = 1;
+  while (2 * number_entries * sizeof(struct table_entry) <= table_bytes) {
+    number_entries *= 2;
+  }
+
+  search->table = malloc(number_entries * sizeof(*search->table));
+  search->table_mask = number_entries - 1;
+
+  for (size_t e = 0; e < number_entries; e++) {
+    atomic_init(&search->table[e].check, 0);
+    atomic_init(&search->table[e].data, 0);
+  }
+
+  search->generation = 1;
+  search->progress = NULL;
+  search->progress_data = NULL;
+
+  return search;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_search(Search search) {
+  if (search == NULL) return;
+
+  free(search->table);
+  search->table = NULL;
+
+  delete_cached_analysis(search->distances);
+  search->distances = NULL;
+  search->goal_distances = NULL;
+
+  free(search->obstacles);
+  search->obstacles = NULL;
+
+  free(search);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Not while a search runs. Entries are only wiped once every
+// MAX_GENERATION clears, before generations start over.
+void clear_search(Search search) {
+  if (search == NULL) return;
+
+  if (search->generation < MAX_GENERATION) {
+    search->generation++;
+    return;
+  }
+
+  for (size_t e = 0; e <= search->table_mask; e++) {
+    atomic_store_explicit(&search->table[e].check, 0, memory_order_relaxed);
+    atomic_store_explicit(&search->table[e].data, 0, memory_order_relaxed);
+  }
+  search->generation = 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_search_progress(Search search, SearchProgress progress, void* data) {
+  if (search == NULL) return;
+
+  search->progress = progress;
+  search->progress_data = data;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The calling thread is the first thread. Entries of previous searches
+// are kept, as their keys hold all the state they depend on.
+search_result_t search_best_move(Search search,
+                                 position_t attacker_position,
+                                 position_t defender_position,
+                                 enum search_player player,
+                                 size_t remaining_turns,
+                                 size_t number_threads,
+                                 uint64_t budget_nanoseconds) {
+  search_result_t result = { (direction_t) DIR_STAY, 0, 0, 0, 0, 0 };
+  if (search == NULL || remaining_turns == 0 || number_threads == 0) {
+    return result;
+  }
+
+  uint64_t start = read_monotonic_nanoseconds();
+
+  struct root_search root_search = {
+    .search = search,
+    .root = {
+      attacker_position.i, attacker_position.j,
+      defender_position.i, defender_position.j,
+      2 * remaining_turns - (player == SEARCH_DEFENDER)
+    },
+    .deadline = budget_nanoseconds < UINT64_MAX - start
+                ? start + budget_nanoseconds : UINT64_MAX,
+  };
+  atomic_init(&root_search.is_stopped, false);
+  atomic_init(&root_search.completed_depth, 0);
+
+  pthread_t* threads = malloc(number_threads * sizeof(*threads));
+  struct thread_search* thread_searches
+    = malloc(number_threads * sizeof(*thread_searches));
+
+  for (size_t t = 0; t < number_threads; t++) {
+    thread_searches[t] = (struct thread_search) {
+      .root_search = &root_search,
+      .index = t,
+      .best_move = STAY_MOVE,
+    };
+  }
+
+  size_t number_started = 1;
+  while (number_started < number_threads
+         && pthread_create(&threads[number_started], NULL,
+                           execute_thread_search,
+                           &thread_searches[number_started]) == 0) {
+    number_started++;
+  }
+
+  execute_thread_search(&thread_searches[0]);
+
+  for (size_t t = 1; t < number_started; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  // The deepest thread knows best, and the first one among equals
+  const struct thread_search* best = &thread_searches[0];
+  for (size_t t = 0; t < number_started; t++) {
+    const struct thread_search* thread = &thread_searches[t];
+    if (thread->completed_depth > best->completed_depth) best = thread;
+    result.number_nodes += thread->number_nodes;
+  }
+
+  result.direction = moves[best->best_move];
+  result.score = best->best_score;
+  result.depth = best->completed_depth;
+  result.number_threads = number_started;
+  result.nanoseconds = read_monotonic_nanoseconds() - start;
+
+  free(thread_searches);
+  free(threads);
+
+  return result;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Iterative deepening. Helpers start one ply deeper every other thread,
+// and skip the depths that another thread already completed, so that
+// more threads reach deeper, while the table spreads what they find.
+void* execute_thread_search(void* thread) {
+  struct thread_search* t = thread;
+  struct root_search* r = t->root_search;
+
+  size_t depth = 1 + t->index % 2;
+
+  while (depth <= r->root.plies) {
+    size_t completed = atomic_load(&r->completed_depth);
+    if (t->index > 0 && depth <= completed) depth = completed + 1;
+    if (depth > r->root.plies) break;
+
+    size_t move = STAY_MOVE;
+    int32_t score = search_node(t, r->root, depth,
+                                -INFINITE_SCORE, INFINITE_SCORE, &move);
+    if (t->is_stopped) break;
+
+    t->completed_depth = depth;
+    t->best_move = move;
+    t->best_score = score;
+
+    while (completed < depth
+           && !atomic_compare_exchange_weak(&r->completed_depth,
+                                            &completed, depth)) {
+    }
+
+    const Search search = r->search;
+    if (t->index == 0 && search->progress != NULL
+        && !search->progress(moves[move], depth, search->progress_data)) {
+      atomic_store(&r->is_stopped, true);
+      break;
+    }
+
+    // Deeper searches cannot change a proven result
+    if (score >= SEARCH_WIN_SCORE || score <= -SEARCH_WIN_SCORE
+        || depth == r->root.plies) {
+      atomic_store(&r->is_stopped, true);
+      break;
+    }
+
+    depth++;
+  }
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Negamax with alpha-beta pruning, from the side of the player to move.
+// The best move is only looked for at the root, which is never cut off
+// by the table, so that it always has a move.
+int32_t search_node(struct thread_search* thread,
+                    struct node node,
+                    size_t depth,
+                    int32_t alpha,
+                    int32_t beta,
+                    size_t* best_move) {
+  if (is_search_stopped(thread)) return 0;
+
+  const Search search = thread->root_search->search;
+  if (depth == 0) return evaluate_node(search, &node);
+
+  uint64_t key = hash_node(&node);
+  uint64_t data;
+  size_t table_move = NO_MOVE;
+
+  if (probe_table(search, key, &data)) {
+    int32_t score = (int32_t) (uint32_t) (data >> 32);
+    size_t entry_depth = (data >> 6) & 0xFFFF;
+    uint64_t bound = data & 3;
+    table_move = (data >> 2) & 15;
+
+    if (best_move == NULL && entry_depth >= depth
+        && (bound == EXACT_BOUND
+            || (bound == LOWER_BOUND && score >= beta)
+            || (bound == UPPER_BOUND && score <= alpha))) {
+      return score;
+    }
+  }
+
+  int32_t original_alpha = alpha;
+  int32_t best_score = -INFINITE_SCORE;
+  size_t best = STAY_MOVE;
+
+  // The move of the table first, then the others, in an order rotated
+  // by every helper, so that threads part ways in the tree
+  for (size_t k = 0; k <= NUMBER_MOVES; k++) {
+    size_t move;
+    if (k == 0) {
+      if (table_move >= NUMBER_MOVES) continue;
+      move = table_move;
+    }
+    else {
+      move = (k - 1 + thread->index) % NUMBER_MOVES;
+      if (move == table_move) continue;
+    }
+
+    struct node child = node;
+    if (!play_move(search, &child, move) && move != STAY_MOVE) continue;
+
+    int32_t score;
+    if (!is_turn_over(search, &child, &score)) {
+      score = -search_node(thread, child, depth - 1, -beta, -alpha, NULL);
+    }
+    else if (node.plies % 2 == 1) {
+      score = -score; // The defender moved, and the attacker scored
+    }
+
+    if (thread->is_stopped) return 0;
+
+    if (score > best_score) {
+      best_score = score;
+      best = move;
+    }
+    if (score > alpha) alpha = score;
+    if (alpha >= beta) break;
+  }
+
+  uint64_t bound = best_score <= original_alpha ? UPPER_BOUND
+                 : best_score >= beta ? LOWER_BOUND
+                 : EXACT_BOUND;
+  store_table(search, key, pack_entry(best_score, depth, best, bound));
+
+  if (best_move != NULL) *best_move = best;
+  return best_score;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The first thread never stops before it completes a ply, so that
+// the search always has a move
+bool is_search_stopped(struct thread_search* thread) {
+  struct root_search* r = thread->root_search;
+
+  thread->number_nodes++;
+  if (thread->index == 0 && thread->completed_depth == 0) return false;
+
+  if (thread->number_nodes % STOP_CHECK_PERIOD == 0
+      && read_monotonic_nanoseconds() >= r->deadline) {
+    atomic_store(&r->is_stopped, true);
+  }
+
+  thread->is_stopped = atomic_load_explicit(&r->is_stopped,
+                                            memory_order_relaxed);
+  return thread->is_stopped;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Same rule as move_item_in_field: a player only moves to a cell of the
+// field without obstacles nor the other player. Returns false if the
+// player is blocked, and stays.
+bool play_move(const Search search, struct node* node, size_t move) {
+  bool is_attacker = node->plies % 2 == 0;
+  node->plies--;
+
+  int32_t* i = is_attacker ? &node->attacker_i : &node->defender_i;
+  int32_t* j = is_attacker ? &node->attacker_j : &node->defender_j;
+  int32_t other_i = is_attacker ? node->defender_i : node->attacker_i;
+  int32_t other_j = is_attacker ? node->defender_j : node->attacker_j;
+
+  int32_t target_i = *i + moves[move].i;
+  int32_t target_j = *j + moves[move].j;
+
+  if (target_i < 0 || target_i >= search->height
+      || target_j < 0 || target_j >= search->width
+      || search->obstacles[target_i * search->width + target_j]
+      || (target_i == other_i && target_j == other_j)) {
+    return false;
+  }
+
+  *i = target_i;
+  *j = target_j;
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Same checks as check_turn_outcome, once the defender moved. The score
+// is for the attacker, who moves next.
+bool is_turn_over(const Search search, const struct node* node,
+                  int32_t* score) {
+  if (node->plies % 2 == 1) return false;
+
+  position_t attacker = { node->attacker_i, node->attacker_j };
+  position_t defender = { node->defender_i, node->defender_j };
+
+  if (node->attacker_j == search->width - 2) {
+    *score = SEARCH_WIN_SCORE + node->plies;
+    return true;
+  }
+
+  if (neighbor_positions(attacker, defender)) {
+    *score = -SEARCH_WIN_SCORE - (int32_t) node->plies;
+    return true;
+  }
+
+  *score = 0;
+  return node->plies == 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The attacker wants to be close to the goal, and away from the defender
+int32_t evaluate_node(const Search search, const struct node* node) {
+  uint32_t distance = search->goal_distances[
+      node->attacker_i * search->width + node->attacker_j];
+  if (distance == GOAL_UNREACHABLE) distance = search->height * search->width;
+
+  int32_t apart_i = abs(node->attacker_i - node->defender_i);
+  int32_t apart_j = abs(node->attacker_j - node->defender_j);
+  int32_t apart = apart_i > apart_j ? apart_i : apart_j;
+  if (apart > MAX_APART) apart = MAX_APART;
+
+  int32_t score = apart - GOAL_WEIGHT * (int32_t) distance;
+  return node->plies % 2 == 0 ? score : -score;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t hash_node(const struct node* node) {
+  uint64_t attacker = (uint64_t) (uint32_t) node->attacker_i << 32
+                      | (uint32_t) node->attacker_j;
+  uint64_t defender = (uint64_t) (uint32_t) node->defender_i << 32
+                      | (uint32_t) node->defender_j;
+
+  return mix_seed(mix_seed(attacker, defender), node->plies);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool probe_table(const Search search, uint64_t key, uint64_t* data) {
+  struct table_entry* entry = &search->table[key & search->table_mask];
+
+  uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+  *data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+
+  return *data != 0 && (check ^ *data) == key
+         && ((*data >> GENERATION_SHIFT) & MAX_GENERATION)
+            == search->generation;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Replaces the entry, unless it holds a deeper search of the same node
+void store_table(const Search search, uint64_t key, uint64_t data) {
+  struct table_entry* entry = &search->table[key & search->table_mask];
+
+  uint64_t old_data;
+  if (probe_table(search, key, &old_data)
+      && ((old_data >> 6) & 0xFFFF) > ((data >> 6) & 0xFFFF)) {
+    return;
+  }
+
+  data |= search->generation << GENERATION_SHIFT;
+
+  atomic_store_explicit(&entry->check, key ^ data, memory_order_relaxed);
+  atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Score in the high half, then 16 bits of depth, 4 of move and 2 of
+// bound, below the 10 bits of the generation added by store_table
+uint64_t pack_entry(int32_t score, size_t depth,
+                    size_t move, uint64_t bound) {
+  if (depth > 0xFFFF) depth = 0xFFFF;
+
+  return (uint64_t) (uint32_t) score << 32
+         | (uint64_t) depth << 6
+         | (uint64_t) move << 2
+         | bound;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,193 @@
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers
+#include "clock.h"
+#include "dimension.h"
+#include "direction.h"
+#include "position.h"
+#include "search.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Main header
+#include "searching_attacker.h"
+
+// Macros
+#define SPY_DISTANCE 2 // Cells to the expected defender at which it spies
+#define SEARCH_DEPTH 8 // Plies searched without a turn budget
+#define SEARCH_TABLE_BYTES (1UL << 20)
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+// Kept in the strategy context, which starts zeroed. The search lives in
+// the scratch of the context, and its table is cleared for every game
+struct searching_state {
+  bool is_started;
+  size_t number_turns; // Played before this one
+
+  position_t defender_position; // Expected, from where it was last seen
+};
+
+_Static_assert(sizeof(struct searching_state) <= STRATEGY_STATE_SIZE,
+               "Searching attacker state must fit in a strategy context");
+
+struct searching_progress {
+  StrategyContext context;
+  bool has_deadline;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static Search start_searching(position_t attacker_position,
+                              StrategyContext context);
+static void expect_defender(position_t attacker_position,
+                            StrategyContext context);
+static bool offer_searched_move(direction_t direction,
+                                size_t depth,
+                                void* progress);
+static void delete_scratch_search(void* search);
+static size_t distance(size_t a, size_t b);
+static int sign(size_t target, size_t current);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+direction_t execute_searching_attacker_strategy(
+    position_t attacker_position, Spy defender_spy, StrategyContext context) {
+  struct searching_state* s = get_strategy_state(context);
+
+  Search search = s->is_started
+    ? get_strategy_scratch(context)
+    : start_searching(attacker_position, context);
+  if (search == NULL) return (direction_t) DIR_RIGHT;
+
+  if (s->number_turns > 0) expect_defender(attacker_position, context);
+
+  if (get_spy_number_uses(defender_spy)
+        < get_strategy_max_number_spies(context)
+      && distance(attacker_position.i, s->defender_position.i) <= SPY_DISTANCE
+      && distance(attacker_position.j, s->defender_position.j)
+         <= SPY_DISTANCE) {
+    s->defender_position = get_spy_position(defender_spy);
+  }
+
+  // Without a deadline, the search only stops at its fixed depth
+  uint64_t deadline = get_strategy_deadline(context);
+  uint64_t now = read_monotonic_nanoseconds();
+  uint64_t budget = deadline == NO_STRATEGY_DEADLINE ? UINT64_MAX
+                  : deadline > now ? deadline - now
+                  : 0;
+
+  struct searching_progress progress = {
+    context, deadline != NO_STRATEGY_DEADLINE
+  };
+  set_search_progress(search, offer_searched_move, &progress);
+
+  size_t max_turns = get_strategy_max_turns(context);
+  size_t remaining_turns
+    = s->number_turns < max_turns ? max_turns - s->number_turns : 1;
+  s->number_turns++;
+
+  search_result_t result = search_best_move(
+      search, attacker_position, s->defender_position,
+      SEARCH_ATTACKER, remaining_turns, 1, budget);
+
+  set_search_progress(search, NULL, NULL);
+  return result.direction;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// The defender is assumed to start on the line of the attacker, next to
+// the right border. The layout of a context never changes, so the search
+// is only made for the first game of the context.
+Search start_searching(position_t attacker_position,
+                       StrategyContext context) {
+  struct searching_state* s = get_strategy_state(context);
+
+  dimension_t dimension = get_strategy_dimension(context);
+  const bool* obstacles = get_strategy_obstacles(context);
+  if (obstacles == NULL || dimension.width < 2
+      || get_strategy_max_turns(context) == 0) {
+    return NULL;
+  }
+
+  Search search = get_strategy_scratch(context);
+  if (search == NULL) {
+    search = new_layout_search(dimension, obstacles, NULL,
+                               SEARCH_TABLE_BYTES);
+    if (search == NULL) return NULL;
+    set_strategy_scratch(context, search, delete_scratch_search);
+  }
+
+  clear_search(search);
+
+  s->defender_position
+    = (position_t) { attacker_position.i, dimension.width - 2 };
+  s->number_turns = 0;
+  s->is_started = true;
+
+  return search;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// The defender is expected to come one cell closer every turn, unless
+// an obstacle or the attacker is in the way
+void expect_defender(position_t attacker_position, StrategyContext context) {
+  struct searching_state* s = get_strategy_state(context);
+
+  dimension_t dimension = get_strategy_dimension(context);
+  const bool* obstacles = get_strategy_obstacles(context);
+
+  position_t expected = {
+    s->defender_position.i
+      + sign(attacker_position.i, s->defender_position.i),
+    s->defender_position.j
+      + sign(attacker_position.j, s->defender_position.j)
+  };
+
+  if (!equal_positions(expected, attacker_position)
+      && !obstacles[expected.i * dimension.width + expected.j]) {
+    s->defender_position = expected;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool offer_searched_move(direction_t direction,
+                         size_t depth,
+                         void* progress) {
+  struct searching_progress* p = progress;
+
+  offer_strategy_move(p->context, direction);
+  return p->has_deadline || depth < SEARCH_DEPTH;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_scratch_search(void* search) {
+  delete_search(search);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t distance(size_t a, size_t b) {
+  return a > b ? a - b : b - a;
+}
+
+/*----------------------------------------------------------------------------*/
+
+int sign(size_t target, size_t current) {
+  return (target > current) - (target < current);
+}
@@ -42,6 +42,14 @@ void delete_spy(Spy spy) {
 
 /*----------------------------------------------------------------------------*/
 
+void reset_spy(Spy spy) {
+  if (spy == NULL) return;
+
+  spy->number_uses = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
 position_t get_spy_position(Spy spy) {
   if (spy == NULL) return (position_t) INVALID_POSITION;
 
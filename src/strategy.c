@@ -0,0 +1,264 @@
+// Standard headers
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include "clock.h"
+#include "dimension.h"
+#include "direction.h"
+#include "rng.h"
+
+// Main header
+#include "strategy.h"
+
+// Macros
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15UL
+#define HASH_CHAINS 4 // One per word of the generator
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct strategy_context {
+  rng_t rng;
+  const double* parameters; // Owned by the caller
+  dimension_t dimension;
+  const bool* obstacles; // Owned by the caller
+  size_t max_turns;
+  size_t max_number_spies;
+  void* scratch;
+  void (*delete_scratch)(void* scratch);
+
+  uint64_t deadline; // Of the current turn
+  bool has_offer;
+  direction_t offer;
+
+  alignas(max_align_t) unsigned char state[STRATEGY_STATE_SIZE];
+};
+
+_Static_assert(STRATEGY_STATE_SIZE % (HASH_CHAINS * sizeof(uint64_t)) == 0,
+               "Strategy states must fill whole hash chains");
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+StrategyContext new_strategy_context(rng_t rng) {
+  StrategyContext context = malloc(sizeof(*context));
+
+  context->parameters = NULL;
+  context->dimension = (dimension_t) NULL_DIMENSION;
+  context->obstacles = NULL;
+  context->max_turns = 0;
+  context->max_number_spies = 0;
+  context->scratch = NULL;
+  context->delete_scratch = NULL;
+  start_strategy_turn(context, NO_STRATEGY_DEADLINE);
+  reset_strategy_context(context, rng);
+
+  return context;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_strategy_context(StrategyContext context) {
+  if (context == NULL) return;
+
+  set_strategy_scratch(context, NULL, NULL);
+  free(context);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void reset_strategy_context(StrategyContext context, rng_t rng) {
+  if (context == NULL) return;
+
+  context->rng = rng;
+  memset(context->state, 0, sizeof(context->state));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rng_t* get_strategy_rng(StrategyContext context) {
+  if (context == NULL) return NULL;
+  return &context->rng;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void* get_strategy_state(StrategyContext context) {
+  if (context == NULL) return NULL;
+  return context->state;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const double* get_strategy_parameters(StrategyContext context) {
+  if (context == NULL) return NULL;
+  return context->parameters;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_strategy_parameters(StrategyContext context,
+                             const double* parameters) {
+  if (context == NULL) return;
+  context->parameters = parameters;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_strategy_layout(StrategyContext context,
+                         dimension_t dimension,
+                         const bool* obstacles) {
+  if (context == NULL) return;
+
+  context->dimension = dimension;
+  context->obstacles = obstacles;
+}
+
+/*----------------------------------------------------------------------------*/
+
+dimension_t get_strategy_dimension(StrategyContext context) {
+  if (context == NULL) return (dimension_t) NULL_DIMENSION;
+  return context->dimension;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const bool* get_strategy_obstacles(StrategyContext context) {
+  if (context == NULL) return NULL;
+  return context->obstacles;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_strategy_limits(StrategyContext context,
+                         size_t max_turns,
+                         size_t max_number_spies) {
+  if (context == NULL) return;
+
+  context->max_turns = max_turns;
+  context->max_number_spies = max_number_spies;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_strategy_max_turns(StrategyContext context) {
+  if (context == NULL) return 0;
+  return context->max_turns;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_strategy_max_number_spies(StrategyContext context) {
+  if (context == NULL) return 0;
+  return context->max_number_spies;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Mixes the generator and the state into the hash, but neither the
+// parameters, the layout nor the limits, which never change during a
+// game, nor the scratch, nor the deadline and offer, which only last a
+// turn.
+// Words are mixed in four independent chains, so that their
+// multiplications overlap.
+uint64_t hash_strategy_context(StrategyContext context, uint64_t hash) {
+  if (context == NULL) return hash;
+
+  uint64_t chains[HASH_CHAINS];
+  for (size_t c = 0; c < HASH_CHAINS; c++) {
+    chains[c] = (hash ^ context->rng.state[c]) * HASH_MULTIPLIER;
+  }
+
+  for (size_t k = 0; k < STRATEGY_STATE_SIZE; k += sizeof(chains)) {
+    uint64_t words[HASH_CHAINS];
+    memcpy(words, context->state + k, sizeof(words));
+
+    for (size_t c = 0; c < HASH_CHAINS; c++) {
+      chains[c] = (chains[c] ^ words[c]) * HASH_MULTIPLIER;
+    }
+  }
+
+  for (size_t c = 0; c < HASH_CHAINS; c++) {
+    hash = (hash ^ chains[c]) * HASH_MULTIPLIER;
+  }
+
+  return hash;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void start_strategy_turn(StrategyContext context, uint64_t deadline) {
+  if (context == NULL) return;
+
+  context->deadline = deadline;
+  context->has_offer = false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t get_strategy_deadline(StrategyContext context) {
+  if (context == NULL) return NO_STRATEGY_DEADLINE;
+  return context->deadline;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Strategies without a deadline never read the clock
+bool is_strategy_out_of_time(StrategyContext context) {
+  if (context == NULL || context->deadline == NO_STRATEGY_DEADLINE) {
+    return false;
+  }
+
+  return read_monotonic_nanoseconds() > context->deadline;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Offers made after the deadline are ignored, as they came too late
+void offer_strategy_move(StrategyContext context, direction_t direction) {
+  if (context == NULL || is_strategy_out_of_time(context)) return;
+
+  context->has_offer = true;
+  context->offer = direction;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool get_strategy_offer(StrategyContext context, direction_t* direction) {
+  if (context == NULL || !context->has_offer) return false;
+
+  *direction = context->offer;
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void* get_strategy_scratch(StrategyContext context) {
+  if (context == NULL) return NULL;
+  return context->scratch;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Deletes the previous scratch, if any
+void set_strategy_scratch(StrategyContext context,
+                          void* scratch,
+                          void (*delete_scratch)(void* scratch)) {
+  if (context == NULL) return;
+
+  if (context->scratch != NULL && context->delete_scratch != NULL) {
+    context->delete_scratch(context->scratch);
+  }
+
+  context->scratch = scratch;
+  context->delete_scratch = delete_scratch;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,182 @@
+// Standard headers
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Internal headers
+#include "coordinate.h"
+
+// Main header
+#include "team.h"
+
+// Macros
+#define TEAM_INITIAL_CAPACITY 8
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+// The symbol and movability are the same for every agent of a team
+struct team {
+  char symbol;
+  bool is_movable;
+
+  size_t size;
+  size_t capacity;
+
+  // Parallel arrays, indexed by agent
+  coordinate_t* lines;
+  coordinate_t* columns;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void grow_team_arrays(Team team);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+Team new_team(char symbol, bool is_movable) {
+  Team team = malloc(sizeof(*team));
+
+  team->symbol = symbol;
+  team->is_movable = is_movable;
+
+  team->size = 0;
+  team->capacity = 0;
+
+  team->lines = NULL;
+  team->columns = NULL;
+
+  return team;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_team(Team team) {
+  if (team == NULL) return;
+
+  free(team->columns);
+  free(team->lines);
+
+  team->size = 0;
+  team->capacity = 0;
+
+  free(team);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t add_agent_to_team(Team team, position_t position) {
+  if (team == NULL) return TEAM_INVALID_INDEX;
+
+  if (team->size == team->capacity) grow_team_arrays(team);
+
+  size_t index = team->size++;
+  team->lines[index] = position.i;
+  team->columns[index] = position.j;
+
+  return index;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Removes an agent by moving the last one into its slot,
+// so the indexes of all other agents but the last are kept
+void remove_agent_from_team(Team team, size_t index) {
+  if (team == NULL || index >= team->size) return;
+
+  size_t last = --team->size;
+  team->lines[index] = team->lines[last];
+  team->columns[index] = team->columns[last];
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t get_team_size(Team team) {
+  if (team == NULL) return 0;
+  return team->size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+char get_team_symbol(Team team) {
+  if (team == NULL) return '\0';
+  return team->symbol;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool is_team_movable(Team team) {
+  if (team == NULL) return false;
+  return team->is_movable;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const coordinate_t* get_team_lines(Team team) {
+  if (team == NULL) return NULL;
+  return team->lines;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const coordinate_t* get_team_columns(Team team) {
+  if (team == NULL) return NULL;
+  return team->columns;
+}
+
+/*----------------------------------------------------------------------------*/
+
+position_t get_agent_position(Team team, size_t index) {
+  if (team == NULL || index >= team->size)
+    return (position_t) INVALID_POSITION;
+
+  return (position_t) { team->lines[index], team->columns[index] };
+}
+
+/*----------------------------------------------------------------------------*/
+
+void set_agent_position(Team team, size_t index, position_t new_position) {
+  if (team == NULL || index >= team->size) return;
+
+  team->lines[index] = new_position.i;
+  team->columns[index] = new_position.j;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Branchless pass over the columns array, so it can be vectorized
+size_t count_agents_in_column(Team team, coordinate_t column) {
+  if (team == NULL) return 0;
+
+  const coordinate_t* columns = team->columns;
+  size_t count = 0;
+  for (size_t a = 0; a < team->size; a++) {
+    count += columns[a] == column;
+  }
+
+  return count;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+void grow_team_arrays(Team team) {
+  size_t capacity = team->capacity == 0
+    ? TEAM_INITIAL_CAPACITY : 2 * team->capacity;
+
+  team->lines = realloc(team->lines, capacity * sizeof(*team->lines));
+  team->columns = realloc(team->columns, capacity * sizeof(*team->columns));
+
+  assert(team->lines != NULL && team->columns != NULL);
+
+  team->capacity = capacity;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,279 @@
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Internal headers
+#include "map.h"
+#include "occupancy.h"
+#include "position.h"
+#include "team.h"
+
+// Main header
+#include "team_game.h"
+
+// Macros
+#define ATTACKER_SYMBOL 'A'
+#define DEFENDER_SYMBOL 'D'
+#define OBSTACLE_SYMBOL 'X'
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+// Teams of the occupants indexed in the field
+enum Occupant_team {ATTACKERS_TEAM, DEFENDERS_TEAM, OBSTACLES_TEAM};
+
+static const char team_symbols[] = {
+  [ATTACKERS_TEAM] = ATTACKER_SYMBOL,
+  [DEFENDERS_TEAM] = DEFENDER_SYMBOL,
+  [OBSTACLES_TEAM] = OBSTACLE_SYMBOL,
+};
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct team_game {
+  dimension_t dimension;
+  Occupancy occupancy; // Obstacles and agents in each cell
+
+  TeamStrategy execute_attackers_strategy;
+  TeamStrategy execute_defenders_strategy;
+
+  Team attackers;
+  Team defenders;
+
+  // Scratch buffers, sized for the largest team
+  direction_t* directions;
+  bool* captured;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void move_team(TeamGame game,
+                      Team team,
+                      TeamStrategy execute_team_strategy);
+static size_t remove_captured_attackers(TeamGame game);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+TeamGame new_team_game_from_map(
+    Map map,
+    TeamStrategy execute_attackers_strategy,
+    TeamStrategy execute_defenders_strategy) {
+  if (map == NULL) return NULL;
+
+  dimension_t dimension = get_map_dimension(map);
+
+  Occupancy occupancy = new_occupancy(dimension);
+  if (occupancy == NULL) return NULL;
+
+  TeamGame game = malloc(sizeof(*game));
+
+  game->dimension = dimension;
+  game->occupancy = occupancy;
+
+  game->execute_attackers_strategy = execute_attackers_strategy;
+  game->execute_defenders_strategy = execute_defenders_strategy;
+
+  game->attackers = new_team(ATTACKER_SYMBOL, true);
+  game->defenders = new_team(DEFENDER_SYMBOL, true);
+
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      position_t position = { i, j };
+      occupant_t occupant;
+
+      switch (get_map_symbol(map, position)) {
+        case ATTACKER_SYMBOL:
+          occupant = make_occupant(
+              ATTACKERS_TEAM, add_agent_to_team(game->attackers, position));
+          break;
+        case DEFENDER_SYMBOL:
+          occupant = make_occupant(
+              DEFENDERS_TEAM, add_agent_to_team(game->defenders, position));
+          break;
+        case OBSTACLE_SYMBOL:
+          occupant = make_occupant(OBSTACLES_TEAM, 0);
+          break;
+        default:
+          continue; // Empty cell
+      }
+
+      set_occupant(game->occupancy, position, occupant);
+    }
+  }
+
+  size_t largest_team = get_team_size(game->attackers);
+  if (get_team_size(game->defenders) > largest_team)
+    largest_team = get_team_size(game->defenders);
+
+  game->directions = malloc((largest_team + 1) * sizeof(*game->directions));
+  game->captured = malloc((largest_team + 1) * sizeof(*game->captured));
+
+  return game;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_team_game(TeamGame game) {
+  if (game == NULL) return;
+
+  free(game->captured);
+  game->captured = NULL;
+
+  free(game->directions);
+  game->directions = NULL;
+
+  delete_team(game->defenders);
+  game->defenders = NULL;
+
+  delete_team(game->attackers);
+  game->attackers = NULL;
+
+  game->execute_defenders_strategy = NULL;
+  game->execute_attackers_strategy = NULL;
+
+  delete_occupancy(game->occupancy);
+  game->occupancy = NULL;
+
+  game->dimension = (dimension_t) NULL_DIMENSION;
+
+  free(game);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void print_team_game(TeamGame game) {
+  if (game == NULL) return;
+
+  for (size_t i = 0; i < game->dimension.height; i++) {
+    for (size_t j = 0; j < game->dimension.width; j++) {
+      position_t position = { i, j };
+      occupant_t occupant = get_occupant(game->occupancy, position);
+      putchar('|');
+      putchar(occupant == NO_OCCUPANT
+              ? ' ' : team_symbols[get_occupant_team(occupant)]);
+    }
+    putchar('|');
+    putchar('\n');
+  }
+  putchar('\n');
+}
+
+/*----------------------------------------------------------------------------*/
+
+void play_team_game(TeamGame game, size_t max_turns) {
+  if (game == NULL) return;
+
+  printf("Turn 0 (%ld attackers vs. %ld defenders)\n",
+         get_team_size(game->attackers), get_team_size(game->defenders));
+  print_team_game(game);
+
+  for (size_t turn = 0; turn < max_turns; turn++) {
+    printf("Turn %ld\n", turn+1);
+
+    move_team(game, game->attackers, game->execute_attackers_strategy);
+    move_team(game, game->defenders, game->execute_defenders_strategy);
+
+    // Arrivals are checked before captures, as in the 1v1 rules, so an
+    // attacker reaching the goal next to a defender still wins
+    if (count_agents_in_column(game->attackers,
+                               game->dimension.width - 2) > 0) {
+      print_team_game(game);
+      printf("GAME OVER! Attackers win!\n");
+      return;
+    }
+
+    size_t number_captured = remove_captured_attackers(game);
+
+    print_team_game(game);
+
+    if (number_captured > 0) {
+      printf("Defenders captured %ld %s!\n", number_captured,
+             number_captured == 1UL ? "attacker" : "attackers");
+    }
+
+    if (get_team_size(game->attackers) == 0) {
+      printf("GAME OVER! Defenders win!\n");
+      return;
+    }
+  }
+
+  // A draw happens only if nobody wins before max_turns
+  printf("GAME OVER! Attackers and Defenders draw!\n");
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Asks the strategy for the whole batch of directions, then applies
+// them in index order. An agent whose target is occupied stays put.
+void move_team(TeamGame game, Team team, TeamStrategy execute_team_strategy) {
+  size_t number_agents = get_team_size(team);
+  if (number_agents == 0) return;
+
+  execute_team_strategy(game->dimension,
+                        number_agents,
+                        get_team_lines(team),
+                        get_team_columns(team),
+                        game->directions);
+
+  if (!is_team_movable(team)) return;
+
+  for (size_t a = 0; a < number_agents; a++) {
+    position_t position = get_agent_position(team, a);
+    position_t new_position = move_position(position, game->directions[a]);
+
+    if (!is_position_free(game->occupancy, new_position)) continue;
+
+    move_occupant(game->occupancy, position, new_position);
+    set_agent_position(team, a, new_position);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Captures are found looking up the 8 neighbors of each attacker
+// in the occupancy, so checking the whole team is O(attackers)
+size_t remove_captured_attackers(TeamGame game) {
+  Team attackers = game->attackers;
+  size_t number_attackers = get_team_size(attackers);
+
+  size_t number_captured = 0;
+  for (size_t a = 0; a < number_attackers; a++) {
+    game->captured[a] = has_neighbor_from_team(
+        game->occupancy, get_agent_position(attackers, a), DEFENDERS_TEAM);
+    number_captured += game->captured[a];
+  }
+
+  if (number_captured == 0) return 0;
+
+  // Backwards, since removal moves the last attacker into the hole
+  for (size_t a = number_attackers; a-- > 0;) {
+    if (!game->captured[a]) continue;
+
+    size_t last = get_team_size(attackers) - 1;
+    position_t last_position = get_agent_position(attackers, last);
+
+    set_occupant(game->occupancy,
+                 get_agent_position(attackers, a), NO_OCCUPANT);
+    remove_agent_from_team(attackers, a);
+
+    if (a != last) {
+      set_occupant(game->occupancy,
+                   last_position, make_occupant(ATTACKERS_TEAM, a));
+    }
+  }
+
+  return number_captured;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,206 @@
+// Standard headers
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Main header
+#include "tracer.h"
+
+// Macros
+#define TRACE_FILE_VARIABLE "RUGBY_TRACE_FILE"
+#define TRACE_DEFAULT_FILE  "trace.json"
+
+#define TRACE_CHUNK_EVENTS 4096
+#define TRACE_FLUSH_PERIOD_NS 50000000L // 50 ms
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+struct trace_event {
+  const char* name;
+  uint64_t begin;
+  uint64_t end;
+};
+
+/**
+ * A trace chunk is a buffer of events of a single thread. Threads fill
+ * their own chunk without locks and, once it is full, hand it over to
+ * the writer thread, which formats and writes it off the hot path.
+ */
+struct trace_chunk {
+  struct trace_chunk* next;
+  unsigned thread_id;
+  size_t number_events;
+  struct trace_event events[TRACE_CHUNK_EVENTS];
+};
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+static _Atomic(struct trace_chunk*) full_chunks = NULL;
+static _Thread_local struct trace_chunk* thread_chunk = NULL;
+static _Thread_local unsigned thread_id = 0;
+
+static atomic_uint number_threads = 0;
+static atomic_bool is_writer_stopping = false;
+
+static pthread_once_t tracer_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_chunk_key;
+static pthread_t writer_thread;
+
+static FILE* trace_file = NULL;
+static bool is_first_event = true;
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void initialize_tracer();
+static void finalize_tracer();
+
+static struct trace_chunk* new_trace_chunk();
+static void hand_over_trace_chunk(void* chunk);
+
+static void* execute_trace_writer(void* argument);
+static void write_full_chunks();
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+void record_trace_span(const char* name, uint64_t begin, uint64_t end) {
+  if (thread_chunk == NULL) {
+    pthread_once(&tracer_once, initialize_tracer);
+    thread_id = atomic_fetch_add(&number_threads, 1) + 1;
+    thread_chunk = new_trace_chunk();
+    pthread_setspecific(thread_chunk_key, thread_chunk);
+  }
+
+  struct trace_chunk* chunk = thread_chunk;
+  chunk->events[chunk->number_events++] = (struct trace_event) {
+    name, begin, end
+  };
+
+  if (chunk->number_events == TRACE_CHUNK_EVENTS) {
+    hand_over_trace_chunk(chunk);
+    thread_chunk = new_trace_chunk();
+    pthread_setspecific(thread_chunk_key, thread_chunk);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+void initialize_tracer() {
+  const char* path = getenv(TRACE_FILE_VARIABLE);
+  if (path == NULL) path = TRACE_DEFAULT_FILE;
+
+  trace_file = fopen(path, "w");
+  if (trace_file == NULL) {
+    fprintf(stderr, "ERROR: Could not open file %s\n", path);
+  }
+  else {
+    fprintf(trace_file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  }
+
+  // Threads hand over their last chunk when they exit
+  pthread_key_create(&thread_chunk_key, hand_over_trace_chunk);
+  pthread_create(&writer_thread, NULL, execute_trace_writer, NULL);
+  atexit(finalize_tracer);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Runs at exit, when all threads other than the main one are joined
+void finalize_tracer() {
+  atomic_store(&is_writer_stopping, true);
+  pthread_join(writer_thread, NULL);
+
+  if (thread_chunk != NULL) {
+    pthread_setspecific(thread_chunk_key, NULL);
+    hand_over_trace_chunk(thread_chunk);
+    thread_chunk = NULL;
+  }
+
+  write_full_chunks();
+
+  if (trace_file != NULL) {
+    fprintf(trace_file, "\n]}\n");
+    fclose(trace_file);
+    trace_file = NULL;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct trace_chunk* new_trace_chunk() {
+  struct trace_chunk* chunk = malloc(sizeof(*chunk));
+
+  chunk->next = NULL;
+  chunk->thread_id = thread_id;
+  chunk->number_events = 0;
+
+  return chunk;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void hand_over_trace_chunk(void* chunk) {
+  struct trace_chunk* c = chunk;
+
+  c->next = atomic_load(&full_chunks);
+  while (!atomic_compare_exchange_weak(&full_chunks, &c->next, c));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void* execute_trace_writer(void* argument) {
+  (void) argument;
+
+  struct timespec period = { 0, TRACE_FLUSH_PERIOD_NS };
+  while (!atomic_load(&is_writer_stopping)) {
+    nanosleep(&period, NULL);
+    write_full_chunks();
+  }
+
+  return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Only one thread writes at a time: the writer thread while it runs,
+// and then the thread that finalizes the tracer
+void write_full_chunks() {
+  struct trace_chunk* chunk = atomic_exchange(&full_chunks, NULL);
+
+  while (chunk != NULL) {
+    for (size_t e = 0; e < chunk->number_events && trace_file != NULL; e++) {
+      struct trace_event* event = &chunk->events[e];
+
+      // Complete events, with timestamps and durations in microseconds
+      fprintf(trace_file,
+              "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,"
+              "\"ts\":%.3f,\"dur\":%.3f}",
+              is_first_event ? "" : ",",
+              event->name, (int) getpid(), chunk->thread_id,
+              event->begin / 1000.0,
+              (event->end - event->begin) / 1000.0);
+
+      is_first_event = false;
+    }
+
+    struct trace_chunk* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
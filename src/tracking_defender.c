@@ -0,0 +1,208 @@
+// Standard headers
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Internal headers
+#include "belief.h"
+#include "dimension.h"
+#include "direction.h"
+#include "position.h"
+#include "rng.h"
+#include "spy.h"
+#include "strategy.h"
+
+// Main header
+#include "tracking_defender.h"
+
+// Macros
+#define SPY_BUDGET 1 // As in every default Game
+#define SPY_MIN_BITS 5.0 // The attacker is about one of 32 cells
+#define SPY_MARGIN 1 // Columns between the frontier and the guard column
+#define LEAD 1 // Columns kept between the attacker and the defender
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+// Kept in the strategy context, which starts zeroed. The belief lives in
+// the scratch of the context, in coordinates without the field borders
+struct tracking_state {
+  bool is_started;
+
+  position_t previous_position;
+  direction_t previous_direction;
+
+  size_t guard_column;
+};
+
+_Static_assert(sizeof(struct tracking_state) <= STRATEGY_STATE_SIZE,
+               "Tracking defender state must fit in a strategy context");
+
+/*----------------------------------------------------------------------------*/
+/*                         PRIVATE VARIABLES                                  */
+/*----------------------------------------------------------------------------*/
+
+static const direction_t directions[] = {
+  DIR_UP, DIR_UP_RIGHT, DIR_RIGHT, DIR_DOWN_RIGHT,
+  DIR_DOWN, DIR_DOWN_LEFT, DIR_LEFT, DIR_UP_LEFT
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static Belief start_tracking(position_t defender_position,
+                             StrategyContext context);
+static Belief new_field_belief(dimension_t field_dimension,
+                               const bool* field_obstacles);
+static void delete_scratch_belief(void* belief);
+static int sign(size_t target, size_t current);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+direction_t execute_tracking_defender_strategy(
+    position_t defender_position, Spy attacker_spy, StrategyContext context) {
+  struct tracking_state* s = get_strategy_state(context);
+
+  Belief belief = s->is_started
+    ? get_strategy_scratch(context)
+    : start_tracking(defender_position, context);
+
+  spread_belief(belief); // The attacker moved since the last turn
+
+  if (get_spy_number_uses(attacker_spy) < SPY_BUDGET) {
+    position_t first, last;
+    get_belief_frontier(belief, &first, &last);
+
+    if (is_spy_advised(belief, SPY_MIN_BITS)
+        || (size_t) last.j + 1 + SPY_MARGIN >= s->guard_column) {
+      position_t attacker = get_spy_position(attacker_spy);
+      collapse_belief(belief, (position_t) { attacker.i - 1, attacker.j - 1 });
+    }
+  }
+
+  /* If the last move was blocked, step aside at random */
+  direction_t direction;
+  if (equal_positions(defender_position, s->previous_position)
+      && (s->previous_direction.i != 0 || s->previous_direction.j != 0)) {
+    size_t number_directions = sizeof(directions) / sizeof(*directions);
+    direction
+      = directions[random_below(get_strategy_rng(context), number_directions)];
+  }
+
+  /* Otherwise, meet the expected attacker just ahead of it,
+   * but never beyond the guard column
+   */
+  else {
+    position_t expected = get_belief_expected_position(belief);
+    bool is_lost = equal_positions(expected, (position_t) INVALID_POSITION);
+    size_t target_i = is_lost
+      ? defender_position.i : (size_t) expected.i + 1;
+    size_t target_j = is_lost
+      ? s->guard_column : (size_t) expected.j + 1 + LEAD;
+    if (target_j > s->guard_column) target_j = s->guard_column;
+
+    direction = (direction_t) {
+      sign(target_i, defender_position.i),
+      sign(target_j, defender_position.j)
+    };
+  }
+
+  s->previous_position = defender_position;
+  s->previous_direction = direction;
+  return direction;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// The attacker is assumed to start on the line of the defender, next to
+// the left border, and the defender next to the right one. The belief
+// covers the field of the layout of the context, without its borders.
+// Contexts without a layout, as those of bots, are taken for a field
+// without obstacles, symmetric around the line of the defender.
+Belief start_tracking(position_t defender_position, StrategyContext context) {
+  struct tracking_state* s = get_strategy_state(context);
+
+  dimension_t field_dimension = get_strategy_dimension(context);
+  const bool* field_obstacles = get_strategy_obstacles(context);
+
+  dimension_t dimension = {
+    field_dimension.height - 2, field_dimension.width - 2
+  };
+
+  // The height is either 2i or 2i + 1, so the belief may have one line
+  // too many, which only holds a little of the probability
+  if (field_obstacles == NULL
+      || field_dimension.height <= 2 || field_dimension.width <= 2) {
+    field_obstacles = NULL;
+    dimension = (dimension_t) {
+      defender_position.i > 0 ? 2 * defender_position.i - 1 : 1,
+      defender_position.j > 0 ? defender_position.j : 1
+    };
+    field_dimension = (dimension_t) {
+      dimension.height + 2, dimension.width + 2
+    };
+  }
+
+  // The layout of a context never changes, so a belief of the same
+  // dimension is of the same field
+  Belief belief = get_strategy_scratch(context);
+  dimension_t previous = get_belief_dimension(belief);
+  if (previous.height != dimension.height
+      || previous.width != dimension.width) {
+    belief = new_field_belief(field_dimension, field_obstacles);
+    set_strategy_scratch(context, belief, delete_scratch_belief);
+  }
+
+  collapse_belief(belief, (position_t) { defender_position.i - 1, 0 });
+
+  s->guard_column = defender_position.j - 1;
+  s->previous_position = defender_position;
+  s->is_started = true;
+
+  return belief;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Beliefs are in coordinates without the borders of the field
+Belief new_field_belief(dimension_t field_dimension,
+                        const bool* field_obstacles) {
+  dimension_t dimension = {
+    field_dimension.height - 2, field_dimension.width - 2
+  };
+  if (field_obstacles == NULL) return new_belief(dimension, NULL);
+
+  bool* obstacles = malloc(dimension.height * dimension.width
+                           * sizeof(*obstacles));
+  for (size_t i = 0; i < dimension.height; i++) {
+    for (size_t j = 0; j < dimension.width; j++) {
+      obstacles[i * dimension.width + j]
+        = field_obstacles[(i + 1) * field_dimension.width + (j + 1)];
+    }
+  }
+
+  Belief belief = new_belief(dimension, obstacles);
+  free(obstacles);
+
+  return belief;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void delete_scratch_belief(void* belief) {
+  delete_belief(belief);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int sign(size_t target, size_t current) {
+  return (target > current) - (target < current);
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,354 @@
+// Standard headers
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Internal headers
+#include "evaluation.h"
+#include "game.h"
+#include "rng.h"
+#include "runner.h"
+#include "strategy.h"
+
+// Main header
+#include "tuner.h"
+
+// Macros
+#define MAX_POPULATION_SIZE 64
+#define MIN_STEP 1e-6 // Keeps sampling candidates once the search converged
+
+/*----------------------------------------------------------------------------*/
+/*                        PRIVATE STRUCT IMPLEMENTATION                       */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * A search is the state of a separable CMA-ES, in coordinates where
+ * every parameter ranges from 0 to 1. The covariance matrix is kept
+ * diagonal, as variances, which suits a handful of loosely coupled
+ * parameters and needs no eigendecomposition.
+ */
+struct search {
+  size_t number_parameters;
+  size_t population_size;
+  size_t number_parents;
+
+  double weights[MAX_POPULATION_SIZE];
+  double parents_mass; // Variance effective selection mass, mu_eff
+
+  // Learning rates and damping
+  double sigma_rate;
+  double sigma_damping;
+  double path_rate;
+  double rank_one_rate;
+  double rank_mu_rate;
+  double expected_norm; // Of a standard normal vector
+
+  double mean[STRATEGY_MAX_PARAMETERS];
+  double step;
+  double variances[STRATEGY_MAX_PARAMETERS];
+  double sigma_path[STRATEGY_MAX_PARAMETERS];
+  double covariance_path[STRATEGY_MAX_PARAMETERS];
+};
+
+/*----------------------------------------------------------------------------*/
+/*                          PRIVATE FUNCTIONS HEADERS                         */
+/*----------------------------------------------------------------------------*/
+
+static void start_search(struct search* search,
+                         const tuner_config_t* config);
+static void update_search(struct search* search,
+                          double (*samples)[STRATEGY_MAX_PARAMETERS],
+                          double (*normals)[STRATEGY_MAX_PARAMETERS],
+                          const size_t* ranking,
+                          size_t generation);
+
+static double score_parameters(const tuner_config_t* config,
+                               const double* coordinates,
+                               uint64_t seed,
+                               size_t* number_games);
+static void rank_scores(const double* scores, size_t number_scores,
+                        size_t* ranking);
+static double random_normal(rng_t* rng);
+
+/*----------------------------------------------------------------------------*/
+/*                              PUBLIC FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+tuner_result_t tune_strategy(tuner_config_t config) {
+  tuner_result_t result = { 0 };
+  if (config.space == NULL || config.space->number_parameters == 0) {
+    return result;
+  }
+
+  struct search search;
+  start_search(&search, &config);
+
+  size_t n = search.number_parameters;
+  size_t lambda = search.population_size;
+  rng_t rng = seed_rng(config.runner.seed);
+
+  double samples[MAX_POPULATION_SIZE][STRATEGY_MAX_PARAMETERS];
+  double normals[MAX_POPULATION_SIZE][STRATEGY_MAX_PARAMETERS];
+  double scores[MAX_POPULATION_SIZE];
+  size_t ranking[MAX_POPULATION_SIZE];
+
+  for (size_t g = 0; g < config.number_generations; g++) {
+    uint64_t seed = mix_seed(config.runner.seed, g);
+    double mean_score = 0.0;
+
+    for (size_t k = 0; k < lambda; k++) {
+      for (size_t p = 0; p < n; p++) {
+        normals[k][p] = random_normal(&rng);
+        samples[k][p] = search.mean[p] + search.step
+                      * sqrt(search.variances[p]) * normals[k][p];
+      }
+
+      scores[k] = score_parameters(&config, samples[k], seed,
+                                   &result.number_games);
+      mean_score += scores[k] / lambda;
+    }
+
+    rank_scores(scores, lambda, ranking);
+    update_search(&search, samples, normals, ranking, g);
+
+    printf("Generation %ld: best %.4f, average %.4f, step %.4f\n",
+           g + 1, scores[ranking[0]], mean_score, search.step);
+  }
+
+  // Defaults are scored in the same coordinates, so they get the same
+  // rounding as the tuned parameters
+  double default_coordinates[STRATEGY_MAX_PARAMETERS];
+  for (size_t p = 0; p < n; p++) {
+    const parameter_space_t* s = config.space;
+    default_coordinates[p] = (s->defaults[p] - s->lower_bounds[p])
+                           / (s->upper_bounds[p] - s->lower_bounds[p]);
+  }
+
+  uint64_t final_seed
+    = mix_seed(config.runner.seed, config.number_generations);
+  result.score = score_parameters(&config, search.mean, final_seed,
+                                  &result.number_games);
+  result.default_score = score_parameters(&config, default_coordinates,
+                                          final_seed, &result.number_games);
+
+  result.number_parameters = n;
+  for (size_t p = 0; p < n; p++) {
+    double y = fmin(fmax(search.mean[p], 0.0), 1.0);
+    result.parameters[p] = config.space->lower_bounds[p]
+      + y * (config.space->upper_bounds[p] - config.space->lower_bounds[p]);
+  }
+
+  return result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void print_tuner_result(tuner_result_t result, const parameter_space_t* space) {
+  printf("Games played: %ld\n", result.number_games);
+  printf("Default score: %.4f\n", result.default_score);
+  printf("Tuned score: %.4f\n", result.score);
+
+  if (space == NULL) return;
+
+  printf("Parameters:\n");
+  for (size_t p = 0; p < result.number_parameters; p++) {
+    printf("  %s: %.4f (default %.4f)\n",
+           space->names[p], result.parameters[p], space->defaults[p]);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             PRIVATE FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+// Default rates of CMA-ES, with the faster covariance learning
+// of its separable variant
+void start_search(struct search* search, const tuner_config_t* config) {
+  const parameter_space_t* space = config->space;
+
+  size_t n = space->number_parameters;
+  if (n > STRATEGY_MAX_PARAMETERS) n = STRATEGY_MAX_PARAMETERS;
+
+  size_t lambda = config->population_size;
+  if (lambda == 0) lambda = 4 + (size_t) (3 * log(n));
+  if (lambda < 2) lambda = 2;
+  if (lambda > MAX_POPULATION_SIZE) lambda = MAX_POPULATION_SIZE;
+
+  search->number_parameters = n;
+  search->population_size = lambda;
+  search->number_parents = lambda / 2;
+
+  size_t mu = search->number_parents;
+  double sum = 0.0, sum_squares = 0.0;
+  for (size_t k = 0; k < mu; k++) {
+    search->weights[k] = log(mu + 0.5) - log(k + 1);
+    sum += search->weights[k];
+  }
+  for (size_t k = 0; k < mu; k++) {
+    search->weights[k] /= sum;
+    sum_squares += search->weights[k] * search->weights[k];
+  }
+  double mu_eff = 1.0 / sum_squares;
+  search->parents_mass = mu_eff;
+
+  search->sigma_rate = (mu_eff + 2) / (n + mu_eff + 5);
+  search->sigma_damping = 1 + search->sigma_rate
+    + 2 * fmax(0.0, sqrt((mu_eff - 1) / (n + 1)) - 1);
+  search->path_rate = (4 + mu_eff / n) / (n + 4 + 2 * mu_eff / n);
+
+  double rank_one = 2 / ((n + 1.3) * (n + 1.3) + mu_eff);
+  double rank_mu
+    = 2 * (mu_eff - 2 + 1 / mu_eff) / ((n + 2) * (n + 2) + mu_eff);
+  double separable_speedup = (n + 2) / 3.0;
+  search->rank_one_rate = fmin(1.0, rank_one * separable_speedup);
+  search->rank_mu_rate = fmin(1.0 - search->rank_one_rate,
+                              rank_mu * separable_speedup);
+
+  search->expected_norm = sqrt(n) * (1 - 1 / (4.0 * n) + 1 / (21.0 * n * n));
+
+  search->step = config->initial_step > 0 ? config->initial_step : 0.3;
+  for (size_t p = 0; p < n; p++) {
+    search->mean[p] = (space->defaults[p] - space->lower_bounds[p])
+                    / (space->upper_bounds[p] - space->lower_bounds[p]);
+    search->variances[p] = 1.0;
+    search->sigma_path[p] = 0.0;
+    search->covariance_path[p] = 0.0;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void update_search(struct search* search,
+                   double (*samples)[STRATEGY_MAX_PARAMETERS],
+                   double (*normals)[STRATEGY_MAX_PARAMETERS],
+                   const size_t* ranking,
+                   size_t generation) {
+  size_t n = search->number_parameters;
+  size_t mu = search->number_parents;
+  double mu_eff = search->parents_mass;
+
+  double c_sigma = search->sigma_rate;
+  double c_c = search->path_rate;
+  double c_1 = search->rank_one_rate;
+  double c_mu = search->rank_mu_rate;
+
+  // Weighted recombination of the best candidates
+  double old_mean[STRATEGY_MAX_PARAMETERS];
+  double mean_normal[STRATEGY_MAX_PARAMETERS];
+  for (size_t p = 0; p < n; p++) {
+    old_mean[p] = search->mean[p];
+    search->mean[p] = 0.0;
+    mean_normal[p] = 0.0;
+
+    for (size_t k = 0; k < mu; k++) {
+      search->mean[p] += search->weights[k] * samples[ranking[k]][p];
+      mean_normal[p] += search->weights[k] * normals[ranking[k]][p];
+    }
+  }
+
+  // Evolution paths
+  double sigma_path_norm = 0.0;
+  for (size_t p = 0; p < n; p++) {
+    search->sigma_path[p] = (1 - c_sigma) * search->sigma_path[p]
+      + sqrt(c_sigma * (2 - c_sigma) * mu_eff) * mean_normal[p];
+    sigma_path_norm += search->sigma_path[p] * search->sigma_path[p];
+  }
+  sigma_path_norm = sqrt(sigma_path_norm);
+
+  double path_decay = 1 - pow(1 - c_sigma, 2.0 * (generation + 1));
+  bool is_stalled = sigma_path_norm / sqrt(path_decay)
+                    >= (1.4 + 2.0 / (n + 1)) * search->expected_norm;
+
+  for (size_t p = 0; p < n; p++) {
+    search->covariance_path[p] = (1 - c_c) * search->covariance_path[p]
+      + (is_stalled ? 0.0 : sqrt(c_c * (2 - c_c) * mu_eff))
+      * (search->mean[p] - old_mean[p]) / search->step;
+  }
+
+  // Variances, from the path and from the steps of the best candidates
+  for (size_t p = 0; p < n; p++) {
+    double rank_mu_update = 0.0;
+    for (size_t k = 0; k < mu; k++) {
+      double z = normals[ranking[k]][p];
+      rank_mu_update += search->weights[k] * search->variances[p] * z * z;
+    }
+
+    double path_variance = search->covariance_path[p]
+                         * search->covariance_path[p];
+    if (is_stalled) path_variance += c_c * (2 - c_c) * search->variances[p];
+
+    search->variances[p] = (1 - c_1 - c_mu) * search->variances[p]
+                         + c_1 * path_variance + c_mu * rank_mu_update;
+  }
+
+  search->step *= exp(c_sigma / search->sigma_damping
+                      * (sigma_path_norm / search->expected_norm - 1));
+  if (search->step < MIN_STEP) search->step = MIN_STEP;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Candidates outside of the bounds are played at the nearest bound
+double score_parameters(const tuner_config_t* config,
+                        const double* coordinates,
+                        uint64_t seed,
+                        size_t* number_games) {
+  const parameter_space_t* space = config->space;
+
+  double parameters[STRATEGY_MAX_PARAMETERS] = { 0 };
+  for (size_t p = 0; p < space->number_parameters
+                     && p < STRATEGY_MAX_PARAMETERS; p++) {
+    double y = fmin(fmax(coordinates[p], 0.0), 1.0);
+    parameters[p] = space->lower_bounds[p]
+                  + y * (space->upper_bounds[p] - space->lower_bounds[p]);
+  }
+
+  runner_config_t runner = config->runner;
+  runner.seed = seed;
+
+  enum game_winner tuned_winner;
+  if (config->side == ATTACKER_SIDE) {
+    runner.attacker_parameters = parameters;
+    tuned_winner = ATTACKER_WINNER;
+  } else {
+    runner.defender_parameters = parameters;
+    tuned_winner = DEFENDER_WINNER;
+  }
+
+  runner_summary_t summary = run_games(runner);
+  *number_games += summary.number_games;
+
+  size_t finished = summary.number_games - summary.number_failed_games;
+  if (finished == 0) return 0.0;
+
+  return (summary.winners[tuned_winner]
+          + 0.5 * summary.winners[NO_WINNER]) / finished;
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Indices of the scores from the highest, ties kept in order
+void rank_scores(const double* scores, size_t number_scores,
+                 size_t* ranking) {
+  for (size_t k = 0; k < number_scores; k++) {
+    size_t r = k;
+    while (r > 0 && scores[ranking[r - 1]] < scores[k]) {
+      ranking[r] = ranking[r - 1];
+      r--;
+    }
+    ranking[r] = k;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Box-Muller transform, keeping a single one of the two normals
+double random_normal(rng_t* rng) {
+  double u = 1.0 - random_unit(rng); // In (0, 1], so its log is finite
+  double v = random_unit(rng);
+  return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/*----------------------------------------------------------------------------*/